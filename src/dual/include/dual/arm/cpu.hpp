@@ -4,6 +4,8 @@
 #include <atom/bit.hpp>
 #include <atom/integer.hpp>
 #include <dual/arm/coprocessor.hpp>
+#include <dual/arm/idle_loop_detector.hpp>
+#include <dual/common/save_state.hpp>
 
 namespace dual::arm {
 
@@ -99,6 +101,20 @@ namespace dual::arm {
       virtual void SetSPSR(Mode mode, PSR value) = 0;
 
       virtual void Run(int cycles) = 0;
+
+      virtual IdleLoopDetector& GetIdleLoopDetector() = 0;
+
+      /// Number of instructions executed since the CPU was created, or zero if the CPU engine does not count them.
+      virtual u64 GetRetiredInstructions() const {
+        return 0u;
+      }
+
+      /**
+       * Saves the architectural state (registers, IRQ line and the exception base) through the interface above,
+       * so that a state saved with one CPU engine can be loaded into another.
+       */
+      virtual void SaveState(StateWriter& state) const;
+      virtual void LoadState(StateReader& state);
   };
 
 } // namespace dual::arm
@@ -0,0 +1,93 @@
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atom/integer.hpp>
+#include <span>
+#include <unordered_map>
+
+namespace dual::arm {
+
+  struct IdleLoopStats {
+    std::unordered_map<u32, u64> hits{}; //< number of skips for each detected loop address
+    u64 skipped_cycles = 0u;             //< in device cycles
+  };
+
+  /**
+   * Detects loops which only wait for IO or memory to change, for example a loop which polls IPCSYNC or VCOUNT.
+   * A loop is idle when the CPU arrives at the same address twice in a row with the same register state,
+   * without having written to memory or a coprocessor (or read a volatile value) in between. Every further iteration then reads the same values
+   * until an event or the other CPU changes them, so the CPU may skip the rest of its slice right away.
+   */
+  class IdleLoopDetector {
+    public:
+      bool GetEnable() const {
+        return m_enable;
+      }
+
+      void SetEnable(bool enable) {
+        m_enable = enable;
+        m_valid = false;
+      }
+
+      void Reset() {
+        m_valid = false;
+      }
+
+      void OnWrite() {
+        m_write_count++;
+      }
+
+      /**
+       * Called for reads of values which change over time without a scheduler event, such as a running timer counter.
+       * A loop polling such a value waits for time to pass rather than for an event, so skipping ahead would overshoot its exit condition.
+       */
+      void OnVolatileRead() {
+        m_write_count++;
+      }
+
+      bool Check(u32 address, std::span<const u32, 16> reg, u32 cpsr) {
+        if(!m_enable) {
+          return false;
+        }
+
+        if(m_valid && address == m_address && cpsr == m_cpsr && m_write_count == m_snapshot_write_count &&
+           std::equal(reg.begin(), reg.end(), m_reg.begin())) {
+          m_stats.hits[address]++;
+          m_valid = false;
+          return true;
+        }
+
+        std::copy(reg.begin(), reg.end(), m_reg.begin());
+        m_address = address;
+        m_cpsr = cpsr;
+        m_snapshot_write_count = m_write_count;
+        m_valid = true;
+        return false;
+      }
+
+      void AddSkippedCycles(uint cycles) {
+        m_stats.skipped_cycles += cycles;
+      }
+
+      const IdleLoopStats& GetStats() const {
+        return m_stats;
+      }
+
+      void ResetStats() {
+        m_stats = {};
+      }
+
+    private:
+      bool m_enable{};
+      bool m_valid{};
+      u32 m_address{};
+      u32 m_cpsr{};
+      std::array<u32, 16> m_reg{};
+      u64 m_write_count{};
+      u64 m_snapshot_write_count{};
+      IdleLoopStats m_stats{};
+  };
+
+} // namespace dual::arm
@@ -1,7 +1,7 @@
-
 #pragma once
 
 #include <atom/integer.hpp>
+#include <dual/arm/page_table.hpp>
 
 namespace dual::arm {
 
@@ -13,6 +13,8 @@ namespace dual::arm {
         System
       };
 
+      static constexpr u32 k_code_page_size = 4096u;
+
       virtual ~Memory() = default;
 
       virtual u8  ReadByte(u32 vaddr, Bus bus) = 0;
@@ -22,6 +24,31 @@ namespace dual::arm {
       virtual void WriteByte(u32 vaddr, u8  value, Bus bus) = 0;
       virtual void WriteHalf(u32 vaddr, u16 value, Bus bus) = 0;
       virtual void WriteWord(u32 vaddr, u32 value, Bus bus) = 0;
+
+      /**
+       * Returns a counter which changes whenever the code bus may read something else from the page (of k_code_page_size bytes) at the address,
+       * because the page was written or the memory map changed. The interpreter reuses instructions it has decoded from a page until the counter changes.
+       * Returns nullptr if instructions from the page must not be cached, for example because writes to it are not counted.
+       */
+      virtual const u64* GetCodePageVersion(u32 vaddr) {
+        return nullptr;
+      }
+
+      /**
+       * Page tables for the memory which a CPU engine may access directly, instead of calling the functions above.
+       * The tables stay in place for the lifetime of the memory, but their entries change with the memory map, so they must be looked up on every access.
+       * Returns nullptr if there is no table for the bus, in which case every access goes through the functions above.
+       */
+      virtual const ReadPageTable* GetReadPageTable(Bus bus) const {
+        return nullptr;
+      }
+
+      virtual const WritePageTable* GetWritePageTable(Bus bus) const {
+        return nullptr;
+      }
   };
 
+  // @note: writes through a page table count towards the version of a single code page.
+  static_assert(WritePageTable::k_page_size == Memory::k_code_page_size);
+
 } // namespace dual::arm
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <array>
+#include <atom/integer.hpp>
+
+namespace dual::arm {
+
+  /**
+   * Host pointers for the 4 KiB pages of the lower 128 MiB of a CPU address space, which are tried before the address is decoded.
+   * A page is left unmapped if accessing it has side effects or if it does not map one-to-one to host memory (for example IO, PRAM and OAM),
+   * so that accesses to it go through the regular address decoding. The upper address space (GBA slot, BIOS) is never mapped.
+   */
+  template<typename Page>
+  struct PageTable {
+    static constexpr int k_page_shift = 12;
+    static constexpr u32 k_page_size = 1u << k_page_shift;
+    static constexpr u32 k_page_mask = k_page_size - 1u;
+    static constexpr u32 k_address_limit = 0x08000000u;
+    static constexpr u32 k_page_count = k_address_limit >> k_page_shift;
+
+    Page Get(u32 address) const {
+      const u32 page = address >> k_page_shift;
+
+      if(page < k_page_count) [[likely]] {
+        return pages[page];
+      }
+      return {};
+    }
+
+    void Set(u32 address, Page page) {
+      pages[address >> k_page_shift] = page;
+    }
+
+    std::array<Page, k_page_count> pages{};
+  };
+
+  struct WritablePage {
+    u8* data{};
+    u64* code_page_version{}; //< must be incremented on every write to the page (see Memory::GetCodePageVersion())
+  };
+
+  using ReadPageTable = PageTable<const u8*>;
+  using WritePageTable = PageTable<WritablePage>;
+
+} // namespace dual::arm
@@ -11,22 +11,34 @@
 
 #include <atom/integer.hpp>
 #include <atom/panic.hpp>
+#include <dual/common/save_state.hpp>
 
 namespace dual {
 
   class BackupFile {
     public:
+      /**
+       * @param write_back If false, the file is only read. Writes are kept in memory and the file is never created,
+       *                   e.g. for a second emulator instance which runs ahead of the one that owns the save file.
+       */
       static auto OpenOrCreate(
         const std::string& save_path,
         const std::vector<size_t>& valid_sizes,
-        size_t default_size
+        size_t default_size,
+        bool write_back = true
       ) -> std::unique_ptr<BackupFile> {
         namespace fs = std::filesystem;
 
         bool create = true;
-        auto flags = std::ios::binary | std::ios::in | std::ios::out;
+        auto flags = std::ios::binary | std::ios::in;
         auto file = std::unique_ptr<BackupFile>{new BackupFile()};
 
+        if(write_back) {
+          flags |= std::ios::out;
+        } else {
+          file->m_auto_update = false;
+        }
+
         // @todo: check that we have read and write permissions for the file.
         if(fs::is_regular_file(save_path)) {
           const auto file_size = fs::file_size(save_path);
@@ -50,9 +62,11 @@ namespace dual {
          * or when the existing file has an invalid size.
          */
         if(create) {
-          file->m_stream.open(save_path, flags | std::ios::trunc);
-          if(file->m_stream.fail()) {
-            ATOM_PANIC("unable to create file: {}", save_path);
+          if(write_back) {
+            file->m_stream.open(save_path, flags | std::ios::trunc);
+            if(file->m_stream.fail()) {
+              ATOM_PANIC("unable to create file: {}", save_path);
+            }
           }
           file->m_file_size = default_size;
           file->m_memory.reset(new u8[default_size]);
@@ -105,6 +119,35 @@ namespace dual {
         m_stream.write((char*)&m_memory[index], length);
       }
 
+      void SaveState(StateWriter& state) const {
+        state.Write(m_file_size);
+        state.WriteBytes(m_memory.get(), m_file_size);
+      }
+
+      void LoadState(StateReader& state) {
+        static constexpr size_t k_chunk_size = 4096u;
+
+        if(state.Read<size_t>() != m_file_size) {
+          ATOM_PANIC("save state does not match the size of the backup file.");
+        }
+
+        u8 chunk[k_chunk_size];
+
+        // Only write back the chunks that changed, to avoid rewriting the whole file on every load.
+        for(size_t index = 0; index < m_file_size; index += k_chunk_size) {
+          const size_t length = std::min(k_chunk_size, m_file_size - index);
+
+          state.ReadBytes(chunk, length);
+
+          if(std::memcmp(&m_memory[index], chunk, length) != 0) {
+            std::memcpy(&m_memory[index], chunk, length);
+            if(m_auto_update) {
+              Update(index, length);
+            }
+          }
+        }
+      }
+
     private:
       BackupFile() = default;
 
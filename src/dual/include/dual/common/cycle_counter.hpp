@@ -2,6 +2,7 @@
 #pragma once
 
 #include <atom/integer.hpp>
+#include <dual/common/save_state.hpp>
 
 namespace dual {
 
@@ -15,6 +16,16 @@ namespace dual {
         m_timestamp_sys = 0u;
       }
 
+      void SaveState(StateWriter& state) const {
+        state.Write(m_timestamp_dev);
+        state.Write(m_timestamp_sys);
+      }
+
+      void LoadState(StateReader& state) {
+        state.Read(m_timestamp_dev);
+        state.Read(m_timestamp_sys);
+      }
+
       u64 GetTimestampNow() const {
         return m_timestamp_sys;
       }
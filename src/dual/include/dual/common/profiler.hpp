@@ -0,0 +1,123 @@
+
+#pragma once
+
+#include <array>
+#include <atom/integer.hpp>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dual {
+
+  struct ProfileSample {
+    std::string name;
+    u64 calls = 0u;
+    u64 nanoseconds = 0u;
+  };
+
+  struct Profile {
+    std::vector<ProfileSample> zones{};
+    std::vector<ProfileSample> events{}; //< scheduler event callbacks, one sample per event handler
+  };
+
+  /**
+   * Measures the host time spent in the subsystems of the emulator core. It only exists when the core is built
+   * with the DUAL_ENABLE_PROFILER option, otherwise the DUAL_PROFILE_* macros expand to nothing.
+   *
+   * Times are inclusive, so for example the ARM9 zone includes the time spent in DMA transfers the ARM9 started.
+   * Every emulator instance owns a profiler and passes it to its subsystems, so that instances which run side by side
+   * neither sum up their profiles nor contend on the same counters. A zone may be entered from any thread,
+   * which allows the PPU render workers and the ARM7 thread to be profiled as well.
+   */
+  class Profiler {
+    public:
+      enum class Zone {
+        ARM9,
+        ARM7,
+        PPU_A,
+        PPU_B,
+        GPURender,
+        GPUCopyVRAM,
+        GPUClear,
+        GPURasterize,
+        GPUEdgeMarking,
+        GPUFog,
+        GPUAntiAliasing,
+        APUMixer,
+        DMA9,
+        DMA7,
+        Count
+      };
+
+      struct Counter {
+        void Add(u64 nanoseconds) {
+          calls.fetch_add(1u, std::memory_order_relaxed);
+          total_nanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+        }
+
+        std::atomic<u64> calls{};
+        std::atomic<u64> total_nanoseconds{};
+      };
+
+      static constexpr int k_max_events = 64;
+
+      Counter& GetCounter(Zone zone) {
+        return m_zone_counters[(int)zone];
+      }
+
+      Counter& GetEventCounter(int event_id) {
+        return m_event_counters[event_id];
+      }
+
+      /**
+       * Assigns an ID to an event handler, which is named after the method in the function signature.
+       * The IDs are the same for all profilers. This is meant to be called once per event handler, from a function-local static.
+       * Returns -1 once k_max_events handlers have been registered, in which case the handler is not profiled.
+       */
+      static int RegisterEvent(std::string_view function_signature);
+
+      Profile GetProfile() const;
+      void Reset();
+
+    private:
+      std::array<Counter, (int)Zone::Count> m_zone_counters{};
+      std::array<Counter, k_max_events> m_event_counters{};
+  };
+
+  class ProfileScope {
+    public:
+      explicit ProfileScope(Profiler::Counter& counter)
+          : m_counter{counter}
+          , m_time_begin{std::chrono::steady_clock::now()} {
+      }
+
+     ~ProfileScope() {
+        const auto elapsed = std::chrono::steady_clock::now() - m_time_begin;
+
+        m_counter.Add((u64)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+      }
+
+    private:
+      Profiler::Counter& m_counter;
+      std::chrono::steady_clock::time_point m_time_begin;
+  };
+
+} // namespace dual
+
+#define DUAL_PROFILE_CONCAT_IMPL(a, b) a##b
+#define DUAL_PROFILE_CONCAT(a, b) DUAL_PROFILE_CONCAT_IMPL(a, b)
+
+#if defined(_MSC_VER)
+  #define DUAL_PROFILE_FUNCTION_SIGNATURE __FUNCSIG__
+#else
+  #define DUAL_PROFILE_FUNCTION_SIGNATURE __PRETTY_FUNCTION__
+#endif
+
+#ifdef DUAL_ENABLE_PROFILER
+  #define DUAL_PROFILE_SCOPE(profiler, zone) \
+    ::dual::ProfileScope DUAL_PROFILE_CONCAT(dual_profile_scope_, __LINE__){(profiler).GetCounter(zone)}
+#else
+  #define DUAL_PROFILE_SCOPE(profiler, zone) (void)(profiler)
+#endif
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atom/integer.hpp>
+#include <deque>
+#include <span>
+#include <vector>
+
+namespace dual {
+
+  /**
+   * A history of save states that fits into a fixed memory budget.
+   * The newest state is kept uncompressed (the keyframe). Every older state is stored as the XOR delta
+   * to the next newer state, run-length encoded so that unchanged bytes take no space.
+   * Stepping back applies a single delta to the keyframe, and the oldest states can be dropped at any time.
+   * @note: there is no dirty page tracking, so Push() compares the whole state (about 6 MiB), which takes ~0.7 ms.
+   * Together with saving the state this makes a snapshot cost 2-2.5 ms. That lands on a single frame, however low the per-frame average is.
+   */
+  class RewindBuffer {
+    public:
+      struct Stats {
+        size_t snapshots;     //< Number of states that can be stepped back to
+        size_t memory_usage;  //< Bytes used by the keyframe, the deltas and the scratch buffer
+        size_t memory_budget;
+        size_t keyframe_size;
+      };
+
+      /**
+       * @param max_snapshots Maximum number of states to keep, e.g. the number of seconds times the snapshots per second.
+       * @param memory_budget Maximum number of bytes to use. Older states are dropped first, but the newest state is always kept.
+       */
+      RewindBuffer(size_t max_snapshots, size_t memory_budget);
+
+      /**
+       * Add a new state. The state is taken over by swapping buffers, so the caller gets back
+       * the buffer of the previous keyframe and can save the next state into it without allocating.
+       */
+      void Push(std::vector<u8>& state);
+
+      // Remove the newest state and write it to `state`. Returns false if there are no states left.
+      bool Pop(std::vector<u8>& state);
+
+      void Clear();
+
+      [[nodiscard]] bool Empty() const {
+        return !m_has_keyframe;
+      }
+
+      [[nodiscard]] Stats GetStats() const;
+
+    private:
+      static constexpr size_t k_page_size = 4096u;
+
+      static void EncodeDelta(std::span<const u8> src, std::span<const u8> dst, std::vector<u8>& delta);
+      static void ApplyDelta(std::span<const u8> delta, std::vector<u8>& state);
+
+      void DropOldSnapshots();
+
+      size_t m_max_snapshots;
+      size_t m_memory_budget;
+
+      bool m_has_keyframe{};
+      std::vector<u8> m_keyframe{};
+      std::deque<std::vector<u8>> m_deltas{}; //< Oldest first, the last delta turns the keyframe into the state before it.
+      size_t m_deltas_size{};
+      std::vector<u8> m_scratch{};
+  };
+
+} // namespace dual
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atom/integer.hpp>
+#include <cstring>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace dual {
+
+  /**
+   * Types which are saved as a plain copy of their bytes.
+   * @note: some math types (like Color4) declare a copy constructor, so they are not trivially copyable, even though they only hold plain data.
+   */
+  template<typename T>
+  concept PlainData = std::is_trivially_destructible_v<T> && !std::is_pointer_v<T> && !std::is_polymorphic_v<T>;
+
+  /**
+   * Save states are a flat sequence of plain data, which every component writes and reads back in the same order.
+   * They depend on the layout of the emulated state in memory, so they can only be loaded by the same build of the core.
+   */
+  class StateWriter {
+    public:
+      explicit StateWriter(std::vector<u8>& buffer) : m_buffer{buffer} {
+        // @note: clearing keeps the capacity, so that saving a state into the same buffer again does not allocate.
+        m_buffer.clear();
+      }
+
+      template<PlainData T>
+      void Write(const T& value) {
+        WriteBytes(&value, sizeof(T));
+      }
+
+      void WriteBytes(const void* data, size_t size) {
+        const u8* bytes = (const u8*)data;
+
+        m_buffer.insert(m_buffer.end(), bytes, bytes + size);
+      }
+
+    private:
+      std::vector<u8>& m_buffer;
+  };
+
+  class StateReader {
+    public:
+      explicit StateReader(std::span<const u8> data) : m_data{data} {}
+
+      template<PlainData T>
+      void Read(T& value) {
+        ReadBytes(&value, sizeof(T));
+      }
+
+      template<PlainData T>
+      T Read() {
+        T value{};
+        Read(value);
+        return value;
+      }
+
+      void ReadBytes(void* data, size_t size) {
+        if(size > m_data.size() - m_offset) {
+          std::memset(data, 0, size);
+          m_offset = m_data.size();
+          m_good = false;
+          return;
+        }
+
+        std::memcpy(data, &m_data[m_offset], size);
+        m_offset += size;
+      }
+
+      // False once a read went past the end of the state.
+      [[nodiscard]] bool Good() const {
+        return m_good;
+      }
+
+      [[nodiscard]] bool AtEnd() const {
+        return m_offset == m_data.size();
+      }
+
+    private:
+      std::span<const u8> m_data;
+      size_t m_offset{};
+      bool m_good{true};
+  };
+
+} // namespace dual
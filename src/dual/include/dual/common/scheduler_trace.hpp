@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atom/integer.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dual {
+
+  /**
+   * A recording of all operations on a Scheduler's event queue.
+   * Events are identified by the order in which they first appear in the trace.
+   * Recording stops once the capacity is reached, so that the trace stays a replayable prefix of the run.
+   */
+  class SchedulerTrace {
+    public:
+      enum class Op : u8 {
+        Arm,       //< event was (re-)scheduled, value is the delay relative to the current time
+        Cancel,    //< event was cancelled
+        FireBegin, //< event callback is about to run
+        FireEnd,   //< event callback returned
+        AddCycles  //< time advanced, value is the number of cycles
+      };
+
+      struct Entry {
+        Op op;
+        u32 event_id;
+        u64 value;
+      };
+
+      // 64 MiB, which covers a few seconds of emulation.
+      static constexpr size_t k_default_capacity = 1u << 22;
+
+      void Record(Op op, const void* event, u64 value);
+      void Clear();
+
+      bool Load(const std::string& path);
+      bool Save(const std::string& path) const;
+
+      const std::vector<Entry>& GetEntries() const {
+        return m_entries;
+      }
+
+      size_t GetEventCount() const {
+        return m_event_count;
+      }
+
+      size_t GetCapacity() const {
+        return m_capacity;
+      }
+
+      // Sets the maximum number of entries. Does not discard entries that have already been recorded.
+      void SetCapacity(size_t capacity) {
+        m_capacity = capacity;
+      }
+
+      // Number of operations which were not recorded, because the trace was full.
+      u64 GetDroppedCount() const {
+        return m_dropped_count;
+      }
+
+    private:
+      std::vector<Entry> m_entries{};
+      size_t m_capacity{k_default_capacity};
+      u64 m_dropped_count{};
+      std::unordered_map<const void*, u32> m_event_ids{};
+      size_t m_event_count{};
+  };
+
+} // namespace dual
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atom/integer.hpp>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dual {
+
+  /**
+   * A fixed number of worker threads which run tasks in the order they were submitted.
+   * Several emulator instances can share a pool, so that their work does not oversubscribe the host.
+   * @note: tasks must never block on other tasks, because those might be queued behind them. Instead they have to do the work themselves.
+   */
+  class ThreadPool {
+    public:
+      explicit ThreadPool(int thread_count);
+     ~ThreadPool();
+
+      [[nodiscard]] int GetThreadCount() const {
+        return (int)m_threads.size();
+      }
+
+      void Submit(std::function<void()> task);
+
+      // Run task(i) for every i in [0, count) on the worker threads and return once all of them are done.
+      void ParallelFor(int count, const std::function<void(int)>& task);
+
+    private:
+      void ThreadMain();
+
+      std::vector<std::thread> m_threads{};
+      std::deque<std::function<void()>> m_tasks{};
+      std::mutex m_mutex{};
+      std::condition_variable m_cv{};
+      bool m_quit{};
+  };
+
+} // namespace dual
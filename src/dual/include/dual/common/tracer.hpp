@@ -0,0 +1,83 @@
+
+#pragma once
+
+#include <atom/integer.hpp>
+#include <atomic>
+#include <string>
+
+namespace dual {
+
+  /**
+   * Records a timeline of begin/end events and counters from all threads, which can be written to a
+   * Chrome Trace Event JSON file and viewed in Perfetto or chrome://tracing.
+   *
+   * Every thread appends to its own buffer without any locking. Tracing can be toggled at any time,
+   * while it is disabled the trace points only cost an atomic load. Event and counter names must be string literals.
+   * The buffer of a thread which exits is kept for Save() and later reused by the next thread with the same name.
+   */
+  class Tracer {
+    public:
+      static bool IsEnabled() {
+        return s_enabled.load(std::memory_order_relaxed);
+      }
+
+      static void SetEnabled(bool enabled) {
+        s_enabled.store(enabled, std::memory_order_relaxed);
+      }
+
+      // Names the calling thread in the trace.
+      static void SetThreadName(const char* name);
+
+      static void Begin(const char* name);
+      static void End(const char* name);
+      static void Counter(const char* name, s64 value);
+
+      /**
+       * Writes all recorded events to a JSON file. This is safe to call while other threads still record events,
+       * but then their latest events might be missing.
+       */
+      static bool Save(const std::string& path);
+
+      /**
+       * Discards all recorded events. Each thread empties its buffer when it records its next event,
+       * so this must not be called while Save() runs on another thread.
+       */
+      static void Clear();
+
+    private:
+      static std::atomic_bool s_enabled;
+  };
+
+  class TraceScope {
+    public:
+      explicit TraceScope(const char* name) {
+        if(Tracer::IsEnabled()) {
+          m_name = name;
+          Tracer::Begin(name);
+        }
+      }
+
+     ~TraceScope() {
+        // @note: end the event even if tracing was disabled in the meantime, so that it is properly closed.
+        if(m_name) {
+          Tracer::End(m_name);
+        }
+      }
+
+    private:
+      const char* m_name{};
+  };
+
+} // namespace dual
+
+#define DUAL_TRACE_CONCAT_IMPL(a, b) a##b
+#define DUAL_TRACE_CONCAT(a, b) DUAL_TRACE_CONCAT_IMPL(a, b)
+
+#define DUAL_TRACE_SCOPE(name) ::dual::TraceScope DUAL_TRACE_CONCAT(dual_trace_scope_, __LINE__){name}
+
+#define DUAL_TRACE_COUNTER(name, value) \
+  do { \
+    if(::dual::Tracer::IsEnabled()) { \
+      ::dual::Tracer::Counter(name, (s64)(value)); \
+    } \
+  } while(0)
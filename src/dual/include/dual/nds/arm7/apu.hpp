@@ -8,18 +8,20 @@
 #include <atom/integer.hpp>
 #include <atom/vector_n.hpp>
 #include <dual/arm/memory.hpp>
+#include <dual/common/profiler.hpp>
 #include <dual/common/scheduler.hpp>
 #include <dual/audio_driver.hpp>
-#include <functional>
 #include <memory>
 
 namespace dual::nds::arm7 {
 
   class APU {
     public:
-      APU(Scheduler& scheduler, arm::Memory& bus);
+      APU(Scheduler& scheduler, arm::Memory& bus, Profiler& profiler);
 
       void Reset();
+      void SaveState(StateWriter& state) const;
+      void LoadState(StateReader& state);
 
       AudioDriverBase* GetAudioDriver();
       void SetAudioDriver(std::shared_ptr<AudioDriverBase> audio_driver);
@@ -64,6 +66,7 @@ namespace dual::nds::arm7 {
 
       void SampleMixers(int cycles_late);
       void SampleChannel(int id, int cycles_late);
+      template<int id> void SampleChannel(int cycles_late);
       void SampleChannelPSG(int id);
       template<SampleFormat sample_format> void SampleChannelPCM(int id);
       void StartChannel(int id);
@@ -105,8 +108,7 @@ namespace dual::nds::arm7 {
 
       struct Channel {
         int sampling_interval{};
-        Scheduler::Event* sampling_event{};
-        std::function<void(int)> sampling_event_fn{};
+        Scheduler::Event sampling_event{};
         f32 current_sample{0.f};
         u32 current_address{};
         SampleFormat sample_format{};
@@ -127,7 +129,9 @@ namespace dual::nds::arm7 {
       std::array<Channel, 16> m_channels;
 
       Scheduler& m_scheduler;
+      Scheduler::Event m_mixer_event{};
       arm::Memory& m_bus;
+      Profiler& m_profiler;
 
       std::shared_ptr<AudioDriverBase> m_audio_driver;
       atom::Vector_N<i16, 1024> m_audio_buffer;
@@ -4,6 +4,8 @@
 #include <atom/bit.hpp>
 #include <atom/integer.hpp>
 #include <dual/arm/memory.hpp>
+#include <dual/common/profiler.hpp>
+#include <dual/common/save_state.hpp>
 #include <dual/nds/irq.hpp>
 
 namespace dual::nds::arm7 {
@@ -17,9 +19,11 @@ namespace dual::nds::arm7 {
         Special = 3
       };
 
-      DMA(arm::Memory& bus, IRQ& irq) : m_bus{bus}, m_irq{irq} {}
+      DMA(arm::Memory& bus, IRQ& irq, Profiler& profiler) : m_bus{bus}, m_irq{irq}, m_profiler{profiler} {}
 
       void Reset();
+      void SaveState(StateWriter& state) const;
+      void LoadState(StateReader& state);
       void Request(StartTime timing);
 
       u32   Read_DMASAD(int id);
@@ -36,6 +40,7 @@ namespace dual::nds::arm7 {
 
       arm::Memory& m_bus;
       IRQ& m_irq;
+      Profiler& m_profiler;
 
       u32 m_dmasad[4]{};
       u32 m_dmadad[4]{};
@@ -7,6 +7,7 @@
 #include <atom/panic.hpp>
 #include <atom/punning.hpp>
 #include <dual/arm/memory.hpp>
+#include <dual/arm/page_table.hpp>
 #include <dual/nds/arm7/apu.hpp>
 #include <dual/nds/arm7/dma.hpp>
 #include <dual/nds/arm7/rtc.hpp>
@@ -18,6 +19,7 @@
 #include <dual/nds/irq.hpp>
 #include <dual/nds/ipc.hpp>
 #include <dual/nds/swram.hpp>
+#include <dual/nds/sync.hpp>
 #include <dual/nds/system_memory.hpp>
 #include <dual/nds/timer.hpp>
 
@@ -39,23 +41,63 @@ namespace dual::nds::arm7 {
         APU& apu;
         WIFI& wifi;
         u32& key_input;
+        SharedAccessMonitor& shared_access_monitor;
       };
 
       MemoryBus(SystemMemory& memory, const HW& hw);
 
       void Reset();
+      void SaveState(StateWriter& state) const;
+      void LoadState(StateReader& state);
 
-      u8  ReadByte(u32 address, Bus bus) override;
-      u16 ReadHalf(u32 address, Bus bus) override;
-      u32 ReadWord(u32 address, Bus bus) override;
+      // @note: defined inline, so that the interpreter (which knows the concrete bus type) gets the page table fast path without a call.
+      u8  ReadByte(u32 address, Bus bus) override { return Read<u8 >(address, bus); }
+      u16 ReadHalf(u32 address, Bus bus) override { return Read<u16>(address, bus); }
+      u32 ReadWord(u32 address, Bus bus) override { return Read<u32>(address, bus); }
 
-      void WriteByte(u32 address, u8  value, Bus bus) override;
-      void WriteHalf(u32 address, u16 value, Bus bus) override;
-      void WriteWord(u32 address, u32 value, Bus bus) override;
+      void WriteByte(u32 address, u8  value, Bus bus) override { Write<u8 >(address, value, bus); }
+      void WriteHalf(u32 address, u16 value, Bus bus) override { Write<u16>(address, value, bus); }
+      void WriteWord(u32 address, u32 value, Bus bus) override { Write<u32>(address, value, bus); }
+
+      const u64* GetCodePageVersion(u32 address) override;
+
+      const dual::arm::ReadPageTable* GetReadPageTable(Bus bus) const override {
+        return &m_read_pages;
+      }
+
+      const dual::arm::WritePageTable* GetWritePageTable(Bus bus) const override {
+        return &m_write_pages;
+      }
 
     private:
-      template<typename T> T    Read (u32 address, Bus bus);
-      template<typename T> void Write(u32 address, T value, Bus bus);
+      template<typename T>
+      T Read(u32 address, Bus bus) {
+        address &= ~(sizeof(T) - 1u);
+
+        if(const u8* page = m_read_pages.Get(address); page != nullptr) [[likely]] {
+          return atom::read<T>(page, address & dual::arm::ReadPageTable::k_page_mask);
+        }
+        return ReadSlow<T>(address, bus);
+      }
+
+      template<typename T>
+      void Write(u32 address, T value, Bus bus) {
+        address &= ~(sizeof(T) - 1u);
+
+        if(const dual::arm::WritablePage page = m_write_pages.Get(address); page.data != nullptr) [[likely]] {
+          atom::write<T>(page.data, address & dual::arm::WritePageTable::k_page_mask, value);
+          (*page.code_page_version)++;
+          return;
+        }
+        WriteSlow<T>(address, value, bus);
+      }
+
+      template<typename T> T    ReadSlow (u32 address, Bus bus);
+      template<typename T> void WriteSlow(u32 address, T value, Bus bus);
+
+      void UpdatePageTables(u32 address_lo, u32 address_hi);
+      const u8* GetReadablePage(u32 address);
+      dual::arm::WritablePage GetWritablePage(u32 address);
 
       struct IO {
         u8  ReadByte(u32 address);
@@ -80,6 +122,12 @@ namespace dual::nds::arm7 {
       u8* m_iwram;
       SWRAM& m_swram;
       VRAM& m_vram;
+      SharedAccessMonitor& m_shared_access_monitor;
+      CodePageVersions& m_code_page_versions;
+
+      // @note: the buses only differ in main memory accesses, which always take the slow path, so they share the page tables.
+      dual::arm::ReadPageTable m_read_pages{};
+      dual::arm::WritePageTable m_write_pages{};
   };
 
 } // namespace dual::nds::arm7
@@ -3,6 +3,7 @@
 
 #include <atom/bit.hpp>
 #include <atom/integer.hpp>
+#include <dual/common/save_state.hpp>
 #include <dual/nds/irq.hpp>
 #include <memory>
 
@@ -24,11 +25,16 @@ namespace dual::nds::arm7 {
         virtual void Deselect() = 0;
 
         virtual u8 Transfer(u8 data) = 0;
+
+        virtual void SaveState(StateWriter& state) const = 0;
+        virtual void LoadState(StateReader& state) = 0;
       };
 
       explicit SPI(IRQ& irq);
 
       void Reset();
+      void SaveState(StateWriter& state) const;
+      void LoadState(StateReader& state);
 
       auto  Read_SPICNT() -> u16;
       void Write_SPICNT(u16 value, u16 mask);
@@ -63,7 +69,7 @@ namespace dual::nds::arm7 {
 
       std::unique_ptr<Device> m_firmware{};
       std::unique_ptr<Device> m_touch_screen{};
-      Device* m_device_table[4];
+      Device* m_device_table[4]{};
   };
 
 } // namespace dual::nds::arm7
\ No newline at end of file
@@ -26,6 +26,9 @@ namespace dual::nds::arm7 {
 
       u8 Transfer(u8 data) override;
 
+      void SaveState(StateWriter& state) const override;
+      void LoadState(StateReader& state) override;
+
       void SetCalibrationData(const CalibrationData& data);
       void SetTouchState(bool pen_down, u8 x, u8 y);
 
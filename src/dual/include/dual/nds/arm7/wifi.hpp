@@ -2,6 +2,7 @@
 #pragma once
 
 #include <atom/integer.hpp>
+#include <dual/common/save_state.hpp>
 #include <array>
 
 namespace dual::nds::arm7 {
@@ -9,6 +10,8 @@ namespace dual::nds::arm7 {
   class WIFI {
     public:
       void Reset();
+      void SaveState(StateWriter& state) const;
+      void LoadState(StateReader& state);
 
       u32   Read_IO(u32 address);
       void Write_IO(u32 address, u32 value, u32 mask);
@@ -4,6 +4,8 @@
 #include <atom/bit.hpp>
 #include <atom/integer.hpp>
 #include <dual/arm/memory.hpp>
+#include <dual/common/profiler.hpp>
+#include <dual/common/save_state.hpp>
 #include <dual/nds/irq.hpp>
 
 namespace dual::nds::arm9 {
@@ -21,9 +23,11 @@ namespace dual::nds::arm9 {
         GXFIFO = 7
       };
 
-      DMA(arm::Memory& bus, IRQ& irq) : m_bus{bus}, m_irq{irq} {}
+      DMA(arm::Memory& bus, IRQ& irq, Profiler& profiler) : m_bus{bus}, m_irq{irq}, m_profiler{profiler} {}
 
       void Reset();
+      void SaveState(StateWriter& state) const;
+      void LoadState(StateReader& state);
       void Request(StartTime timing);
       void SetGXFIFOLessThanHalfFull(bool less_than_half_full);
 
@@ -44,6 +48,7 @@ namespace dual::nds::arm9 {
 
       arm::Memory& m_bus;
       IRQ& m_irq;
+      Profiler& m_profiler;
 
       u32 m_dmasad[4]{};
       u32 m_dmadad[4]{};
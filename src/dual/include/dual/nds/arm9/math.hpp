@@ -3,12 +3,15 @@
 
 #include <atom/bit.hpp>
 #include <atom/integer.hpp>
+#include <dual/common/save_state.hpp>
 
 namespace dual::nds::arm9 {
 
   class Math {
     public:
       void Reset();
+      void SaveState(StateWriter& state) const;
+      void LoadState(StateReader& state);
 
       u32 Read_DIVCNT();
       u64 Read_DIV_NUMER();
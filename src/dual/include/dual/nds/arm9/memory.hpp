@@ -7,6 +7,7 @@
 #include <atom/panic.hpp>
 #include <atom/punning.hpp>
 #include <dual/arm/memory.hpp>
+#include <dual/arm/page_table.hpp>
 #include <dual/nds/video_unit/video_unit.hpp>
 #include <dual/nds/vram/vram.hpp>
 #include <dual/nds/arm9/math.hpp>
@@ -15,6 +16,7 @@
 #include <dual/nds/irq.hpp>
 #include <dual/nds/ipc.hpp>
 #include <dual/nds/swram.hpp>
+#include <dual/nds/sync.hpp>
 #include <dual/nds/system_memory.hpp>
 #include <dual/nds/timer.hpp>
 
@@ -33,6 +35,7 @@ namespace dual::nds::arm9 {
         VideoUnit& video_unit;
         Cartridge& cartridge;
         u32& key_input;
+        SharedAccessMonitor& shared_access_monitor;
       };
 
       struct TCM {
@@ -43,27 +46,76 @@ namespace dual::nds::arm9 {
           bool writable = false;
           u32 base_address = 0u;
           u32 high_address = 0u;
+
+          bool operator==(const Config& other) const = default;
         } config{};
       };
 
       MemoryBus(SystemMemory& memory, const HW& hw);
 
       void Reset();
+      void SaveState(StateWriter& state) const;
+      void LoadState(StateReader& state);
 
       void SetupDTCM(const TCM::Config& config);
       void SetupITCM(const TCM::Config& config);
 
-      u8  ReadByte(u32 address, Bus bus) override;
-      u16 ReadHalf(u32 address, Bus bus) override;
-      u32 ReadWord(u32 address, Bus bus) override;
+      /// Must be called when the main memory watch regions of the shared access monitor have changed.
+      void OnWatchRegionsChanged();
+
+      // @note: these are defined here, so that callers which know the concrete bus type (i.e. the interpreter) can inline the page table fast path.
+      u8  ReadByte(u32 address, Bus bus) override { return Read<u8 >(address, bus); }
+      u16 ReadHalf(u32 address, Bus bus) override { return Read<u16>(address, bus); }
+      u32 ReadWord(u32 address, Bus bus) override { return Read<u32>(address, bus); }
+
+      void WriteByte(u32 address, u8  value, Bus bus) override { Write<u8 >(address, value, bus); }
+      void WriteHalf(u32 address, u16 value, Bus bus) override { Write<u16>(address, value, bus); }
+      void WriteWord(u32 address, u32 value, Bus bus) override { Write<u32>(address, value, bus); }
+
+      const u64* GetCodePageVersion(u32 address) override;
+
+      const dual::arm::ReadPageTable* GetReadPageTable(Bus bus) const override {
+        return &m_read_pages[(int)bus];
+      }
 
-      void WriteByte(u32 address, u8  value, Bus bus) override;
-      void WriteHalf(u32 address, u16 value, Bus bus) override;
-      void WriteWord(u32 address, u32 value, Bus bus) override;
+      const dual::arm::WritePageTable* GetWritePageTable(Bus bus) const override {
+        if(bus == Bus::Code) {
+          return nullptr;
+        }
+        return &m_write_pages[bus == Bus::System];
+      }
 
     private:
-      template<typename T> T    Read (u32 address, Bus bus);
-      template<typename T> void Write(u32 address, T value, Bus bus);
+      template<typename T>
+      T Read(u32 address, Bus bus) {
+        address &= ~(sizeof(T) - 1u);
+
+        if(const u8* page = m_read_pages[(int)bus].Get(address); page != nullptr) [[likely]] {
+          return atom::read<T>(page, address & dual::arm::ReadPageTable::k_page_mask);
+        }
+        return ReadSlow<T>(address, bus);
+      }
+
+      template<typename T>
+      void Write(u32 address, T value, Bus bus) {
+        address &= ~(sizeof(T) - 1u);
+
+        if(bus != Bus::Code) [[likely]] {
+          if(const dual::arm::WritablePage page = m_write_pages[bus == Bus::System].Get(address); page.data != nullptr) [[likely]] {
+            atom::write<T>(page.data, address & dual::arm::WritePageTable::k_page_mask, value);
+            (*page.code_page_version)++;
+            return;
+          }
+        }
+        WriteSlow<T>(address, value, bus);
+      }
+
+      template<typename T> T    ReadSlow (u32 address, Bus bus);
+      template<typename T> void WriteSlow(u32 address, T value, Bus bus);
+
+      void UpdatePageTables(u32 address_lo, u32 address_hi);
+      const u8* GetReadablePage(u32 address, Bus bus);
+      dual::arm::WritablePage GetWritablePage(u32 address, Bus bus);
 
       template<typename T>
       T ReadVRAM_PPU_BG(u32 address, int ppu_id) {
@@ -166,6 +218,15 @@ namespace dual::nds::arm9 {
       u8* m_oam;
       SWRAM& m_swram;
       VRAM& m_vram;
+      SharedAccessMonitor& m_shared_access_monitor;
+      CodePageVersions& m_code_page_versions;
+
+      // @note: the code bus is never written to, so there only are write page tables for the data and system bus.
+      std::array<dual::arm::ReadPageTable, 3> m_read_pages{};
+      std::array<dual::arm::WritePageTable, 2> m_write_pages{};
+
+      // Code is not fetched from DTCM, but writes to it are counted somewhere, so that the write fast path needs no extra check.
+      u64 m_dtcm_write_count = 0u;
   };
 
 } // namespace dual::nds::arm9
@@ -16,7 +16,7 @@ namespace dual::nds {
         _128K
       };
 
-      EEPROM(const std::string& save_path, Size size_hint, bool fram);
+      EEPROM(const std::string& save_path, Size size_hint, bool fram, bool write_back = true);
 
       void Reset() override;
       void Select() override;
@@ -24,6 +24,9 @@ namespace dual::nds {
 
       u8 Transfer(u8 data) override;
 
+      void SaveState(StateWriter& state) const override;
+      void LoadState(StateReader& state) override;
+
     private:
       enum class Command : u8 {
         WriteEnable  = 0x06, // WREM
@@ -59,6 +62,7 @@ namespace dual::nds {
       Size m_size_hint{};
       Size m_size{};
       bool m_fram{};
+      bool m_write_back{};
       size_t m_mask{};
       size_t m_page_mask{};
       u32 m_address_upper_half{};
@@ -9,7 +9,7 @@ namespace dual::nds {
   // EEPROM 512B memory emulation
   class EEPROM512B final : public arm7::SPI::Device {
     public:
-      explicit EEPROM512B(const std::string& save_path);
+      explicit EEPROM512B(const std::string& save_path, bool write_back = true);
 
       void Reset() override;
       void Select() override;
@@ -17,6 +17,9 @@ namespace dual::nds {
 
       u8 Transfer(u8 data) override;
 
+      void SaveState(StateWriter& state) const override;
+      void LoadState(StateReader& state) override;
+
     private:
       enum class Command : u8 {
         WriteEnable  = 0x06, // WREM
@@ -46,6 +49,7 @@ namespace dual::nds {
       int  m_write_protect_mode{};
 
       std::string m_save_path{};
+      bool m_write_back{};
 
       std::unique_ptr<BackupFile> m_file{};
   };
@@ -16,7 +16,7 @@ namespace dual::nds {
         _8192K
       };
 
-      FLASH(const std::string& save_path, Size size_hint);
+      FLASH(const std::string& save_path, Size size_hint, bool write_back = true);
 
       void Reset() override;
       void Select() override;
@@ -24,6 +24,9 @@ namespace dual::nds {
 
       u8 Transfer(u8 data) override;
 
+      void SaveState(StateWriter& state) const override;
+      void LoadState(StateReader& state) override;
+
     private:
       enum class Command : u8 {
         WriteEnable   = 0x06, // WREM
@@ -67,6 +70,7 @@ namespace dual::nds {
 
       std::string m_save_path{};
       Size m_size_hint{};
+      bool m_write_back{};
       size_t m_mask{};
 
       std::unique_ptr<BackupFile> m_file;
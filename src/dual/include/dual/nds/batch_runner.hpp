@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atom/integer.hpp>
+#include <dual/common/thread_pool.hpp>
+#include <dual/nds/nds.hpp>
+#include <functional>
+#include <vector>
+
+namespace dual::nds {
+
+  /**
+   * Runs many systems in one process on a fixed number of worker threads.
+   * Every system steps on one worker at a time, and the PPUs of all systems render on the same workers,
+   * so that the host is never oversubscribed no matter how many systems there are.
+   *
+   * The systems should share their ROM (see NDS::LoadROM()) and should not use QuantumPolicy::threaded_arm7,
+   * which runs the ARM7 on a thread of its own.
+   */
+  class BatchRunner {
+    public:
+      explicit BatchRunner(int thread_count);
+     ~BatchRunner();
+
+      [[nodiscard]] int GetThreadCount() const {
+        return m_thread_pool.GetThreadCount();
+      }
+
+      [[nodiscard]] size_t GetInstanceCount() const {
+        return m_instances.size();
+      }
+
+      ThreadPool& GetThreadPool() {
+        return m_thread_pool;
+      }
+
+      // The system must outlive the batch runner or be removed first.
+      void Add(NDS* nds);
+      void Remove(NDS* nds);
+
+      /**
+       * Run every system for the given number of frames, in parallel, and return the number of system cycles that were run in total.
+       * The callback (if any) is invoked on the worker thread of each system after each of its frames.
+       */
+      u64 RunFrames(int frames, const std::function<void(NDS& nds, int frame)>& frame_callback = {});
+
+    private:
+      ThreadPool m_thread_pool;
+      std::vector<NDS*> m_instances{};
+  };
+
+} // namespace dual::nds
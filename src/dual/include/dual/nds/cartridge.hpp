@@ -26,6 +26,8 @@ namespace dual::nds {
       );
 
       void Reset();
+      void SaveState(StateWriter& state) const;
+      void LoadState(StateReader& state);
       void DirectBoot();
 
       void SetROM(
@@ -51,7 +53,8 @@ namespace dual::nds {
       // @todo: use a plausible chip ID based on the ROM size.
       static constexpr u32 k_chip_id = 0x1FC2u;
 
-      void HandleCommand();
+      void HandleCommand(int cycles_late);
+      void OnDataReady(int cycles_late);
 
       void Encrypt64(u32* key_buffer, u32* ptr);
       void Decrypt64(u32* key_buffer, u32* ptr);
@@ -101,6 +104,8 @@ namespace dual::nds {
       u32 m_key1_buffer_lvl3[0x412]{};
 
       Scheduler& m_scheduler;
+      Scheduler::Event m_command_event{};
+      Scheduler::Event m_data_ready_event{};
       IRQ* m_irq[2]{};
       arm9::DMA& m_dma9;
       arm7::DMA& m_dma7;
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <atom/integer.hpp>
+#include <dual/arm/memory.hpp>
+
+namespace dual::nds {
+
+  /**
+   * Write counters for the pages of the memories which code can run from (see dual::arm::Memory::GetCodePageVersion()).
+   * The memory buses count every write to these memories, so that the interpreter notices when code it has decoded was overwritten.
+   * Code which is written by other means (for example when loading a state) must be followed by InvalidateAll().
+   */
+  struct CodePageVersions {
+    template<size_t size>
+    struct Pages {
+      static constexpr u32 k_page_size = arm::Memory::k_code_page_size;
+
+      void OnWrite(u32 offset) {
+        versions[offset / k_page_size]++;
+      }
+
+      const u64* Get(u32 offset) const {
+        return &versions[offset / k_page_size];
+      }
+
+      u64* Get(u32 offset) {
+        return &versions[offset / k_page_size];
+      }
+
+      void InvalidateAll() {
+        for(u64& version : versions) version++;
+      }
+
+      std::array<u64, (size + k_page_size - 1u) / k_page_size> versions{};
+    };
+
+    /// Must be called when the memory map changes, since the code which was decoded for an address may now come from another page.
+    void InvalidateAll() {
+      ewram.InvalidateAll();
+      swram.InvalidateAll();
+      arm9_itcm.InvalidateAll();
+      arm9_bios.InvalidateAll();
+      arm7_iwram.InvalidateAll();
+      arm7_bios.InvalidateAll();
+    }
+
+    Pages<0x400000> ewram{};
+    Pages<0x8000> swram{};
+    Pages<0x8000> arm9_itcm{};
+    Pages<0x8000> arm9_bios{};
+    Pages<0x10000> arm7_iwram{};
+    Pages<0x4000> arm7_bios{};
+  };
+
+} // namespace dual::nds
@@ -3,17 +3,21 @@
 
 #include <atom/bit.hpp>
 #include <dual/common/fifo.hpp>
+#include <dual/common/save_state.hpp>
 #include <dual/nds/enums.hpp>
 #include <dual/nds/irq.hpp>
+#include <dual/nds/sync.hpp>
 
 namespace dual::nds {
 
   // Inter-Process Communication hardware for ARM9 and ARM7 synchronization and message passing.
   class IPC {
     public:
-      IPC(IRQ& irq9, IRQ& irq7);
+      IPC(IRQ& irq9, IRQ& irq7, SharedAccessMonitor& shared_access_monitor);
 
       void Reset();
+      void SaveState(StateWriter& state) const;
+      void LoadState(StateReader& state);
 
       u32   Read_SYNC(CPU cpu);
       void Write_SYNC(CPU cpu, u32 value, u32 mask);
@@ -49,6 +53,7 @@ namespace dual::nds {
       } m_fifo[2];
 
       IRQ* m_irq[2]{};
+      SharedAccessMonitor& m_shared_access_monitor;
   };
 
 } // namespace dual::nds
@@ -4,6 +4,7 @@
 #include <atom/integer.hpp>
 #include <atom/panic.hpp>
 #include <dual/arm/cpu.hpp>
+#include <dual/common/save_state.hpp>
 
 namespace dual::nds {
 
@@ -34,6 +35,8 @@ namespace dual::nds {
       explicit IRQ(bool arm9) : m_arm9{arm9} {}
 
       void Reset();
+      void SaveState(StateWriter& state) const;
+      void LoadState(StateReader& state);
       auto GetCPU() -> arm::CPU*;
       void SetCPU(arm::CPU* cpu);
       void Request(Source source);
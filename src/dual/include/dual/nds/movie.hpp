@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atom/integer.hpp>
+#include <dual/nds/enums.hpp>
+#include <string>
+#include <vector>
+
+namespace dual::nds {
+
+  /**
+   * A recording of the key and touch input of a run, which starts right after the ROM has been loaded and booted.
+   * Every input is stamped with the emulated cycle at which it was applied, so that playback applies it at the very same point
+   * no matter how the emulator is driven (see NDS::RecordMovie() and NDS::PlayMovie()).
+   *
+   * Playback is only deterministic with the same ROM, boot ROMs and quantum policy. The CPU execution engine may differ,
+   * which is what makes movies useful to compare the interpreter against the JIT.
+   * The optional per-frame hashes (see NDS::HashFrame()) tell at which frame a playback diverged from the recording.
+   */
+  struct Movie {
+    enum class InputType : u8 {
+      Key,
+      Touch
+    };
+
+    struct Input {
+      u64 timestamp;
+      InputType type;
+      Key key;      //< InputType::Key only
+      bool pressed; //< Key is pressed or the pen is down
+      u8 x;         //< InputType::Touch only
+      u8 y;         //< InputType::Touch only
+    };
+
+    bool Save(const std::string& path) const;
+    bool Load(const std::string& path);
+
+    u32 rom_game_code{};
+    u16 rom_header_crc{};
+    u64 start_timestamp{};
+    std::vector<Input> inputs{};
+    std::vector<u64> frame_hashes{};
+  };
+
+} // namespace dual::nds
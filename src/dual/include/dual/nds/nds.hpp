@@ -3,6 +3,7 @@
 
 #include <dual/arm/cpu.hpp>
 #include <dual/common/cycle_counter.hpp>
+#include <dual/common/profiler.hpp>
 #include <dual/common/scheduler.hpp>
 #include <dual/nds/arm7/apu.hpp>
 #include <dual/nds/arm7/dma.hpp>
@@ -18,27 +19,77 @@
 #include <dual/nds/cartridge.hpp>
 #include <dual/nds/ipc.hpp>
 #include <dual/nds/irq.hpp>
+#include <dual/nds/movie.hpp>
 #include <dual/nds/rom.hpp>
+#include <dual/nds/sync.hpp>
 #include <dual/nds/system_memory.hpp>
 #include <dual/nds/timer.hpp>
 #include <dual/nds/enums.hpp>
+#include <limits>
 #include <memory>
 #include <span>
+#include <vector>
 
 namespace dual::nds {
 
+  class CPUThread;
+
   class NDS {
     public:
       NDS();
+     ~NDS();
 
       void Reset();
       void SetCPUExecutionEngine(CPUExecutionEngine cpu_execution_engine);
+
+      /**
+       * Run the emulator for at least the given number of cycles. The last slice may run past the target,
+       * which is then subtracted from the next step. This way the slices do not depend on how a frontend steps the emulator.
+       */
       void Step(int cycles_to_run);
+
+      struct RunTarget {
+        static constexpr RunTarget VBlank() {
+          return {VideoUnit::k_drawing_lines};
+        }
+
+        static constexpr RunTarget Scanline(int line) {
+          return {line};
+        }
+
+        int line;
+      };
+
+      /**
+       * Run the emulator until the video unit begins the target scanline and return the number of system cycles that were run.
+       * RunFrame() runs until the beginning of the next frame, which is right after the current frame has been presented.
+       */
+      u64 RunFrame();
+      u64 RunUntil(RunTarget target);
+
       void LoadBootROM9(std::span<u8, 0x8000> data);
       void LoadBootROM7(std::span<u8, 0x4000> data);
       void LoadROM(std::shared_ptr<ROM> rom, std::shared_ptr<dual::nds::arm7::SPI::Device> backup);
       void DirectBoot();
 
+      /**
+       * Save the state of the whole system into a buffer, which is resized to fit.
+       * The state does not include the ROM, the boot ROMs and the settings (like the CPU execution engine and the quantum policy).
+       * It must be loaded into a system which has been reset with the same ROM and settings. Returns false if the state has an unknown format.
+       */
+      void SaveState(std::vector<u8>& state);
+      bool LoadState(std::span<const u8> state);
+
+      /**
+       * Render on the worker threads of a pool which is shared by many systems, instead of on two render threads per system.
+       * Null goes back to render threads of its own. The pool must outlive the system or be detached first.
+       */
+      void SetThreadPool(ThreadPool* thread_pool);
+
+      Scheduler& GetScheduler() {
+        return m_scheduler;
+      }
+
       VideoUnit& GetVideoUnit() {
         return m_video_unit;
       }
@@ -47,17 +98,91 @@ namespace dual::nds {
         return m_arm7.apu;
       }
 
+      arm9::MemoryBus& GetARM9MemoryBus() {
+        return m_arm9.bus;
+      }
+
+      arm7::MemoryBus& GetARM7MemoryBus() {
+        return m_arm7.bus;
+      }
+
+      const QuantumPolicy& GetQuantumPolicy() const {
+        return m_quantum_policy;
+      }
+
+      void SetQuantumPolicy(const QuantumPolicy& policy);
+
+      const QuantumStats& GetQuantumStats() const {
+        return m_quantum_stats;
+      }
+
+      void ResetQuantumStats();
+
+      const arm::IdleLoopStats& GetIdleLoopStats(CPU cpu) const;
+      void ResetIdleLoopStats();
+
+      /// Instructions executed by a CPU since the NDS was created, or zero if its CPU engine does not count them (the JIT does not).
+      u64 GetRetiredInstructions(CPU cpu) const;
+
+      /// Host time spent in each subsystem of this instance. This is empty unless the core was built with DUAL_ENABLE_PROFILER.
+      Profile GetProfile() const;
+      void ResetProfile();
+
+      /**
+       * Approximate host memory owned by this instance: the emulated memory and the render buffers which have been allocated so far.
+       * The CPU cores (including the JIT code cache) and the ROM are not included.
+       */
+      [[nodiscard]] size_t GetMemoryUsage() const;
+
+      /**
+       * Main memory regions which the CPUs use to share data with each other.
+       * With QuantumPolicy::catch_up the CPUs synchronize on every access to them.
+       */
+      void AddSyncWatchRegion(u32 address, u32 size);
+      void ClearSyncWatchRegions();
+
       void SetKeyState(Key key, bool pressed);
       void SetTouchState(bool pen_down, u8 x, u8 y);
 
+      /**
+       * Record all key and touch input into the movie until StopMovie() is called. The recording starts at the current cycle,
+       * so call this right after the ROM has been loaded and booted. Adding frame hashes to the movie is up to the caller.
+       */
+      void RecordMovie(Movie* movie);
+
+      /**
+       * Apply the input of the movie at the very cycles at which it was recorded, until StopMovie() is called.
+       * Returns false if the movie was recorded with another ROM or does not start at the current cycle.
+       */
+      bool PlayMovie(const Movie* movie);
+      void StopMovie();
+
+      /**
+       * Hash the two framebuffers and optionally main memory, shared WRAM and ARM7 WRAM,
+       * which tells if two runs of a movie went the same way. Meant to be called from the presentation callback.
+       */
+      u64 HashFrame(const u32* fb_top, const u32* fb_bottom, bool include_memory = true) const;
+
     private:
       void CreateCPUCores();
+      void UpdateQuantum(bool shared_access);
+      bool RunCPU(CPU cpu, u64 timestamp);
+      void CatchUp(CPU cpu);
+      bool IsCatchUpEnabled() const;
+      bool IsThreadedARM7Enabled() const;
+      void UpdateSyncCallbacks();
+      void UpdateIdleLoopDetection();
+      void ApplyMovieInput();
+
+      Profiler m_profiler{};
 
       Scheduler m_scheduler{};
 
+      SharedAccessMonitor m_shared_access_monitor{};
+
       SystemMemory m_memory{};
 
-      VideoUnit m_video_unit{m_scheduler, m_memory, m_arm9.irq, m_arm7.irq, m_arm9.dma, m_arm7.dma};
+      VideoUnit m_video_unit{m_scheduler, m_memory, m_arm9.irq, m_arm7.irq, m_arm9.dma, m_arm7.dma, m_profiler};
 
       Cartridge m_cartridge{m_scheduler, m_arm9.irq, m_arm7.irq, m_arm9.dma, m_arm7.dma, m_memory};
 
@@ -70,10 +195,10 @@ namespace dual::nds {
         arm9::MemoryBus bus;
         IRQ irq{true};
         Timer timer;
-        arm9::DMA dma{bus, irq};
+        arm9::DMA dma;
         arm9::Math math{};
 
-        ARM9(Scheduler& scheduler, SystemMemory& memory, IPC& ipc, VideoUnit& video_unit, Cartridge& cartridge, u32& key_input)
+        ARM9(Scheduler& scheduler, SystemMemory& memory, IPC& ipc, VideoUnit& video_unit, Cartridge& cartridge, u32& key_input, SharedAccessMonitor& shared_access_monitor, Profiler& profiler)
             : bus{memory, {
                 irq,
                 timer,
@@ -84,10 +209,12 @@ namespace dual::nds {
                 math,
                 video_unit,
                 cartridge,
-                key_input
+                key_input,
+                shared_access_monitor
               }}
-            , timer{scheduler, cycle_counter, irq} {}
-      } m_arm9{m_scheduler, m_memory, m_ipc, m_video_unit, m_cartridge, m_key_input};
+            , timer{scheduler, cycle_counter, irq}
+            , dma{bus, irq, profiler} {}
+      } m_arm9{m_scheduler, m_memory, m_ipc, m_video_unit, m_cartridge, m_key_input, m_shared_access_monitor, m_profiler};
 
       struct ARM7 {
         CycleCounter cycle_counter{0};
@@ -95,13 +222,13 @@ namespace dual::nds {
         arm7::MemoryBus bus;
         IRQ irq{false};
         Timer timer;
-        arm7::DMA dma{bus, irq};
+        arm7::DMA dma;
         arm7::SPI spi{irq};
         arm7::RTC rtc{};
         arm7::APU apu;
         arm7::WIFI wifi{};
 
-        ARM7(Scheduler& scheduler, SystemMemory& memory, IPC& ipc, VideoUnit& video_unit, Cartridge& cartridge, u32& key_input)
+        ARM7(Scheduler& scheduler, SystemMemory& memory, IPC& ipc, VideoUnit& video_unit, Cartridge& cartridge, u32& key_input, SharedAccessMonitor& shared_access_monitor, Profiler& profiler)
             : bus{memory, {
                 irq,
                 timer,
@@ -115,18 +242,33 @@ namespace dual::nds {
                 rtc,
                 apu,
                 wifi,
-                key_input
+                key_input,
+                shared_access_monitor
               }}
             , timer{scheduler, cycle_counter, irq}
-            , apu{scheduler, bus} {}
-      } m_arm7{m_scheduler, m_memory, m_ipc, m_video_unit, m_cartridge, m_key_input};
+            , dma{bus, irq, profiler}
+            , apu{scheduler, bus, profiler} {}
+      } m_arm7{m_scheduler, m_memory, m_ipc, m_video_unit, m_cartridge, m_key_input, m_shared_access_monitor, m_profiler};
 
-      IPC m_ipc{m_arm9.irq, m_arm7.irq};
+      IPC m_ipc{m_arm9.irq, m_arm7.irq, m_shared_access_monitor};
 
       std::shared_ptr<ROM> m_rom;
 
       u64 m_step_target{};
 
+      ThreadPool* m_thread_pool{};
+
+      Movie* m_movie_recording{};
+      const Movie* m_movie_playback{};
+      size_t m_movie_input_index{};
+      u64 m_movie_next_timestamp{std::numeric_limits<u64>::max()};
+
+      QuantumPolicy m_quantum_policy{};
+      QuantumStats m_quantum_stats{};
+      int m_quiet_slices{};
+
+      std::unique_ptr<CPUThread> m_arm7_thread{};
+
       CPUExecutionEngine m_cpu_execution_engine{CPUExecutionEngine::Interpreter};
   };
 
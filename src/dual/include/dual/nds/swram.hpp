@@ -3,24 +3,47 @@
 
 #include <array>
 #include <atom/integer.hpp>
+#include <dual/common/save_state.hpp>
+#include <dual/nds/code_page_versions.hpp>
+#include <functional>
+#include <vector>
 
 namespace dual::nds {
 
   struct SWRAM {
+    using Callback = std::function<void()>;
+
+    explicit SWRAM(CodePageVersions& code_page_versions) : m_code_page_versions{code_page_versions} {}
+
     void Reset();
+    void SaveState(StateWriter& state) const;
+    void LoadState(StateReader& state);
 
     u32   Read_WRAMCNT();
     void Write_WRAMCNT(u8 value);
 
+    /// The callback is invoked whenever WRAMCNT changes which memory the CPUs see.
+    void AddCallback(const Callback& callback) {
+      m_callbacks.push_back(callback);
+    }
+
     struct Allocation {
       u8* data{};
       u32 mask{};
     } arm9{}, arm7{};
 
+    /// Offset into the 32 KiB of SWRAM for an address inside the allocation of a CPU.
+    u32 GetOffset(const Allocation& allocation, u32 address) const {
+      return (u32)(allocation.data - m_swram.data()) + (address & allocation.mask);
+    }
+
   //private:
-    std::array<u8, 0x8000> m_swram;
+    std::array<u8, 0x8000> m_swram{};
 
     u8 m_wramcnt = 0u;
+
+    CodePageVersions& m_code_page_versions;
+    std::vector<Callback> m_callbacks{};
   };
 
 } // namespace dual::nds
@@ -0,0 +1,184 @@
+
+#pragma once
+
+#include <algorithm>
+#include <atom/integer.hpp>
+#include <dual/nds/enums.hpp>
+
+namespace dual::nds {
+
+  /**
+   * Counts accesses to state that the ARM9 and ARM7 use to talk to each other,
+   * which are IPC register accesses and ARM7 data accesses to main memory.
+   * NDS::Step uses it to tell whether the CPUs may safely run out of lock-step for longer.
+   *
+   * Accesses to state that the other CPU can observe (IPC, shared IO and the main memory watch regions)
+   * additionally invoke the sync callback, which lets the other CPU catch up with the accessing CPU first.
+   *
+   * The thread sync callback is invoked for the same accesses, and also for every ARM7 access to IO, main memory and VRAM,
+   * except for reads of IO that only the ARM7 and events modify. It is used to synchronize the CPUs when the ARM7 runs on its own host thread.
+   */
+  class SharedAccessMonitor {
+    public:
+      using SyncCallback = void (*)(void* object, CPU cpu);
+
+      void Reset() {
+        m_access_count = 0u;
+      }
+
+      void SetSyncCallback(SyncCallback callback, void* object) {
+        m_sync_callback = callback;
+        m_sync_object = object;
+      }
+
+      void SetThreadSyncCallback(SyncCallback callback, void* object) {
+        m_thread_sync_callback = callback;
+        m_thread_sync_object = object;
+      }
+
+      void OnAccess() {
+        m_access_count++;
+      }
+
+      void Sync(CPU cpu) {
+        // @note: the count must only be updated after the thread sync, which keeps the ARM9 and the ARM7 thread from updating it at the same time.
+        ThreadSync(cpu);
+
+        m_access_count++;
+
+        if(m_sync_callback) {
+          m_sync_callback(m_sync_object, cpu);
+        }
+      }
+
+      void ThreadSync(CPU cpu) {
+        if(m_thread_sync_callback) [[unlikely]] {
+          m_thread_sync_callback(m_thread_sync_object, cpu);
+        }
+      }
+
+      void OnAccessIO(CPU cpu, u32 address) {
+        if(IsSharedIO(address)) {
+          Sync(cpu);
+        } else if(cpu == CPU::ARM7) {
+          ThreadSync(cpu);
+        }
+      }
+
+      void OnReadIO(CPU cpu, u32 address) {
+        // @note: events only run in between slices, so these reads observe the same value no matter how far the ARM9 is.
+        if(cpu == CPU::ARM7 && IsPrivateARM7IO(address)) {
+          return;
+        }
+
+        OnAccessIO(cpu, address);
+      }
+
+      void OnAccessEWRAM(CPU cpu, u32 address) {
+        if(IsWatched(address)) {
+          Sync(cpu);
+        } else if(cpu == CPU::ARM7) {
+          OnAccess();
+        }
+      }
+
+      void AddWatchRegion(u32 address, u32 size) {
+        if(size == 0u) {
+          return;
+        }
+
+        const u64 first_address = address & 0x3FFFFFu;
+        const u64 last_address = first_address + size - 1u;
+
+        const u32 first_page = (u32)(first_address >> k_page_shift);
+        const u32 last_page = (u32)std::min<u64>(last_address >> k_page_shift, k_page_count - 1u);
+
+        for(u32 page = first_page; page <= last_page; page++) {
+          m_watched_pages[page >> 6] |= 1ull << (page & 63u);
+        }
+      }
+
+      void ClearWatchRegions() {
+        for(auto& pages : m_watched_pages) pages = 0u;
+      }
+
+      /// Whether the address is in a main memory watch region, where ARM9 data accesses invoke the sync callback.
+      bool IsWatched(u32 address) const {
+        const u32 page = (address & 0x3FFFFFu) >> k_page_shift;
+
+        return m_watched_pages[page >> 6] & (1ull << (page & 63u));
+      }
+
+      u64 GetAccessCount() const {
+        return m_access_count;
+      }
+
+    private:
+      static constexpr int k_page_shift = 12;
+      static constexpr u32 k_page_count = 0x400000u >> k_page_shift;
+
+      static bool IsSharedIO(u32 address) {
+        // @note: the IPC registers synchronize from within the IPC class.
+        return (address >= 0x040001A0u && address <= 0x040001BFu) || // Cartridge interface
+               (address >= 0x04000204u && address <= 0x04000207u) || // EXMEMCNT
+               (address >= 0x04000240u && address <= 0x04000249u) || // VRAMCNT, WRAMCNT
+                address == 0x04100010u;                             // Cartridge data
+      }
+
+      static bool IsPrivateARM7IO(u32 address) {
+        // @note: these reads must be free of side effects and the ARM9 must not be able to modify the registers.
+        return (address >= 0x04000004u && address <= 0x04000007u) || // DISPSTAT, VCOUNT
+               (address >= 0x040000B0u && address <= 0x040000DFu) || // DMA
+               (address >= 0x04000100u && address <= 0x0400010Fu) || // Timers
+               (address >= 0x04000130u && address <= 0x04000138u) || // KEYINPUT, EXTKEYIN, RTC
+               (address >= 0x04000208u && address <= 0x04000213u) || // IME, IE
+                address == 0x04000300u ||                            // POSTFLG
+               (address >= 0x04000400u && address <= 0x0400051Fu);   // Sound
+      }
+
+      u64 m_access_count{};
+
+      SyncCallback m_sync_callback{};
+      void* m_sync_object{};
+
+      SyncCallback m_thread_sync_callback{};
+      void* m_thread_sync_object{};
+
+      u64 m_watched_pages[k_page_count / 64u]{};
+  };
+
+  /**
+   * Controls how many system cycles the CPUs may run before they are synchronized again.
+   * The quantum starts out at min_cycles, doubles after every grow_after consecutive slices
+   * without any shared accesses (up to max_cycles) and falls back to min_cycles on the next shared access.
+   *
+   * With catch_up enabled the CPUs instead run up to the next event in one go,
+   * and whenever one CPU accesses state that the other CPU can observe, the other CPU first catches up to it.
+   * This requires the interpreter, because the JIT does not update the cycle counter while it runs.
+   *
+   * With threaded_arm7 enabled, idle loops are only skipped on the ARM9, because the ARM9 may schedule events while the ARM7 runs.
+   */
+  struct QuantumPolicy {
+    bool adaptive = true;
+    bool skip_halted_cpu = true; //< run the awake CPU straight to the next event while the other CPU is halted.
+    bool catch_up = false;
+    bool threaded_arm7 = false; //< run the ARM7 on its own host thread (JIT only)
+    bool skip_idle_loops = true; //< fast-forward a CPU to the next event while it spins in a loop that waits for IO or memory to change
+    int min_cycles = 32;
+    int max_cycles = 1024;
+    int grow_after = 4;
+  };
+
+  struct QuantumStats {
+    u64 slices = 0u;
+    u64 single_cpu_slices = 0u; //< slices where one CPU was halted
+    u64 idle_slices = 0u;       //< slices where both CPUs were halted
+    u64 shared_slices = 0u;     //< slices with at least one shared access
+    u64 cpu_runs = 0u;          //< calls to CPU::Run(), including the ones to catch up
+    u64 catch_ups = 0u;
+    u64 parallel_slices = 0u;   //< slices where the ARM7 ran on its own host thread
+    u64 cycles = 0u;
+    int quantum = 0;
+  };
+
+} // namespace dual::nds
@@ -3,15 +3,18 @@
 
 #include <array>
 #include <atom/integer.hpp>
+#include <dual/nds/code_page_versions.hpp>
 #include <dual/nds/vram/vram.hpp>
 #include <dual/nds/swram.hpp>
 
 namespace dual::nds {
 
   struct SystemMemory {
+    CodePageVersions code_page_versions{};
+
     std::array<u8, 0x400000> ewram{};
 
-    SWRAM swram{};
+    SWRAM swram{code_page_versions};
 
     VRAM vram{};
     std::array<u8, 0x800> pram;
@@ -4,6 +4,7 @@
 #include <atom/bit.hpp>
 #include <atom/integer.hpp>
 #include <dual/common/cycle_counter.hpp>
+#include <dual/common/save_state.hpp>
 #include <dual/common/scheduler.hpp>
 #include <dual/nds/irq.hpp>
 
@@ -14,6 +15,8 @@ namespace dual::nds {
       Timer(Scheduler& scheduler, CycleCounter& cpu_cycle_counter, IRQ& irq);
 
       void Reset();
+      void SaveState(StateWriter& state) const;
+      void LoadState(StateReader& state);
 
       auto  Read_TMCNT(int id) -> u32;
       void Write_TMCNT(int id, u32 value, u32 mask);
@@ -21,6 +24,7 @@ namespace dual::nds {
     private:
 
       void ScheduleTimerOverflow(int id, int cycle_offset);
+      template<int id> void OnOverflow(int cycles_late);
       void DoOverflow(int id);
       u16  GetTicksSinceLastReload(int id);
 
@@ -42,7 +46,7 @@ namespace dual::nds {
         u16 counter = 0u;
         int divider_shift{};
         u64 timestamp_last_reload{};
-        Scheduler::Event* event = nullptr;
+        Scheduler::Event event{};
       } m_channel[4];
   };
 
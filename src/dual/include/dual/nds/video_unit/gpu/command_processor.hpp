@@ -26,6 +26,8 @@ namespace dual::nds::gpu {
       );
 
       void Reset();
+      void SaveState(StateWriter& state) const;
+      void LoadState(StateReader& state);
 
       [[nodiscard]] const Matrix4<Fixed20x12>& GetClipMatrix() const {
         if(m_clip_mtx_dirty) {
@@ -96,6 +98,7 @@ namespace dual::nds::gpu {
 
       void ProcessCommands();
       void ProcessCommandsImpl();
+      void OnCommandEvent(int cycles_late);
       void ExecuteCommand(u8 command);
 
       void cmdMatrixMode();
@@ -158,7 +161,7 @@ namespace dual::nds::gpu {
 
       FIFO<u64, 4>   m_cmd_pipe;
       FIFO<u64, 256> m_cmd_fifo;
-      Scheduler::Event* m_cmd_event{};
+      Scheduler::Event m_cmd_event{};
 
       // Matrix Engine
       int m_mtx_mode{};
@@ -3,6 +3,7 @@
 
 #include <atom/bit.hpp>
 #include <atom/vector_n.hpp>
+#include <dual/common/save_state.hpp>
 #include <dual/nds/video_unit/gpu/math.hpp>
 #include <dual/nds/video_unit/gpu/registers.hpp>
 #include <span>
@@ -87,6 +88,8 @@ namespace dual::nds::gpu {
       explicit GeometryEngine(gpu::IO& io);
 
       void Reset();
+      void SaveState(StateWriter& state) const;
+      void LoadState(StateReader& state);
       void SwapBuffers();
 
       void Begin(u32 parameter);
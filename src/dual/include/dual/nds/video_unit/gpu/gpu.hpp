@@ -20,15 +20,23 @@ namespace dual::nds {
         Scheduler& scheduler,
         IRQ& arm9_irq,
         arm9::DMA& arm9_dma,
-        const VRAM& vram
+        const VRAM& vram,
+        Profiler& profiler
       );
 
       void Reset();
+      void SaveState(StateWriter& state) const;
+      void LoadState(StateReader& state);
 
       void Render() {
         m_renderer->Render(m_cmd_processor.GetViewport(), m_geometry_engine.GetPolygonsToRender());
       }
 
+      // Rasterize the frame started by Render(), unless that has happened already. This must be done before capturing it.
+      void RenderPendingFrame() {
+        m_renderer->RenderPendingFrame();
+      }
+
       void CaptureColor(int scanline, std::span<u16, 256> dst_buffer, int dst_width, bool display_capture) {
         m_renderer->CaptureColor(scanline, dst_buffer, dst_width, display_capture);
       }
@@ -132,9 +140,15 @@ namespace dual::nds {
       }
 
       void SwapBuffers() {
+        // Whatever was not read from the last frame by now never will be, and swapping may replace its polygons.
+        m_renderer->DiscardPendingFrame();
         m_cmd_processor.SwapBuffers(m_renderer.get());
       }
 
+      [[nodiscard]] size_t GetLazyMemoryUsage() const {
+        return m_renderer->GetLazyMemoryUsage();
+      }
+
       [[nodiscard]] bool GetRenderEnginePowerOn() const {
         return m_render_engine_power_on;
       }
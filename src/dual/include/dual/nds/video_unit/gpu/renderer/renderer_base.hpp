@@ -3,6 +3,7 @@
 
 // @todo: move the Polygon and Vertex definitions outside the geometry engine header.
 #include <dual/nds/video_unit/gpu/geometry_engine.hpp>
+#include <dual/common/save_state.hpp>
 
 #include <span>
 
@@ -23,10 +24,27 @@ namespace dual::nds::gpu {
       virtual void UpdateEdgeColor(size_t table_offset, std::span<const u32> table_data) = 0;
       virtual void UpdateToonTable(size_t table_offset, std::span<const u32> table_data) = 0;
 
+      /**
+       * Start rendering a frame. The renderer takes a snapshot of the registers and VRAM right away,
+       * but may leave rasterizing the frame until RenderPendingFrame() is called, which must happen before capturing the frame.
+       * The polygons must stay untouched until then, or until the frame is thrown away by DiscardPendingFrame().
+       */
       virtual void Render(const Viewport& viewport, std::span<const Polygon* const> polygons) = 0;
+      virtual void RenderPendingFrame() = 0;
+      virtual void DiscardPendingFrame() = 0;
 
       virtual void CaptureColor(int scanline, std::span<u16, 256> dst_buffer, int dst_width, bool display_capture) = 0;
       virtual void CaptureAlpha(int scanline, std::span<int, 256> dst_buffer) = 0;
+
+      /**
+       * Saves the state which outlives a single Render() call. The edge color and toon tables are restored by the GPU.
+       * The polygons to render are restored by the geometry engine, which passes them back to the renderer for a pending frame.
+       */
+      virtual void SaveState(StateWriter& state) const = 0;
+      virtual void LoadState(StateReader& state, std::span<const Polygon* const> polygons) = 0;
+
+      // Returns the size of the buffers which the renderer allocated on demand.
+      [[nodiscard]] virtual size_t GetLazyMemoryUsage() const = 0;
   };
 
 } // namespace dual::nds::gpu
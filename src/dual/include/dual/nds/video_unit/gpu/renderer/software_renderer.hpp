@@ -3,10 +3,12 @@
 
 #include <array>
 #include <atom/punning.hpp>
+#include <dual/common/profiler.hpp>
 #include <dual/nds/video_unit/gpu/renderer/renderer_base.hpp>
 #include <dual/nds/video_unit/gpu/math.hpp>
 #include <dual/nds/video_unit/gpu/registers.hpp>
 #include <dual/nds/vram/region.hpp>
+#include <memory>
 
 namespace dual::nds::gpu {
 
@@ -15,7 +17,8 @@ namespace dual::nds::gpu {
       SoftwareRenderer(
         IO& io,
         const Region<4, 131072>& vram_texture,
-        const Region<8>& vram_palette
+        const Region<8>& vram_palette,
+        Profiler& profiler
       );
 
       void SetWBufferEnable(bool enable_w_buffer) override {
@@ -26,8 +29,8 @@ namespace dual::nds::gpu {
         size_t i = table_offset * 2u;
 
         for(u32 pair : table_data) {
-          m_edge_color[i++] = Color4::FromRGB555((u16)(pair >>  0));
-          m_edge_color[i++] = Color4::FromRGB555((u16)(pair >> 16));
+          m_gpu_edge_color[i++] = Color4::FromRGB555((u16)(pair >>  0));
+          m_gpu_edge_color[i++] = Color4::FromRGB555((u16)(pair >> 16));
         }
       }
 
@@ -35,16 +38,28 @@ namespace dual::nds::gpu {
         size_t i = table_offset * 2u;
 
         for(u32 pair : table_data) {
-          m_toon_table[i++] = Color4::FromRGB555((u16)(pair >>  0));
-          m_toon_table[i++] = Color4::FromRGB555((u16)(pair >> 16));
+          m_gpu_toon_table[i++] = Color4::FromRGB555((u16)(pair >>  0));
+          m_gpu_toon_table[i++] = Color4::FromRGB555((u16)(pair >> 16));
         }
       }
 
       void Render(const Viewport& viewport, std::span<const Polygon* const> polygons) override;
+      void RenderPendingFrame() override;
+
+      void DiscardPendingFrame() override {
+        m_frame_pending = false;
+      }
 
       void CaptureColor(int scanline, std::span<u16, 256> dst_buffer, int dst_width, bool display_capture) override;
       void CaptureAlpha(int scanline, std::span<int, 256> dst_buffer) override;
 
+      void SaveState(StateWriter& state) const override;
+      void LoadState(StateReader& state, std::span<const Polygon* const> polygons) override;
+
+      [[nodiscard]] size_t GetLazyMemoryUsage() const override {
+        return m_buffers ? sizeof(Buffers) : 0u;
+      }
+
     private:
       struct Line {
         int x[2];
@@ -66,6 +81,7 @@ namespace dual::nds::gpu {
         u16 flags;
       };
 
+      void AllocateBuffers();
       void CopyVRAM();
       void ClearColorBuffer();
       void ClearDepthBuffer();
@@ -92,19 +108,44 @@ namespace dual::nds::gpu {
         return atom::read<T>(m_vram_palette_copy, address & 0x1FFFF & ~(sizeof(T) - 1));
       }
 
-      IO& m_io;
+      const IO& m_gpu_io;
       const Region<4, 131072>& m_vram_texture;
       const Region<8>& m_vram_palette;
+      Profiler& m_profiler;
       bool m_enable_w_buffer{};
-      u8 m_vram_texture_copy[524288]{};
-      u8 m_vram_palette_copy[131072]{};
       u32 m_clear_depth{};
-      Color4 m_frame_buffer[2][192][256];
-      u32 m_depth_buffer[2][192][256];
-      PixelAttributes m_attribute_buffer[192][256];
-      u8 m_coverage_buffer[192][256];
+
+      // Snapshot of the registers and tables which Render() takes and the pending frame is rasterized with.
+      IO m_io{};
       std::array<Color4,  8> m_edge_color{};
       std::array<Color4, 32> m_toon_table{};
+      Viewport m_viewport{};
+      std::span<const Polygon* const> m_polygons{};
+      bool m_frame_pending{};
+
+      /**
+       * The VRAM copies and the render buffers take up about 3 MiB, which is only allocated once the first frame with polygons is started
+       * or the first frame is rasterized. Titles (and instances) which never use the 3D engine do not pay for it.
+       */
+      struct Buffers {
+        u8 vram_texture_copy[524288];
+        u8 vram_palette_copy[131072];
+        Color4 frame_buffer[2][192][256];
+        u32 depth_buffer[2][192][256];
+        PixelAttributes attribute_buffer[192][256];
+        u8 coverage_buffer[192][256];
+      };
+
+      std::unique_ptr<Buffers> m_buffers{};
+      u8* m_vram_texture_copy{};
+      u8* m_vram_palette_copy{};
+      Color4 (*m_frame_buffer)[192][256]{};
+      u32 (*m_depth_buffer)[192][256]{};
+      PixelAttributes (*m_attribute_buffer)[256]{};
+      u8 (*m_coverage_buffer)[256]{};
+
+      std::array<Color4,  8> m_gpu_edge_color{};
+      std::array<Color4, 32> m_gpu_toon_table{};
   };
 
 } // namespace dual::nds::gpu
@@ -5,11 +5,17 @@
 #include <atom/punning.hpp>
 #include <atomic>
 #include <condition_variable>
+#include <cstring>
+#include <dual/common/profiler.hpp>
+#include <dual/common/save_state.hpp>
+#include <dual/common/thread_pool.hpp>
+#include <dual/common/tracer.hpp>
 #include <dual/nds/video_unit/gpu/gpu.hpp>
 #include <dual/nds/video_unit/ppu/registers.hpp>
 #include <dual/nds/vram/vram.hpp>
 #include <dual/nds/system_memory.hpp>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <thread>
 
@@ -23,6 +29,7 @@ namespace dual::nds {
       PPU(
         int id,
         SystemMemory& memory,
+        Profiler& profiler,
         GPU* gpu = nullptr
       );
 
@@ -58,6 +65,8 @@ namespace dual::nds {
       } m_mmio;
 
       void Reset();
+      void SaveState(StateWriter& state);
+      void LoadState(StateReader& state);
 
       [[nodiscard]] const u32* GetFrameBuffer() const {
         return &m_frame_buffer[m_frame][0];
@@ -72,7 +81,16 @@ namespace dual::nds {
       }
 
       void WaitForRenderWorker() {
-        while(m_render_worker.vcount <= m_render_worker.vcount_max) {}
+        if(m_render_worker.vcount <= m_render_worker.vcount_max) {
+          DUAL_TRACE_SCOPE("PPU::WaitForRenderWorker");
+
+          // The pool may be busy with other work, so rather than waiting for it, render the scanlines on this thread.
+          if(m_thread_pool) {
+            TryRenderSubmittedScanlines();
+          }
+
+          while(m_render_worker.vcount <= m_render_worker.vcount_max) {}
+        }
       }
 
       void OnWriteVRAM_BG(size_t address_lo, size_t address_hi) {
@@ -92,7 +110,10 @@ namespace dual::nds {
       }
 
       void OnWriteVRAM_LCDC(size_t address_lo, size_t address_hi) {
-        OnRegionWrite(m_vram_lcdc, m_render_vram_lcdc, m_vram_lcdc_dirty, {address_lo, address_hi});
+        // Until the first scanline is displayed from VRAM, there is no copy to keep up-to-date.
+        if(m_render_vram_lcdc) {
+          OnRegionWrite(m_vram_lcdc, m_render_vram_lcdc.get(), m_vram_lcdc_dirty, {address_lo, address_hi});
+        }
       }
 
       void OnWritePRAM(size_t address_lo, size_t address_hi) {
@@ -115,6 +136,31 @@ namespace dual::nds {
         m_power_on = power_on;
       }
 
+      /**
+       * Skip rendering the scanlines which are neither shown nor read by display capture.
+       * Enabling the output again renders the last submitted scanline, which the render worker has skipped.
+       */
+      void SetEnableOutput(bool enable);
+
+      // Whether the scanline which is submitted next shows the 3D layer, that is whether it reads the output of the GPU.
+      [[nodiscard]] bool GetUses3DLayer() {
+        auto& dispcnt = m_mmio.dispcnt;
+
+        // @todo: what does HW do if "enable BG0 3D" is disabled in mode 6.
+        return dispcnt.enable[ENABLE_BG0] && (dispcnt.enable_bg0_3d || dispcnt.bg_mode == 6);
+      }
+
+      /**
+       * Render the scanlines on the worker threads of a pool instead of a render thread of its own.
+       * Null switches back to a render thread of its own. The pool must outlive the PPU or be detached first.
+       */
+      void SetThreadPool(ThreadPool* thread_pool);
+
+      // Bytes allocated on demand, i.e. the copy of the LCDC VRAM which is only needed to display a scanline from VRAM.
+      [[nodiscard]] size_t GetLazyMemoryUsage() const {
+        return m_render_vram_lcdc ? k_render_vram_lcdc_size : 0u;
+      }
+
     private:
       enum ObjectMode {
         OBJ_NORMAL = 0,
@@ -184,8 +230,11 @@ namespace dual::nds {
       u16  Brighten(u16 color, int evy);
       u16  Darken(u16 color, int evy);
 
+      void AllocateVRAMDisplayCopy();
       void SetupRenderWorker();
       void StopRenderWorker();
+      void RenderSubmittedScanlines();
+      void TryRenderSubmittedScanlines();
       void SubmitScanline(u16 vcount, bool capture_bg_and_3d);
       void RegisterMapUnmapCallbacks();
 
@@ -269,10 +318,34 @@ namespace dual::nds {
         return r << 19 | g << 11 | b << 3 | 0xFF000000;
       }
 
-      template<typename T>
-      static void CopyVRAM(const T& src, u8* dst, const AddressRange& range) {
-        for(size_t address = range.lo; address < range.hi; address++) {
-          dst[address] = src.template Read<u8>(address);
+      template<size_t page_count, u32 page_size>
+      static void CopyVRAM(const Region<page_count, page_size>& src, u8* dst, const AddressRange& range) {
+        size_t address = range.lo;
+
+        // Copy whole pages at once, unless they are unmapped or multiple banks are mapped to them.
+        while(address < range.hi) {
+          const size_t chunk_end = std::min((address | (page_size - 1u)) + 1u, range.hi);
+          const u8* page = src.template GetUnsafePointer<u8>((u32)address);
+
+          if(page != nullptr) {
+            std::memcpy(&dst[address], page, chunk_end - address);
+          } else {
+            size_t i = address;
+
+            for(; i < chunk_end && (i & 7u) != 0u; i++) {
+              dst[i] = src.template Read<u8>((u32)i);
+            }
+
+            for(; i + 8u <= chunk_end; i += 8u) {
+              atom::write<u64>(dst, i, src.template Read<u64>((u32)i));
+            }
+
+            for(; i < chunk_end; i++) {
+              dst[i] = src.template Read<u8>((u32)i);
+            }
+          }
+
+          address = chunk_end;
         }
       }
 
@@ -285,6 +358,8 @@ namespace dual::nds {
       template<typename T>
       void OnRegionWrite(const T& region, u8* copy_dst, AddressRange& dirty_range, const AddressRange& write_range) {
         if(m_vcount < 192) {
+          DUAL_TRACE_SCOPE("PPU::OnRegionWrite");
+
           WaitForRenderWorker();
           CopyVRAM(region, copy_dst, write_range);
         } else {
@@ -316,8 +391,13 @@ namespace dual::nds {
         std::mutex mutex;
         bool ready;
         std::thread thread;
+        std::atomic_bool task_queued = false; //< Thread pool only
+        std::atomic_int  task_count = 0;      //< Thread pool only
+        std::atomic_bool busy = false;        //< Thread pool only
       } m_render_worker;
 
+      ThreadPool* m_thread_pool{};
+
       MMIO m_mmio_copy[263];
 
       const Region<32>& m_vram_bg;  //< Background tile, map and bitmap data
@@ -333,7 +413,7 @@ namespace dual::nds {
       u8 m_render_vram_obj[262144];
       u8 m_render_extpal_bg[32768];
       u8 m_render_extpal_obj[8192];
-      u8 m_render_vram_lcdc[1048576];
+      std::unique_ptr<u8[]> m_render_vram_lcdc{};
       u8 m_render_pram[0x400];
       u8 m_render_oam[0x400];
 
@@ -350,10 +430,14 @@ namespace dual::nds {
       int m_frame = 0;
 
       bool m_power_on{};
+      std::atomic_bool m_enable_output{true};
 
+      int m_id;
+      Profiler& m_profiler;
       GPU* m_gpu{};
 
       static constexpr u16 k_color_transparent = 0x8000u;
+      static constexpr size_t k_render_vram_lcdc_size = 1048576;
   };
 
 } // namespace dual::nds
@@ -17,22 +17,52 @@ namespace dual::nds {
 
   class VideoUnit {
     public:
+      static constexpr int k_drawing_lines = 192;
+      static constexpr int k_blanking_lines = 71;
+      static constexpr int k_total_lines = k_drawing_lines + k_blanking_lines;
+
       VideoUnit(
         Scheduler& scheduler,
         SystemMemory& memory,
         IRQ& irq9,
         IRQ& irq7,
         arm9::DMA& dma9,
-        arm7::DMA& dma7
+        arm7::DMA& dma7,
+        Profiler& profiler
       );
 
       void Reset();
+      void SaveState(StateWriter& state);
+      void LoadState(StateReader& state);
       void DirectBoot();
 
       void SetPresentationCallback(std::function<void(const u32*, const u32*)> present_callback) {
         m_present_callback = std::move(present_callback);
       }
 
+      /**
+       * Frames which are emulated while the output is disabled are neither rendered nor presented, e.g. when running ahead.
+       * Display capture still works, so that this does not affect emulation.
+       */
+      [[nodiscard]] bool GetEnableOutput() const {
+        return m_enable_output;
+      }
+
+      void SetEnableOutput(bool enable);
+
+      [[nodiscard]] int GetFrameSkip() const {
+        return m_frame_skip;
+      }
+
+      /**
+       * Present only one in every (frames + 1) frames. The frames in between are emulated with the output disabled,
+       * so neither the 2D layers nor the 3D scene is rendered, unless display capture reads them.
+       */
+      void SetFrameSkip(int frames);
+
+      // Render the 2D layers on the worker threads of a shared pool (see PPU::SetThreadPool()).
+      void SetThreadPool(ThreadPool* thread_pool);
+
       GPU& GetGPU() {
         return m_gpu;
       }
@@ -41,9 +71,27 @@ namespace dual::nds {
         return m_ppu[id];
       }
 
+      // Returns the size of the render buffers which the GPU and PPUs allocated on demand.
+      [[nodiscard]] size_t GetLazyMemoryUsage() const {
+        return m_gpu.GetLazyMemoryUsage() + m_ppu[0].GetLazyMemoryUsage() + m_ppu[1].GetLazyMemoryUsage();
+      }
+
       u16   Read_DISPSTAT(CPU cpu);
       void Write_DISPSTAT(CPU cpu, u16 value, u16 mask);
 
+      void SetBreakLine(int line) {
+        m_break_line = line;
+        m_break_line_reached = false;
+      }
+
+      void ClearBreakLine() {
+        SetBreakLine(-1);
+      }
+
+      bool GetBreakLineReached() const {
+        return m_break_line_reached;
+      }
+
       u16 Read_VCOUNT();
 
       u16   Read_POWCNT1();
@@ -53,16 +101,20 @@ namespace dual::nds {
       void Write_DISPCAPCNT(u32 value, u32 mask);
 
     private:
-      static constexpr int k_drawing_lines = 192;
-      static constexpr int k_blanking_lines = 71;
-      static constexpr int k_total_lines = k_drawing_lines + k_blanking_lines;
-
       void UpdateVerticalCounterMatchFlag(CPU cpu);
       void BeginHDraw(int late);
       void BeginHBlank(int late);
       void RunDisplayCapture();
+      void UpdateFrameSkip();
+      void UpdateEnableOutput();
+
+      [[nodiscard]] bool IsOutputEnabled() const {
+        return m_enable_output && !m_skip_frame;
+      }
 
       Scheduler& m_scheduler;
+      Scheduler::Event m_hdraw_event{};
+      Scheduler::Event m_hblank_event{};
       VRAM& m_vram;
 
       GPU m_gpu;
@@ -83,6 +135,9 @@ namespace dual::nds {
 
       u16 m_vcount{};
 
+      int m_break_line{-1};
+      bool m_break_line_reached{};
+
       union POWCNT1 {
         atom::Bits< 0, 1, u16> enable_lcds;
         atom::Bits< 1, 1, u16> enable_ppu_a;
@@ -128,6 +183,11 @@ namespace dual::nds {
       bool m_display_swap_latch{};
       bool m_display_capture_active{};
 
+      bool m_enable_output{true};
+      int m_frame_skip{};
+      int m_frame_skip_counter{};
+      bool m_skip_frame{};
+
       IRQ* m_irq[2]{};
       arm9::DMA& m_dma9;
       arm7::DMA& m_dma7;
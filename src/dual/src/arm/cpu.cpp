@@ -0,0 +1,68 @@
+#include <dual/arm/cpu.hpp>
+
+namespace dual::arm {
+
+  static constexpr CPU::Mode k_banked_modes[] {
+    CPU::Mode::User, CPU::Mode::FIQ, CPU::Mode::IRQ, CPU::Mode::Supervisor, CPU::Mode::Abort, CPU::Mode::Undefined
+  };
+
+  void CPU::SaveState(StateWriter& state) const {
+    const PSR cpsr = GetCPSR();
+
+    state.Write(cpsr.word);
+
+    for(int i = 0; i < 15; i++) {
+      state.Write(GetGPR((GPR)i));
+    }
+
+    // r15 is ahead of the current instruction by the length of the pipeline.
+    state.Write(GetGPR(GPR::PC) - (cpsr.thumb ? 4u : 8u));
+
+    for(Mode mode : k_banked_modes) {
+      for(int i = 8; i < 15; i++) {
+        state.Write(GetGPR((GPR)i, mode));
+      }
+
+      if(mode != Mode::User) {
+        state.Write(GetSPSR(mode).word);
+      }
+    }
+
+    state.Write(GetIRQFlag());
+    state.Write(GetWaitingForIRQ());
+    state.Write(GetExceptionBase());
+  }
+
+  void CPU::LoadState(StateReader& state) {
+    u32 gpr[16];
+
+    SetCPSR(state.Read<u32>());
+    state.Read(gpr);
+
+    for(Mode mode : k_banked_modes) {
+      for(int i = 8; i < 15; i++) {
+        SetGPR((GPR)i, mode, state.Read<u32>());
+      }
+
+      if(mode != Mode::User) {
+        SetSPSR(mode, state.Read<u32>());
+      }
+    }
+
+    // @note: the banked registers of the current mode may have been read from a stale bank, so the current registers are written last.
+    for(int i = 0; i < 15; i++) {
+      SetGPR((GPR)i, gpr[i]);
+    }
+
+    SetIRQFlag(state.Read<bool>());
+    SetWaitingForIRQ(state.Read<bool>());
+    SetExceptionBase(state.Read<u32>());
+
+    // Writing r15 refills the pipeline, so the exception base and the memory must already be in place.
+    SetGPR(GPR::PC, gpr[15]);
+
+    GetIdleLoopDetector().Reset();
+    InvalidateICache();
+  }
+
+} // namespace dual::arm
@@ -480,6 +480,7 @@ void Thumb_ConditionalBranch(u16 instruction) {
 
     m_state.r15 += imm * 2;
     ReloadPipeline16();
+    CheckIdleLoop((s32)imm * 2, 4);
   } else {
     m_state.r15 += 2;
   }
@@ -510,6 +511,7 @@ void Thumb_UnconditionalBranch(u16 instruction) {
 
   m_state.r15 += imm;
   ReloadPipeline16();
+  CheckIdleLoop((s32)imm, 4);
 }
 
 void Thumb_LongBranchLinkPrefix(u16 instruction) {
@@ -543,6 +543,10 @@ void ARM_BranchAndLink(u32 instruction) {
 
   m_state.r15 += offset * 4;
   ReloadPipeline32();
+
+  if constexpr(!link) {
+    CheckIdleLoop((s32)offset * 4, 8);
+  }
 }
 
 void ARM_BranchLinkExchangeImm(u32 instruction) {
@@ -903,6 +907,7 @@ void ARM_CoprocessorRegisterTransfer(u32 instruction) {
   if(instruction & (1 << 20)) {
     m_state.reg[dst] = coprocessor->MRC(opcode1, cp_rn, cp_rm, opcode2);
   } else {
+    m_idle_loop_detector.OnWrite();
     coprocessor->MCR(opcode1, cp_rn, cp_rm, opcode2, m_state.reg[dst]);
   }
 
@@ -65,13 +65,16 @@ auto ReadWordRotate(u32 address) -> u32 {
 }
 
 void WriteByte(u32 address, u8  value) {
+  m_idle_loop_detector.OnWrite();
   m_memory.WriteByte(address, value, Bus::Data);
 }
 
 void WriteHalf(u32 address, u16 value) {
+  m_idle_loop_detector.OnWrite();
   m_memory.WriteHalf(address, value, Bus::Data);
 }
 
 void WriteWord(u32 address, u32 value) {
+  m_idle_loop_detector.OnWrite();
   m_memory.WriteWord(address, value, Bus::Data);
 }
@@ -9,13 +9,42 @@
 #include <dual/common/cycle_counter.hpp>
 #include <dual/common/scheduler.hpp>
 #include <span>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__has_cpp_attribute)
+  #if __has_cpp_attribute(clang::musttail)
+    #define DUAL_MUSTTAIL [[clang::musttail]]
+  #endif
+#endif
+
+#ifndef DUAL_MUSTTAIL
+  // @note: GCC turns the calls into jumps as a regular sibling call optimization, but does not guarantee it.
+  #define DUAL_MUSTTAIL
+#endif
+
+#if defined(_MSC_VER)
+  #define DUAL_FORCE_INLINE __forceinline
+#else
+  #define DUAL_FORCE_INLINE inline __attribute__((always_inline))
+#endif
 
 namespace dual::arm {
 
+  /**
+   * The interpreter is instantiated for the concrete memory bus type of each CPU,
+   * so that loads, stores and fetches call the bus directly and can be inlined.
+   * InterpreterCPU<Memory> works with any memory implementation through virtual calls.
+   * @note: the member functions are defined in interpreter_cpu.inl and each specialization is explicitly instantiated in one translation unit.
+   */
+  template<typename MemoryImpl = Memory>
   class InterpreterCPU final : public CPU {
     public:
+      static_assert(std::is_base_of_v<Memory, MemoryImpl>);
+
       InterpreterCPU(
-        Memory& memory,
+        MemoryImpl& memory,
         Scheduler& scheduler,
         CycleCounter& cycle_counter,
         Model model,
@@ -32,6 +61,10 @@ namespace dual::arm {
         m_exception_base = address;
       }
 
+      void InvalidateICache() override {
+        ClearCodeBlocks();
+      }
+
       void SetUnalignedDataAccessEnable(bool enable) override {
         m_unaligned_data_access_enable = enable;
       }
@@ -100,6 +133,7 @@ namespace dual::arm {
       }
 
       void SetCPSR(PSR value) override {
+        SwitchMode((Mode)value.mode);
         m_state.cpsr = value;
       }
 
@@ -109,6 +143,14 @@ namespace dual::arm {
 
       void Run(int cycles) override;
 
+      IdleLoopDetector& GetIdleLoopDetector() override {
+        return m_idle_loop_detector;
+      }
+
+      u64 GetRetiredInstructions() const override {
+        return m_retired_instructions;
+      }
+
       typedef void (InterpreterCPU::*Handler16)(u16);
       typedef void (InterpreterCPU::*Handler32)(u32);
 
@@ -141,16 +183,164 @@ namespace dual::arm {
         Undefined  = 5
       };
 
-      friend struct TableGen;
+      /**
+       * An instruction with its handler already looked up. Fetches produce these instead of plain opcodes,
+       * so that instructions which are fetched from a code block do not need to be decoded again.
+       * @note: this is kept at eight bytes (handler index instead of member function pointer), because it is copied through the pipeline for every instruction.
+       */
+      struct DecodedInstruction {
+        u32 opcode{};
+        u16 handler{}; //< index into k_opcode_lut_16 or k_opcode_lut_32
+        Condition condition : 8 {Condition::AL};
+        bool thumb{};
+      };
+
+      static_assert(sizeof(DecodedInstruction) == 8);
+
+      /**
+       * Instructions decoded from consecutive addresses within a code page, starting at a branch target.
+       * A block is extended whenever execution runs past its end and it is decoded anew once the page version changes.
+       */
+      struct CodeBlock {
+        u32 key; //< address of the first instruction, bit 0 is set for Thumb
+        const u64* page_version;
+        u64 version;
+        std::vector<DecodedInstruction> code;
+      };
+
+      template<typename> friend struct TableGen;
+
+#ifdef DUAL_INTERPRETER_THREADED_DISPATCH
+      /**
+       * Threaded dispatch (DUAL_INTERPRETER_THREADED_DISPATCH): each handler has a thunk that executes the instruction,
+       * fetches the next instruction and tail-calls its thunk. This gives every handler its own indirect branch to the next handler,
+       * instead of all instructions sharing the one in Run(). A chain runs for at most the given number of cycles
+       * and ends early whenever Run() has to act (waiting for IRQ, idle loop skip, scheduler target reached).
+       * It returns the number of cycles that were left.
+       */
+      using ThreadedHandler = int (*)(InterpreterCPU& cpu, u32 opcode, int cycles);
+
+      struct ThreadedInstruction {
+        ThreadedHandler handler;
+        u32 opcode;
+      };
+
+      // Bounds the native stack depth of a chain in case the compiler did not turn the tail calls into jumps.
+      static constexpr int k_max_threaded_chain = 256;
+
+      template<Handler16 handler>
+      static int ThreadedThumb(InterpreterCPU& cpu, u32 opcode, int cycles) {
+        (cpu.*handler)((u16)opcode);
+
+        if(!cpu.RetireThreaded(--cycles)) {
+          return cycles;
+        }
+
+        const ThreadedInstruction next = cpu.FetchThreaded();
+        DUAL_MUSTTAIL return next.handler(cpu, next.opcode, cycles);
+      }
+
+      template<Handler32 handler>
+      static int ThreadedARM(InterpreterCPU& cpu, u32 opcode, int cycles) {
+        if(cpu.EvaluateCondition((Condition)(opcode >> 28))) {
+          (cpu.*handler)(opcode);
+        } else {
+          cpu.m_state.r15 += 4;
+        }
+
+        if(!cpu.RetireThreaded(--cycles)) {
+          return cycles;
+        }
+
+        const ThreadedInstruction next = cpu.FetchThreaded();
+        DUAL_MUSTTAIL return next.handler(cpu, next.opcode, cycles);
+      }
+
+      // @note: both are force-inlined, because the thunks only get their own indirect branch if the next instruction is fetched in place.
+      DUAL_FORCE_INLINE bool RetireThreaded(int cycles_left) {
+        m_cycle_counter.AddDeviceCycles(1u);
+        m_retired_instructions++;
+
+        return cycles_left > 0 && !GetWaitingForIRQ() && !m_idle_loop_skip && m_cycle_counter.GetTimestampNow() < m_scheduler.GetTimestampTarget();
+      }
+
+      DUAL_FORCE_INLINE ThreadedInstruction FetchThreaded() {
+        if(GetIRQFlag()) {
+          SignalIRQ();
+        }
+
+        DecodedInstruction instruction = m_pipeline[0];
+
+        if(m_state.cpsr.thumb) {
+          m_state.r15 &= ~1;
+
+          m_pipeline[0] = m_pipeline[1];
+          Fetch16(m_pipeline[1], m_state.r15);
+
+          if(!instruction.thumb) [[unlikely]] {
+            instruction = DecodeThumb((u16)instruction.opcode);
+          }
+          return {k_threaded_lut_16[instruction.handler], instruction.opcode};
+        }
+
+        m_state.r15 &= ~3;
+
+        m_pipeline[0] = m_pipeline[1];
+        Fetch32(m_pipeline[1], m_state.r15);
+
+        if(instruction.thumb) [[unlikely]] {
+          instruction = DecodeARM(instruction.opcode);
+        }
+        return {k_threaded_lut_32[instruction.handler], instruction.opcode};
+      }
+#endif
 
       static auto GetRegisterBankByMode(Mode mode) -> Bank;
 
       void SignalIRQ();
       void ReloadPipeline16();
       void ReloadPipeline32();
+
+      static auto DecodeARM(u32 opcode) -> DecodedInstruction;
+      static auto DecodeThumb(u16 opcode) -> DecodedInstruction;
+
+      void Fetch16(DecodedInstruction& slot, u32 address) {
+        Fetch(slot, (address & ~1u) | 1u);
+      }
+
+      void Fetch32(DecodedInstruction& slot, u32 address) {
+        Fetch(slot, address & ~3u);
+      }
+
+      void Fetch(DecodedInstruction& slot, u32 key) {
+        if(key == m_fetch_key && m_fetch_cursor != m_fetch_end && *m_fetch_page_version == m_fetch_version) [[likely]] {
+          slot = *m_fetch_cursor++;
+          m_fetch_key += (key & 1u) ? 2u : 4u;
+          return;
+        }
+
+        FetchSlow(slot, key);
+      }
+
+      void FetchSlow(DecodedInstruction& slot, u32 key);
+      auto GetCodeBlock(u32 key) -> CodeBlock*;
+      void SetFetchCursor(CodeBlock* block, size_t index, u32 key);
+      void ClearCodeBlocks();
       void BuildConditionTable();
       void SwitchMode(Mode new_mode);
 
+      void CheckIdleLoop(s32 branch_offset, s32 pipeline_offset) {
+        // Only short branches back to the branch itself or to an earlier instruction can close an idle loop.
+        if(branch_offset > -pipeline_offset || branch_offset < -(k_max_idle_loop_size + pipeline_offset)) {
+          return;
+        }
+
+        // @note: this is called after the pipeline reload, which advanced r15 by two instructions past the loop address.
+        if(m_idle_loop_detector.Check(m_state.r15 - pipeline_offset, m_state.reg, m_state.cpsr.word)) {
+          m_idle_loop_skip = true;
+        }
+      }
+
       inline bool EvaluateCondition(Condition condition) {
         if(condition == Condition::AL) [[likely]] {
           return true;
@@ -163,7 +353,7 @@ namespace dual::arm {
       #include "handlers/handler32.inl"
       #include "handlers/memory.inl"
 
-      Memory& m_memory;
+      MemoryImpl& m_memory;
       Scheduler& m_scheduler;
       CycleCounter& m_cycle_counter;
       Model m_model;
@@ -226,14 +416,43 @@ namespace dual::arm {
 
       PSR* m_spsr;
 
-      u32 m_opcode[2];
+      DecodedInstruction m_pipeline[2];
 
       bool m_condition_table[16][16];
 
       static std::array<Handler16, 2048> k_opcode_lut_16;
       static std::array<Handler32, 8192> k_opcode_lut_32;
 
+#ifdef DUAL_INTERPRETER_THREADED_DISPATCH
+      static std::array<ThreadedHandler, 2048> k_threaded_lut_16;
+      static std::array<ThreadedHandler, 8192> k_threaded_lut_32;
+#endif
+
       bool m_unaligned_data_access_enable;
+
+      static constexpr s32 k_max_idle_loop_size = 64;
+
+      IdleLoopDetector m_idle_loop_detector{};
+      bool m_idle_loop_skip = false;
+
+      u64 m_retired_instructions = 0u;
+
+      static constexpr size_t k_code_block_lookup_size = 4096u;
+      static constexpr size_t k_max_code_block_instructions = 1u << 17;
+
+      std::unordered_map<u32, CodeBlock> m_code_blocks{};
+      std::array<CodeBlock*, k_code_block_lookup_size> m_code_block_lookup{};
+      size_t m_code_block_instructions = 0u;
+
+      // The block which the next sequential fetch continues in.
+      CodeBlock* m_fetch_block = nullptr;
+      const DecodedInstruction* m_fetch_cursor = nullptr;
+      const DecodedInstruction* m_fetch_end = nullptr;
+      const u64* m_fetch_page_version = nullptr;
+      u64 m_fetch_version = 0u;
+      u32 m_fetch_key = 0u;
   };
 
+  extern template class InterpreterCPU<Memory>;
+
 } // namespace dual::arm
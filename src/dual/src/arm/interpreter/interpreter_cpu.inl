@@ -0,0 +1,394 @@
+#pragma once
+
+#include <algorithm>
+
+#include "interpreter_cpu.hpp"
+#include "tablegen/tablegen.hpp"
+
+namespace dual::arm {
+
+  template<typename MemoryImpl>
+  InterpreterCPU<MemoryImpl>::InterpreterCPU(
+    MemoryImpl& memory,
+    Scheduler& scheduler,
+    CycleCounter& cycle_counter,
+    Model model,
+    std::span<const AttachCPn> coprocessor_table
+  )   : m_memory{memory}
+      , m_scheduler{scheduler}
+      , m_cycle_counter{cycle_counter}
+      , m_model{model} {
+    m_unaligned_data_access_enable = false;
+
+    BuildConditionTable();
+    Reset();
+
+    for(auto& attach_cp_n : coprocessor_table) {
+      m_coprocessors.at(attach_cp_n.id) = attach_cp_n.coprocessor;
+      attach_cp_n.coprocessor->SetCPU(this);
+    }
+  }
+
+  template<typename MemoryImpl>
+  void InterpreterCPU<MemoryImpl>::Reset() {
+    constexpr u32 nop = 0xE320F000;
+
+    m_state = {};
+    SwitchMode((Mode)m_state.cpsr.mode);
+    ClearCodeBlocks();
+    m_pipeline[0] = DecodeARM(nop);
+    m_pipeline[1] = DecodeARM(nop);
+    m_state.r15 = m_exception_base;
+    m_wait_for_irq = false;
+    m_idle_loop_detector.Reset();
+    m_idle_loop_skip = false;
+    SetIRQFlag(false);
+  }
+
+  template<typename MemoryImpl>
+  void InterpreterCPU<MemoryImpl>::Run(int cycles) {
+    if(GetWaitingForIRQ()) {
+      m_cycle_counter.AddDeviceCycles((uint)cycles);
+      return;
+    }
+
+#ifdef DUAL_INTERPRETER_THREADED_DISPATCH
+    while(cycles > 0 && m_cycle_counter.GetTimestampNow() < m_scheduler.GetTimestampTarget()) {
+      const int chain = std::min(cycles, k_max_threaded_chain);
+      const ThreadedInstruction first = FetchThreaded();
+
+      cycles -= chain - first.handler(*this, first.opcode, chain);
+
+      if(GetWaitingForIRQ()) {
+        m_cycle_counter.AddDeviceCycles(cycles);
+        return;
+      }
+
+      if(m_idle_loop_skip) [[unlikely]] {
+        m_idle_loop_skip = false;
+        m_idle_loop_detector.AddSkippedCycles(cycles);
+        m_cycle_counter.AddDeviceCycles(cycles);
+        return;
+      }
+    }
+#else
+    while(cycles-- > 0 && m_cycle_counter.GetTimestampNow() < m_scheduler.GetTimestampTarget()) {
+      if(GetIRQFlag()) {
+        SignalIRQ();
+      }
+
+      DecodedInstruction instruction = m_pipeline[0];
+
+      if(m_state.cpsr.thumb) {
+        m_state.r15 &= ~1;
+
+        m_pipeline[0] = m_pipeline[1];
+        Fetch16(m_pipeline[1], m_state.r15);
+
+        // The instruction was fetched in ARM mode if the CPSR was written without reloading the pipeline.
+        if(!instruction.thumb) [[unlikely]] {
+          instruction = DecodeThumb((u16)instruction.opcode);
+        }
+
+        (this->*k_opcode_lut_16[instruction.handler])((u16)instruction.opcode);
+      } else {
+        m_state.r15 &= ~3;
+
+        m_pipeline[0] = m_pipeline[1];
+        Fetch32(m_pipeline[1], m_state.r15);
+
+        if(instruction.thumb) [[unlikely]] {
+          instruction = DecodeARM(instruction.opcode);
+        }
+
+        if(EvaluateCondition(instruction.condition)) {
+          (this->*k_opcode_lut_32[instruction.handler])(instruction.opcode);
+        } else {
+          m_state.r15 += 4;
+        }
+      }
+
+      m_cycle_counter.AddDeviceCycles(1u);
+      m_retired_instructions++;
+
+      if(GetWaitingForIRQ()) {
+        m_cycle_counter.AddDeviceCycles(cycles);
+        return;
+      }
+
+      // The CPU spins in a loop that can only be left once an event or the other CPU changes something, so skip to the end of the slice.
+      if(m_idle_loop_skip) [[unlikely]] {
+        m_idle_loop_skip = false;
+        m_idle_loop_detector.AddSkippedCycles(cycles);
+        m_cycle_counter.AddDeviceCycles(cycles);
+        return;
+      }
+    }
+#endif
+  }
+
+  template<typename MemoryImpl>
+  void InterpreterCPU<MemoryImpl>::SignalIRQ() {
+    if(m_state.cpsr.mask_irq) {
+      return;
+    }
+
+    // Save current program status register.
+    m_state.spsr[(int)Bank::IRQ] = m_state.cpsr;
+
+    // Enter IRQ mode and disable IRQs.
+    SwitchMode(Mode::IRQ);
+    m_state.cpsr.mask_irq = 1;
+
+    // Save current program counter and disable Thumb.
+    if(m_state.cpsr.thumb) {
+      m_state.cpsr.thumb = 0;
+      m_state.r14 = m_state.r15;
+    } else {
+      m_state.r14 = m_state.r15 - 4;
+    }
+
+    // Jump to IRQ exception vector.
+    m_state.r15 = m_exception_base + 0x18;
+    ReloadPipeline32();
+  }
+
+  template<typename MemoryImpl>
+  void InterpreterCPU<MemoryImpl>::ReloadPipeline32() {
+    Fetch32(m_pipeline[0], m_state.r15);
+    Fetch32(m_pipeline[1], m_state.r15 + 4);
+    m_state.r15 += 8;
+  }
+
+  template<typename MemoryImpl>
+  void InterpreterCPU<MemoryImpl>::ReloadPipeline16() {
+    Fetch16(m_pipeline[0], m_state.r15);
+    Fetch16(m_pipeline[1], m_state.r15 + 2);
+    m_state.r15 += 4;
+  }
+
+  template<typename MemoryImpl>
+  auto InterpreterCPU<MemoryImpl>::DecodeARM(u32 opcode) -> DecodedInstruction {
+    const auto condition = static_cast<Condition>(opcode >> 28);
+
+    int hash = static_cast<int>(((opcode >> 16) & 0xFF0) | ((opcode >> 4) & 0x00F));
+
+    if(condition == Condition::NV) {
+      hash |= 4096;
+    }
+
+    DecodedInstruction decoded{};
+    decoded.handler = (u16)hash;
+    decoded.opcode = opcode;
+    decoded.condition = condition;
+    decoded.thumb = false;
+    return decoded;
+  }
+
+  template<typename MemoryImpl>
+  auto InterpreterCPU<MemoryImpl>::DecodeThumb(u16 opcode) -> DecodedInstruction {
+    DecodedInstruction decoded{};
+    decoded.handler = (u16)(opcode >> 5);
+    decoded.opcode = opcode;
+    decoded.condition = Condition::AL;
+    decoded.thumb = true;
+    return decoded;
+  }
+
+  template<typename MemoryImpl>
+  void InterpreterCPU<MemoryImpl>::FetchSlow(DecodedInstruction& slot, u32 key) {
+    const bool thumb = key & 1u;
+    const u32 address = key & ~1u;
+    const u32 next_key = key + (thumb ? 2u : 4u);
+
+    const auto Decode = [&]() {
+      return thumb ? DecodeThumb((u16)ReadHalfCode(address)) : DecodeARM(ReadWordCode(address));
+    };
+
+    // Execution ran past the end of the current block for the first time, so the block grows (but never into the next page).
+    if(
+      key == m_fetch_key && m_fetch_block != nullptr && m_fetch_cursor == m_fetch_end &&
+      *m_fetch_page_version == m_fetch_version && address % Memory::k_code_page_size != 0u &&
+      m_code_block_instructions < k_max_code_block_instructions
+    ) {
+      CodeBlock* block = m_fetch_block;
+
+      slot = block->code.emplace_back(Decode());
+      m_code_block_instructions++;
+      SetFetchCursor(block, block->code.size(), next_key);
+      return;
+    }
+
+    CodeBlock* block = GetCodeBlock(key);
+
+    if(block == nullptr) {
+      slot = Decode();
+      SetFetchCursor(nullptr, 0u, 0u);
+      return;
+    }
+
+    if(block->code.empty()) {
+      block->code.push_back(Decode());
+      m_code_block_instructions++;
+    }
+
+    slot = block->code[0];
+    SetFetchCursor(block, 1u, next_key);
+  }
+
+  template<typename MemoryImpl>
+  auto InterpreterCPU<MemoryImpl>::GetCodeBlock(u32 key) -> CodeBlock* {
+    CodeBlock*& lookup = m_code_block_lookup[(key >> 1) % k_code_block_lookup_size];
+    CodeBlock* block = lookup;
+
+    if(block == nullptr || block->key != key) {
+      const auto match = m_code_blocks.find(key);
+
+      if(match != m_code_blocks.end()) {
+        block = &match->second;
+      } else {
+        const u64* page_version = m_memory.GetCodePageVersion(key & ~1u);
+
+        if(page_version == nullptr) {
+          return nullptr;
+        }
+
+        if(m_code_block_instructions >= k_max_code_block_instructions) {
+          ClearCodeBlocks();
+        }
+
+        block = &m_code_blocks[key];
+        block->key = key;
+        block->page_version = page_version;
+        block->version = *page_version;
+      }
+
+      lookup = block;
+    }
+
+    // The page was written or the memory map changed since the block has been decoded.
+    if(*block->page_version != block->version) {
+      const u64* page_version = m_memory.GetCodePageVersion(key & ~1u);
+
+      m_code_block_instructions -= block->code.size();
+
+      if(page_version == nullptr) {
+        m_code_blocks.erase(key);
+        lookup = nullptr;
+        return nullptr;
+      }
+
+      block->code.clear();
+      block->page_version = page_version;
+      block->version = *page_version;
+    }
+
+    return block;
+  }
+
+  template<typename MemoryImpl>
+  void InterpreterCPU<MemoryImpl>::SetFetchCursor(CodeBlock* block, size_t index, u32 key) {
+    m_fetch_block = block;
+    m_fetch_key = key;
+
+    if(block == nullptr) {
+      m_fetch_cursor = nullptr;
+      m_fetch_end = nullptr;
+      m_fetch_page_version = nullptr;
+      return;
+    }
+
+    m_fetch_cursor = block->code.data() + index;
+    m_fetch_end = block->code.data() + block->code.size();
+    m_fetch_page_version = block->page_version;
+    m_fetch_version = block->version;
+  }
+
+  template<typename MemoryImpl>
+  void InterpreterCPU<MemoryImpl>::ClearCodeBlocks() {
+    m_code_blocks.clear();
+    m_code_block_lookup.fill(nullptr);
+    m_code_block_instructions = 0u;
+    SetFetchCursor(nullptr, 0u, 0u);
+  }
+
+  template<typename MemoryImpl>
+  void InterpreterCPU<MemoryImpl>::BuildConditionTable() {
+    for(int flags = 0; flags < 16; flags++) {
+      bool n = flags & 8;
+      bool z = flags & 4;
+      bool c = flags & 2;
+      bool v = flags & 1;
+
+      m_condition_table[(int)Condition::EQ][flags] = z;
+      m_condition_table[(int)Condition::NE][flags] = !z;
+      m_condition_table[(int)Condition::CS][flags] =  c;
+      m_condition_table[(int)Condition::CC][flags] = !c;
+      m_condition_table[(int)Condition::MI][flags] =  n;
+      m_condition_table[(int)Condition::PL][flags] = !n;
+      m_condition_table[(int)Condition::VS][flags] =  v;
+      m_condition_table[(int)Condition::VC][flags] = !v;
+      m_condition_table[(int)Condition::HI][flags] =  c && !z;
+      m_condition_table[(int)Condition::LS][flags] = !c ||  z;
+      m_condition_table[(int)Condition::GE][flags] = n == v;
+      m_condition_table[(int)Condition::LT][flags] = n != v;
+      m_condition_table[(int)Condition::GT][flags] = !(z || (n != v));
+      m_condition_table[(int)Condition::LE][flags] =  (z || (n != v));
+      m_condition_table[(int)Condition::AL][flags] = true;
+      m_condition_table[(int)Condition::NV][flags] = true;
+    }
+  }
+
+  template<typename MemoryImpl>
+  auto InterpreterCPU<MemoryImpl>::GetRegisterBankByMode(Mode mode) -> Bank {
+    switch(mode) {
+      case Mode::User:       return Bank::None;
+      case Mode::System:     return Bank::None;
+      case Mode::FIQ:        return Bank::FIQ;
+      case Mode::IRQ:        return Bank::IRQ;
+      case Mode::Supervisor: return Bank::Supervisor;
+      case Mode::Abort:      return Bank::Abort;
+      case Mode::Undefined:  return Bank::Undefined;
+    }
+
+    ATOM_PANIC("invalid ARM CPU mode: 0x{:02X}", (uint)mode);
+  }
+
+  template<typename MemoryImpl>
+  void InterpreterCPU<MemoryImpl>::SwitchMode(Mode new_mode) {
+    auto old_bank = GetRegisterBankByMode((Mode)m_state.cpsr.mode);
+    auto new_bank = GetRegisterBankByMode(new_mode);
+
+    m_state.cpsr.mode = new_mode;
+    m_spsr = &m_state.spsr[(int)new_bank];
+
+    if(old_bank == new_bank) {
+      return;
+    }
+
+    if(old_bank == Bank::FIQ) {
+      for(int i = 0; i < 5; i++){
+        m_state.bank[(int)Bank::FIQ][i] = m_state.reg[8 + i];
+      }
+
+      for(int i = 0; i < 5; i++) {
+        m_state.reg[8 + i] = m_state.bank[(int)Bank::None][i];
+      }
+    } else if(new_bank == Bank::FIQ) {
+      for(int i = 0; i < 5; i++) {
+        m_state.bank[(int)Bank::None][i] = m_state.reg[8 + i];
+      }
+
+      for(int i = 0; i < 5; i++) {
+        m_state.reg[8 + i] = m_state.bank[(int)Bank::FIQ][i];
+      }
+    }
+
+    m_state.bank[(int)old_bank][5] = m_state.r13;
+    m_state.bank[(int)old_bank][6] = m_state.r14;
+
+    m_state.r13 = m_state.bank[(int)new_bank][5];
+    m_state.r14 = m_state.bank[(int)new_bank][6];
+  }
+
+} // namespace dual::arm
@@ -27,18 +27,18 @@ static constexpr auto GenerateHandlerARM() -> Handler32 {
       const bool immediate = instruction & (1 << 22);
       const auto opcode = (instruction >> 5) & 3;
       
-      return &InterpreterCPU::ARM_HalfDoubleAndSignedTransfer<pre, add, immediate, wb, load, opcode>;
+      return &InterpreterCPU::template ARM_HalfDoubleAndSignedTransfer<pre, add, immediate, wb, load, opcode>;
     }
     case ARMInstrType::Multiply: {
       const bool set_flags = instruction & (1 << 20);
 
       switch(static_cast<MultiplyOpcode>((instruction >> 21) & 0xF)) {
-        case MultiplyOpcode::MUL:   return &InterpreterCPU::ARM_Multiply<false, set_flags>;
-        case MultiplyOpcode::MLA:   return &InterpreterCPU::ARM_Multiply<true, set_flags>;
-        case MultiplyOpcode::UMULL: return &InterpreterCPU::ARM_MultiplyLong<false, false, set_flags>;
-        case MultiplyOpcode::UMLAL: return &InterpreterCPU::ARM_MultiplyLong<false, true, set_flags>;
-        case MultiplyOpcode::SMULL: return &InterpreterCPU::ARM_MultiplyLong<true, false, set_flags>;
-        case MultiplyOpcode::SMLAL: return &InterpreterCPU::ARM_MultiplyLong<true, true, set_flags>;
+        case MultiplyOpcode::MUL:   return &InterpreterCPU::template ARM_Multiply<false, set_flags>;
+        case MultiplyOpcode::MLA:   return &InterpreterCPU::template ARM_Multiply<true, set_flags>;
+        case MultiplyOpcode::UMULL: return &InterpreterCPU::template ARM_MultiplyLong<false, false, set_flags>;
+        case MultiplyOpcode::UMLAL: return &InterpreterCPU::template ARM_MultiplyLong<false, true, set_flags>;
+        case MultiplyOpcode::SMULL: return &InterpreterCPU::template ARM_MultiplyLong<true, false, set_flags>;
+        case MultiplyOpcode::SMLAL: return &InterpreterCPU::template ARM_MultiplyLong<true, true, set_flags>;
       }
       
       break;
@@ -46,32 +46,32 @@ static constexpr auto GenerateHandlerARM() -> Handler32 {
     case ARMInstrType::SingleDataSwap: {
       const bool byte = instruction & (1 << 22);
       
-      return &InterpreterCPU::ARM_SingleDataSwap<byte>;
+      return &InterpreterCPU::template ARM_SingleDataSwap<byte>;
     }
     case ARMInstrType::StatusTransfer: {
       const bool immediate = instruction & (1 << 25);
       const bool use_spsr  = instruction & (1 << 22);
       const bool to_status = instruction & (1 << 21);
 
-      return &InterpreterCPU::ARM_StatusTransfer<immediate, use_spsr, to_status>;
+      return &InterpreterCPU::template ARM_StatusTransfer<immediate, use_spsr, to_status>;
     }
-    case ARMInstrType::BranchAndExchange:  return &InterpreterCPU::ARM_BranchAndExchangeMaybeLink<false>;
+    case ARMInstrType::BranchAndExchange:  return &InterpreterCPU::template ARM_BranchAndExchangeMaybeLink<false>;
     case ARMInstrType::CountLeadingZeros:  return &InterpreterCPU::ARM_CountLeadingZeros;
-    case ARMInstrType::BranchLinkExchange: return &InterpreterCPU::ARM_BranchAndExchangeMaybeLink<true>;
+    case ARMInstrType::BranchLinkExchange: return &InterpreterCPU::template ARM_BranchAndExchangeMaybeLink<true>;
     case ARMInstrType::SaturatingAddSubtract: {
       const int opcode = (instruction >> 20) & 0xF;
       
-      return &InterpreterCPU::ARM_SaturatingAddSubtract<opcode>;
+      return &InterpreterCPU::template ARM_SaturatingAddSubtract<opcode>;
     }
     case ARMInstrType::SignedHalfwordMultiply: {
       const bool x = instruction & (1 << 5);
       const bool y = instruction & (1 << 6);
   
       switch(static_cast<SignedMultiplyOpcode>((instruction >> 21) & 0xF)) {
-        case SignedMultiplyOpcode::SMLAxy:  return &InterpreterCPU::ARM_SignedHalfwordMultiply<true, x, y>;
-        case SignedMultiplyOpcode::SM__Wy:  return &InterpreterCPU::ARM_SignedWordHalfwordMultiply<!x, y>;
-        case SignedMultiplyOpcode::SMLALxy: return &InterpreterCPU::ARM_SignedHalfwordMultiplyLongAccumulate<x, y>;
-        case SignedMultiplyOpcode::SMULxy:  return &InterpreterCPU::ARM_SignedHalfwordMultiply<false, x, y>;
+        case SignedMultiplyOpcode::SMLAxy:  return &InterpreterCPU::template ARM_SignedHalfwordMultiply<true, x, y>;
+        case SignedMultiplyOpcode::SM__Wy:  return &InterpreterCPU::template ARM_SignedWordHalfwordMultiply<!x, y>;
+        case SignedMultiplyOpcode::SMLALxy: return &InterpreterCPU::template ARM_SignedHalfwordMultiplyLongAccumulate<x, y>;
+        case SignedMultiplyOpcode::SMULxy:  return &InterpreterCPU::template ARM_SignedHalfwordMultiply<false, x, y>;
       }
       
       break;
@@ -79,23 +79,23 @@ static constexpr auto GenerateHandlerARM() -> Handler32 {
     case ARMInstrType::DataProcessing: {
       const bool immediate = instruction & (1 << 25);
       const bool set_flags = instruction & (1 << 20);
-      const auto opcode = static_cast<InterpreterCPU::ARMDataOp>((instruction >> 21) & 0xF);
+      const auto opcode = static_cast<typename InterpreterCPU::ARMDataOp>((instruction >> 21) & 0xF);
       const auto field4 = (instruction >> 4) & 0xF;
 
-      return &InterpreterCPU::ARM_DataProcessing<immediate, opcode, set_flags, field4>;
+      return &InterpreterCPU::template ARM_DataProcessing<immediate, opcode, set_flags, field4>;
     }
     case ARMInstrType::SingleDataTransfer: {
       const bool immediate = ~instruction & (1 << 25);
       const bool byte = instruction & (1 << 22);
       
-      return &InterpreterCPU::ARM_SingleDataTransfer<immediate, pre, add, byte, wb, load>;
+      return &InterpreterCPU::template ARM_SingleDataTransfer<immediate, pre, add, byte, wb, load>;
     }
     case ARMInstrType::BlockDataTransfer: {
       const bool user_mode = instruction & (1 << 22);
             
-      return &InterpreterCPU::ARM_BlockDataTransfer<pre, add, user_mode, wb, load>;
+      return &InterpreterCPU::template ARM_BlockDataTransfer<pre, add, user_mode, wb, load>;
     }
-    case ARMInstrType::BranchAndLink: return &InterpreterCPU::ARM_BranchAndLink<(instruction >> 24) & 1>;
+    case ARMInstrType::BranchAndLink: return &InterpreterCPU::template ARM_BranchAndLink<(instruction >> 24) & 1>;
     case ARMInstrType::CoprocessorRegisterXfer: return &InterpreterCPU::ARM_CoprocessorRegisterTransfer;
     case ARMInstrType::SoftwareInterrupt: return &InterpreterCPU::ARM_SWI;
     case ARMInstrType::BranchLinkExchangeImm: return &InterpreterCPU::ARM_BranchLinkExchangeImm;
@@ -6,95 +6,95 @@ static constexpr auto GenerateHandlerThumb() -> Handler16 {
       const auto opcode  = (instruction >> 11) & 3;
       const auto offset5 = (instruction >>  6) & 0x1F;
 
-      return &InterpreterCPU::Thumb_MoveShiftedRegister<opcode, offset5>;
+      return &InterpreterCPU::template Thumb_MoveShiftedRegister<opcode, offset5>;
     }
     case ThumbInstrType::AddSub: {
       const bool immediate = (instruction >> 10) & 1;
       const bool subtract  = (instruction >>  9) & 1;
       const auto field3 = (instruction >> 6) & 7;
 
-      return &InterpreterCPU::Thumb_AddSub<immediate, subtract, field3>;
+      return &InterpreterCPU::template Thumb_AddSub<immediate, subtract, field3>;
     }
     case ThumbInstrType::MoveCompareAddSubImm: {
       const auto opcode = (instruction >> 11) & 3;
       const auto rD = (instruction >> 8) & 7;
 
-      return &InterpreterCPU::Thumb_MoveCompareAddSubImm<opcode, rD>;
+      return &InterpreterCPU::template Thumb_MoveCompareAddSubImm<opcode, rD>;
     }
     case ThumbInstrType::ALU: {
-      const auto opcode = static_cast<InterpreterCPU::ThumbDataOp>((instruction >> 6) & 0xF);
+      const auto opcode = static_cast<typename InterpreterCPU::ThumbDataOp>((instruction >> 6) & 0xF);
 
-      return &InterpreterCPU::Thumb_ALU<opcode>;
+      return &InterpreterCPU::template Thumb_ALU<opcode>;
     }
     case ThumbInstrType::HighRegisterOps: {
-      const auto opcode = static_cast<InterpreterCPU::ThumbHighRegOp>((instruction >> 8) & 3);
+      const auto opcode = static_cast<typename InterpreterCPU::ThumbHighRegOp>((instruction >> 8) & 3);
       const bool high1 = (instruction >> 7) & 1;
       const bool high2 = (instruction >> 6) & 1;
 
-      return &InterpreterCPU::Thumb_HighRegisterOps_BX<opcode, high1, high2>;
+      return &InterpreterCPU::template Thumb_HighRegisterOps_BX<opcode, high1, high2>;
     }
     case ThumbInstrType::LoadStoreRelativePC: {
       const auto rD = (instruction >> 8) & 7;
 
-      return &InterpreterCPU::Thumb_LoadStoreRelativePC<rD>;
+      return &InterpreterCPU::template Thumb_LoadStoreRelativePC<rD>;
     }
     case ThumbInstrType::LoadStoreOffsetReg: {
       const auto opcode = (instruction >> 10) & 3;
       const auto rO = (instruction >>  6) & 7;
 
-      return &InterpreterCPU::Thumb_LoadStoreOffsetReg<opcode, rO>;
+      return &InterpreterCPU::template Thumb_LoadStoreOffsetReg<opcode, rO>;
     }
     case ThumbInstrType::LoadStoreSigned: {
       const auto opcode = (instruction >> 10) & 3;
       const auto rO = (instruction >>  6) & 7;
 
-      return &InterpreterCPU::Thumb_LoadStoreSigned<opcode, rO>;
+      return &InterpreterCPU::template Thumb_LoadStoreSigned<opcode, rO>;
     }
     case ThumbInstrType::LoadStoreOffsetImm: {
       const auto opcode  = (instruction >> 11) & 3;
       const auto offset5 = (instruction >>  6) & 0x1F;
 
-      return &InterpreterCPU::Thumb_LoadStoreOffsetImm<opcode, offset5>;
+      return &InterpreterCPU::template Thumb_LoadStoreOffsetImm<opcode, offset5>;
     }
     case ThumbInstrType::LoadStoreHword: {
       const bool load = (instruction >> 11) & 1;
       const auto offset5 = (instruction >> 6) & 0x1F;
 
-      return &InterpreterCPU::Thumb_LoadStoreHword<load, offset5>;
+      return &InterpreterCPU::template Thumb_LoadStoreHword<load, offset5>;
     }
     case ThumbInstrType::LoadStoreRelativeSP: {
       const bool load = (instruction >> 11) & 1;
       const auto rD = (instruction >> 8) & 7;
 
-      return &InterpreterCPU::Thumb_LoadStoreRelativeToSP<load, rD>;
+      return &InterpreterCPU::template Thumb_LoadStoreRelativeToSP<load, rD>;
     }
     case ThumbInstrType::LoadAddress: {
       const bool use_r13 = (instruction >> 11) & 1;
       const auto rD = (instruction >> 8) & 7;
 
-      return &InterpreterCPU::Thumb_LoadAddress<use_r13, rD>;
+      return &InterpreterCPU::template Thumb_LoadAddress<use_r13, rD>;
     }
     case ThumbInstrType::AddOffsetToSP: {
       const bool subtract = (instruction >> 7) & 1;
 
-      return &InterpreterCPU::Thumb_AddOffsetToSP<subtract>;
+      return &InterpreterCPU::template Thumb_AddOffsetToSP<subtract>;
     }
     case ThumbInstrType::PushPop: {
       const bool load  = (instruction >> 11) & 1;
       const bool pc_lr = (instruction >>  8) & 1;
 
-      return &InterpreterCPU::Thumb_PushPop<load, pc_lr>;
+      return &InterpreterCPU::template Thumb_PushPop<load, pc_lr>;
     }
     case ThumbInstrType::LoadStoreMultiple: {
       const bool load = (instruction >> 11) & 1;
       const auto rB = (instruction >> 8) & 7;
 
-      return &InterpreterCPU::Thumb_LoadStoreMultiple<load, rB>;
+      return &InterpreterCPU::template Thumb_LoadStoreMultiple<load, rB>;
     }
     case ThumbInstrType::ConditionalBranch: {
       const auto condition = (instruction >> 8) & 0xF;
 
-      return &InterpreterCPU::Thumb_ConditionalBranch<condition>;
+      return &InterpreterCPU::template Thumb_ConditionalBranch<condition>;
     }
     case ThumbInstrType::SoftwareInterrupt: {
       return &InterpreterCPU::Thumb_SWI;
@@ -106,10 +106,10 @@ static constexpr auto GenerateHandlerThumb() -> Handler16 {
       return &InterpreterCPU::Thumb_LongBranchLinkPrefix;
     }
     case ThumbInstrType::LongBranchLinkSuffix: {
-      return &InterpreterCPU::Thumb_LongBranchLinkSuffix<false>;
+      return &InterpreterCPU::template Thumb_LongBranchLinkSuffix<false>;
     }
     case ThumbInstrType::LongBranchLinkExchangeSuffix: {
-      return &InterpreterCPU::Thumb_LongBranchLinkSuffix<true>;
+      return &InterpreterCPU::template Thumb_LongBranchLinkSuffix<true>;
     }
     default: break;
   }
@@ -0,0 +1,109 @@
+
+#pragma once
+
+#include <atom/meta.hpp>
+
+#include "arm/interpreter/interpreter_cpu.hpp"
+#include "decoder.hpp"
+
+namespace dual::arm {
+
+  /** A helper class used to generate lookup tables for
+    * the interpreter at compiletime.
+    * The motivation is to separate the code used for generation from
+    * the interpreter class and its header itself.
+    */
+  template<typename MemoryImpl>
+  struct TableGen {
+    using InterpreterCPU = arm::InterpreterCPU<MemoryImpl>;
+    using Handler16 = typename InterpreterCPU::Handler16;
+    using Handler32 = typename InterpreterCPU::Handler32;
+
+    #ifdef __clang__
+    #pragma clang diagnostic push
+    #pragma clang diagnostic ignored "-Weverything"
+    #endif
+
+    #include "gen_arm.hpp"
+    #include "gen_thumb.hpp"
+
+    #ifdef __clang__
+    #pragma clang diagnostic pop
+    #endif
+
+    static constexpr auto GenerateTableThumb() -> std::array<Handler16, 2048> {
+      std::array<Handler16, 2048> lut = {};
+
+      atom::static_for<std::size_t, 0, 2048>([&](auto i) {
+        lut[i] = GenerateHandlerThumb<i << 5>();
+      });
+      return lut;
+    }
+
+    static constexpr auto GenerateTableARM() -> std::array<Handler32, 8192> {
+      std::array<Handler32, 8192> lut = {};
+
+      // Conditional instructions
+      atom::static_for<std::size_t, 0, 4096>([&](auto i) {
+        lut[i] = GenerateHandlerARM<
+          ((i & 0xFF0) << 16) |
+          ((i & 0xF) << 4)>();
+      });
+
+      // Unconditional instructions
+      atom::static_for<std::size_t, 0, 4096>([&](auto i) {
+        lut[4096 + i] = GenerateHandlerARM<
+          ((i & 0xFF0) << 16) |
+          ((i & 0xF) << 4) | 0xF0000000>();
+      });
+
+      return lut;
+    }
+
+#ifdef DUAL_INTERPRETER_THREADED_DISPATCH
+    using ThreadedHandler = typename InterpreterCPU::ThreadedHandler;
+
+    static constexpr auto GenerateThreadedTableThumb() -> std::array<ThreadedHandler, 2048> {
+      std::array<ThreadedHandler, 2048> lut = {};
+
+      atom::static_for<std::size_t, 0, 2048>([&](auto i) {
+        lut[i] = &InterpreterCPU::template ThreadedThumb<GenerateHandlerThumb<i << 5>()>;
+      });
+      return lut;
+    }
+
+    static constexpr auto GenerateThreadedTableARM() -> std::array<ThreadedHandler, 8192> {
+      std::array<ThreadedHandler, 8192> lut = {};
+
+      atom::static_for<std::size_t, 0, 4096>([&](auto i) {
+        lut[i] = &InterpreterCPU::template ThreadedARM<GenerateHandlerARM<
+          ((i & 0xFF0) << 16) |
+          ((i & 0xF) << 4)>()>;
+      });
+
+      atom::static_for<std::size_t, 0, 4096>([&](auto i) {
+        lut[4096 + i] = &InterpreterCPU::template ThreadedARM<GenerateHandlerARM<
+          ((i & 0xFF0) << 16) |
+          ((i & 0xF) << 4) | 0xF0000000>()>;
+      });
+
+      return lut;
+    }
+#endif
+  };
+
+  template<typename MemoryImpl>
+  std::array<typename InterpreterCPU<MemoryImpl>::Handler16, 2048> InterpreterCPU<MemoryImpl>::k_opcode_lut_16 = TableGen<MemoryImpl>::GenerateTableThumb();
+
+  template<typename MemoryImpl>
+  std::array<typename InterpreterCPU<MemoryImpl>::Handler32, 8192> InterpreterCPU<MemoryImpl>::k_opcode_lut_32 = TableGen<MemoryImpl>::GenerateTableARM();
+
+#ifdef DUAL_INTERPRETER_THREADED_DISPATCH
+  template<typename MemoryImpl>
+  std::array<typename InterpreterCPU<MemoryImpl>::ThreadedHandler, 2048> InterpreterCPU<MemoryImpl>::k_threaded_lut_16 = TableGen<MemoryImpl>::GenerateThreadedTableThumb();
+
+  template<typename MemoryImpl>
+  std::array<typename InterpreterCPU<MemoryImpl>::ThreadedHandler, 8192> InterpreterCPU<MemoryImpl>::k_threaded_lut_32 = TableGen<MemoryImpl>::GenerateThreadedTableARM();
+#endif
+
+} // namespace dual::arm
@@ -2,11 +2,13 @@
 #pragma once
 
 #include <atom/panic.hpp>
+#include <atom/punning.hpp>
 #include <lunatic/cpu.hpp>
 #include <dual/arm/cpu.hpp>
 #include <dual/arm/memory.hpp>
 #include <dual/arm/coprocessor.hpp>
 #include <dual/common/cycle_counter.hpp>
+#include <dual/common/scheduler.hpp>
 #include <span>
 #include <vector>
 
@@ -16,10 +18,12 @@ namespace dual::arm {
     public:
       LunaticCPU(
         dual::arm::Memory& memory,
+        Scheduler& scheduler,
         CycleCounter& cycle_counter,
         Model model,
         std::span<const AttachCPn> coprocessor_table = {}
-      )   : m_lunatic_memory{memory}
+      )   : m_lunatic_memory{memory, m_idle_loop_detector}
+          , m_scheduler{scheduler}
           , m_cycle_counter{cycle_counter} {
         lunatic::CPU::Descriptor::Model lunatic_cpu_model;
         std::array<lunatic::Coprocessor*, 16> lunatic_cop_array{};
@@ -32,7 +36,7 @@ namespace dual::arm {
 
         for(auto& attach_cp_n : coprocessor_table) {
           dual::arm::Coprocessor& coprocessor = *attach_cp_n.coprocessor;
-          m_lunatic_coprocessors.emplace_back(coprocessor);
+          m_lunatic_coprocessors.emplace_back(coprocessor, m_idle_loop_detector);
           lunatic_cop_array.at(attach_cp_n.id) = &m_lunatic_coprocessors.back();
           coprocessor.SetCPU(this);
         }
@@ -46,6 +50,8 @@ namespace dual::arm {
 
       void Reset() override {
         m_lunatic_cpu->Reset();
+        m_idle_loop_detector.Reset();
+        m_idle_loop_skip = false;
       }
 
       u32 GetExceptionBase() const override {
@@ -117,44 +123,157 @@ namespace dual::arm {
       }
 
       void Run(int cycles) override {
+        /**
+         * Skip the slice after an idle loop was detected, unless an IRQ is about to interrupt it.
+         * @note: like the interpreter, this never skips past the end of a slice, so that the next slice sees
+         * any write by the other CPU to the memory or IO that the loop polls.
+         */
+        if(m_idle_loop_skip) {
+          m_idle_loop_skip = false;
+
+          if(!GetIRQFlag()) {
+            m_idle_loop_detector.AddSkippedCycles(cycles);
+            m_cycle_counter.AddDeviceCycles(cycles);
+            return;
+          }
+        }
+
         // @todo: better integration of the cycle counter with the JIT?
         m_lunatic_cpu->Run(cycles);
         m_cycle_counter.AddDeviceCycles(cycles);
+
+        /**
+         * The JIT runs whole basic blocks, so an idle loop can only be detected between two calls to Run(),
+         * which requires that the loop happens to be at the same place at the end of both calls.
+         */
+        if(m_idle_loop_detector.GetEnable()) {
+          std::array<u32, 16> reg;
+
+          for(int i = 0; i < 16; i++) {
+            reg[i] = GetGPR(static_cast<GPR>(i));
+          }
+
+          if(m_idle_loop_detector.Check(reg[15], reg, GetCPSR().word)) {
+            m_idle_loop_skip = true;
+
+            // Take a new snapshot right away, so that the loop is detected again after the next slice it runs.
+            m_idle_loop_detector.Check(reg[15], reg, GetCPSR().word);
+          }
+        }
+      }
+
+      IdleLoopDetector& GetIdleLoopDetector() override {
+        return m_idle_loop_detector;
+      }
+
+      void LoadState(StateReader& state) override {
+        CPU::LoadState(state);
+        m_idle_loop_skip = false;
       }
 
     private:
+      /**
+       * Forwards the memory accesses of the JIT to the memory buses.
+       * Accesses to pages in the page tables of the bus are done right here, which saves the virtual calls into the bus for most accesses.
+       * Building without DUAL_JIT_PAGE_TABLES sends every access to the bus, so that dual-bench --jit can compare both.
+       * @note: this is not fastmem, the JIT still calls into this adapter for every load and store.
+       */
       struct Memory final : lunatic::Memory {
-        explicit Memory(dual::arm::Memory& memory_impl) : m_memory_impl{memory_impl} {}
+        Memory(dual::arm::Memory& memory_impl, IdleLoopDetector& idle_loop_detector)
+            : m_memory_impl{memory_impl}
+            , m_idle_loop_detector{idle_loop_detector} {
+#ifdef DUAL_JIT_PAGE_TABLES
+          for(int bus = 0; bus < 3; bus++) {
+            m_read_page_tables[bus] = memory_impl.GetReadPageTable(static_cast<dual::arm::Memory::Bus>(bus));
+            m_write_page_tables[bus] = memory_impl.GetWritePageTable(static_cast<dual::arm::Memory::Bus>(bus));
+          }
+#endif
+        }
 
         u8 ReadByte(u32 address, Bus bus) override {
+          if(const u8* page = GetReadablePage(address, bus); page != nullptr) [[likely]] {
+            return atom::read<u8>(page, address & ReadPageTable::k_page_mask);
+          }
           return m_memory_impl.ReadByte(address, static_cast<dual::arm::Memory::Bus>(bus));
         }
 
         u16 ReadHalf(u32 address, Bus bus) override {
+          address &= ~1u;
+
+          if(const u8* page = GetReadablePage(address, bus); page != nullptr) [[likely]] {
+            return atom::read<u16>(page, address & ReadPageTable::k_page_mask);
+          }
           return m_memory_impl.ReadHalf(address, static_cast<dual::arm::Memory::Bus>(bus));
         }
 
         u32 ReadWord(u32 address, Bus bus) override {
+          address &= ~3u;
+
+          if(const u8* page = GetReadablePage(address, bus); page != nullptr) [[likely]] {
+            return atom::read<u32>(page, address & ReadPageTable::k_page_mask);
+          }
           return m_memory_impl.ReadWord(address, static_cast<dual::arm::Memory::Bus>(bus));
         }
 
         void WriteByte(u32 address, u8 value, Bus bus) override {
+          m_idle_loop_detector.OnWrite();
+
+          if(const WritablePage page = GetWritablePage(address, bus); page.data != nullptr) [[likely]] {
+            atom::write<u8>(page.data, address & WritePageTable::k_page_mask, value);
+            (*page.code_page_version)++;
+            return;
+          }
           m_memory_impl.WriteByte(address, value, static_cast<dual::arm::Memory::Bus>(bus));
         }
 
         void WriteHalf(u32 address, u16 value, Bus bus) override {
+          m_idle_loop_detector.OnWrite();
+
+          address &= ~1u;
+
+          if(const WritablePage page = GetWritablePage(address, bus); page.data != nullptr) [[likely]] {
+            atom::write<u16>(page.data, address & WritePageTable::k_page_mask, value);
+            (*page.code_page_version)++;
+            return;
+          }
           m_memory_impl.WriteHalf(address, value, static_cast<dual::arm::Memory::Bus>(bus));
         }
 
         void WriteWord(u32 address, u32 value, Bus bus) override {
+          m_idle_loop_detector.OnWrite();
+
+          address &= ~3u;
+
+          if(const WritablePage page = GetWritablePage(address, bus); page.data != nullptr) [[likely]] {
+            atom::write<u32>(page.data, address & WritePageTable::k_page_mask, value);
+            (*page.code_page_version)++;
+            return;
+          }
           m_memory_impl.WriteWord(address, value, static_cast<dual::arm::Memory::Bus>(bus));
         }
 
+        const u8* GetReadablePage(u32 address, Bus bus) const {
+          const ReadPageTable* page_table = m_read_page_tables[(int)bus];
+
+          return page_table != nullptr ? page_table->Get(address) : nullptr;
+        }
+
+        WritablePage GetWritablePage(u32 address, Bus bus) const {
+          const WritePageTable* page_table = m_write_page_tables[(int)bus];
+
+          return page_table != nullptr ? page_table->Get(address) : WritablePage{};
+        }
+
         dual::arm::Memory& m_memory_impl;
+        IdleLoopDetector& m_idle_loop_detector;
+        std::array<const ReadPageTable*, 3> m_read_page_tables{};
+        std::array<const WritePageTable*, 3> m_write_page_tables{};
       };
 
       struct Coprocessor final : lunatic::Coprocessor {
-        explicit Coprocessor(dual::arm::Coprocessor& coprocessor_impl) : m_coprocessor_impl{coprocessor_impl} {}
+        Coprocessor(dual::arm::Coprocessor& coprocessor_impl, IdleLoopDetector& idle_loop_detector)
+            : m_coprocessor_impl{coprocessor_impl}
+            , m_idle_loop_detector{idle_loop_detector} {}
 
         bool ShouldWriteBreakBasicBlock(int opc1, int cn, int cm, int opc2) override {
           // @todo: evaluate if narrowing this down would have any real world benefits.
@@ -166,15 +285,21 @@ namespace dual::arm {
         }
 
         void Write(int opc1, int cn, int cm, int opc2, u32 value) override {
+          m_idle_loop_detector.OnWrite();
           m_coprocessor_impl.MCR(opc1, cn, cm, opc2, value);
         }
 
         dual::arm::Coprocessor& m_coprocessor_impl;
+        IdleLoopDetector& m_idle_loop_detector;
       };
 
+      IdleLoopDetector m_idle_loop_detector{};
+      bool m_idle_loop_skip{};
+
       std::unique_ptr<lunatic::CPU> m_lunatic_cpu{};
       Memory m_lunatic_memory;
       std::vector<Coprocessor> m_lunatic_coprocessors{};
+      Scheduler& m_scheduler;
       CycleCounter& m_cycle_counter;
   };
 
@@ -0,0 +1,100 @@
+
+#include <array>
+#include <dual/common/profiler.hpp>
+#include <mutex>
+
+namespace dual {
+
+  static constexpr std::array<const char*, (int)Profiler::Zone::Count> k_zone_names{
+    "ARM9",
+    "ARM7",
+    "PPU A",
+    "PPU B",
+    "GPU: render",
+    "GPU: copy VRAM",
+    "GPU: clear",
+    "GPU: rasterize",
+    "GPU: edge marking",
+    "GPU: fog",
+    "GPU: anti-aliasing",
+    "APU: mixer",
+    "ARM9 DMA",
+    "ARM7 DMA"
+  };
+
+  static std::vector<std::string> g_event_names{};
+  static std::mutex g_event_names_mutex{};
+
+  static std::string GetEventName(std::string_view function_signature) {
+    // GCC and Clang print the template arguments as "[... method = &Class::Method]" or "[...; method = &Class::Method]".
+    const size_t begin = function_signature.rfind("= &");
+    const size_t end = function_signature.find_first_of(";,]", begin);
+
+    if(begin == std::string_view::npos || end == std::string_view::npos) {
+      return std::string{function_signature};
+    }
+
+    std::string_view name = function_signature.substr(begin + 3u, end - begin - 3u);
+
+    // Strip the namespaces, but keep the class name.
+    const size_t last_separator = name.rfind("::");
+
+    if(last_separator != std::string_view::npos && last_separator > 0u) {
+      const size_t class_separator = name.rfind("::", last_separator - 1u);
+
+      if(class_separator != std::string_view::npos) {
+        name.remove_prefix(class_separator + 2u);
+      }
+    }
+
+    return std::string{name};
+  }
+
+  int Profiler::RegisterEvent(std::string_view function_signature) {
+    std::lock_guard lock_guard{g_event_names_mutex};
+
+    if(g_event_names.size() == (size_t)k_max_events) {
+      return -1;
+    }
+
+    g_event_names.push_back(GetEventName(function_signature));
+    return (int)g_event_names.size() - 1;
+  }
+
+  Profile Profiler::GetProfile() const {
+    Profile profile{};
+
+    for(int i = 0; i < (int)Zone::Count; i++) {
+      profile.zones.push_back({
+        .name = k_zone_names[i],
+        .calls = m_zone_counters[i].calls.load(std::memory_order_relaxed),
+        .nanoseconds = m_zone_counters[i].total_nanoseconds.load(std::memory_order_relaxed)
+      });
+    }
+
+    std::lock_guard lock_guard{g_event_names_mutex};
+
+    for(size_t i = 0; i < g_event_names.size(); i++) {
+      profile.events.push_back({
+        .name = g_event_names[i],
+        .calls = m_event_counters[i].calls.load(std::memory_order_relaxed),
+        .nanoseconds = m_event_counters[i].total_nanoseconds.load(std::memory_order_relaxed)
+      });
+    }
+
+    return profile;
+  }
+
+  void Profiler::Reset() {
+    for(auto& counter : m_zone_counters) {
+      counter.calls.store(0u, std::memory_order_relaxed);
+      counter.total_nanoseconds.store(0u, std::memory_order_relaxed);
+    }
+
+    for(auto& counter : m_event_counters) {
+      counter.calls.store(0u, std::memory_order_relaxed);
+      counter.total_nanoseconds.store(0u, std::memory_order_relaxed);
+    }
+  }
+
+} // namespace dual
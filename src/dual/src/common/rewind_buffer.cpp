@@ -0,0 +1,215 @@
+#include <algorithm>
+#include <atom/panic.hpp>
+#include <cstring>
+#include <dual/common/rewind_buffer.hpp>
+
+namespace dual {
+
+  /**
+   * Delta format:
+   *   u32 size of the source state
+   *   runs of {u32 bytes to skip, u32 literal size, literal bytes XOR'ed with the destination state}
+   * Bytes past the end of either state are treated as zero.
+   */
+
+  static void WriteU32(std::vector<u8>& buffer, u32 value) {
+    const size_t offset = buffer.size();
+
+    buffer.resize(offset + sizeof(u32));
+    std::memcpy(&buffer[offset], &value, sizeof(u32));
+  }
+
+  static u32 ReadU32(std::span<const u8> buffer, size_t& offset) {
+    u32 value;
+
+    if(offset + sizeof(u32) > buffer.size()) {
+      ATOM_PANIC("rewind: truncated delta");
+    }
+    std::memcpy(&value, &buffer[offset], sizeof(u32));
+    offset += sizeof(u32);
+    return value;
+  }
+
+  static u64 ReadU64(const u8* data, size_t offset) {
+    u64 value;
+    std::memcpy(&value, &data[offset], sizeof(u64));
+    return value;
+  }
+
+  RewindBuffer::RewindBuffer(size_t max_snapshots, size_t memory_budget)
+      : m_max_snapshots{std::max<size_t>(max_snapshots, 1u)}
+      , m_memory_budget{memory_budget} {
+  }
+
+  void RewindBuffer::Push(std::vector<u8>& state) {
+    if(m_has_keyframe) {
+      // The delta turns the new keyframe back into the current one.
+      EncodeDelta(m_keyframe, state, m_scratch);
+
+      m_deltas.emplace_back(m_scratch.begin(), m_scratch.end());
+      m_deltas_size += m_scratch.size();
+    }
+
+    std::swap(m_keyframe, state);
+    m_has_keyframe = true;
+
+    DropOldSnapshots();
+  }
+
+  bool RewindBuffer::Pop(std::vector<u8>& state) {
+    if(!m_has_keyframe) {
+      return false;
+    }
+
+    state.assign(m_keyframe.begin(), m_keyframe.end());
+
+    if(m_deltas.empty()) {
+      m_has_keyframe = false;
+    } else {
+      ApplyDelta(m_deltas.back(), m_keyframe);
+
+      m_deltas_size -= m_deltas.back().size();
+      m_deltas.pop_back();
+    }
+    return true;
+  }
+
+  void RewindBuffer::Clear() {
+    m_has_keyframe = false;
+    m_deltas.clear();
+    m_deltas_size = 0u;
+  }
+
+  auto RewindBuffer::GetStats() const -> Stats {
+    return {
+      .snapshots = m_has_keyframe ? m_deltas.size() + 1u : 0u,
+      .memory_usage = m_keyframe.capacity() + m_deltas_size + m_scratch.capacity(),
+      .memory_budget = m_memory_budget,
+      .keyframe_size = m_keyframe.size()
+    };
+  }
+
+  void RewindBuffer::DropOldSnapshots() {
+    const size_t fixed_size = m_keyframe.capacity() + m_scratch.capacity();
+
+    while(!m_deltas.empty() && (m_deltas.size() + 1u > m_max_snapshots || fixed_size + m_deltas_size > m_memory_budget)) {
+      m_deltas_size -= m_deltas.front().size();
+      m_deltas.pop_front();
+    }
+  }
+
+  void RewindBuffer::EncodeDelta(std::span<const u8> src, std::span<const u8> dst, std::vector<u8>& delta) {
+    const size_t common_size = std::min(src.size(), dst.size());
+    const size_t total_size = std::max(src.size(), dst.size());
+
+    size_t skip_begin = 0u;
+
+    const auto emit_literal = [&](size_t begin, size_t end) {
+      WriteU32(delta, (u32)(begin - skip_begin));
+      WriteU32(delta, (u32)(end - begin));
+
+      const size_t offset = delta.size();
+
+      delta.resize(offset + end - begin);
+
+      u8* literal = &delta[offset];
+
+      if(end <= common_size) {
+        // @note: kept free of branches so that the compiler vectorizes it.
+        for(size_t i = begin; i < end; i++) {
+          *literal++ = src[i] ^ dst[i];
+        }
+      } else {
+        for(size_t i = begin; i < end; i++) {
+          const u8 a = i < src.size() ? src[i] : 0u;
+          const u8 b = i < dst.size() ? dst[i] : 0u;
+
+          *literal++ = a ^ b;
+        }
+      }
+
+      skip_begin = end;
+    };
+
+    delta.clear();
+    WriteU32(delta, (u32)src.size());
+
+    /**
+     * Most pages do not change between two snapshots. Those are skipped with a single memcmp(),
+     * the remaining pages are scanned a word at a time for runs of changed bytes.
+     */
+    for(size_t page = 0u; page < common_size; page += k_page_size) {
+      const size_t page_end = std::min(page + k_page_size, common_size);
+
+      if(std::memcmp(&src[page], &dst[page], page_end - page) == 0) {
+        continue;
+      }
+
+      size_t i = page;
+
+      while(i < page_end) {
+        while(i + sizeof(u64) <= page_end && ReadU64(src.data(), i) == ReadU64(dst.data(), i)) {
+          i += sizeof(u64);
+        }
+
+        if(i + sizeof(u64) > page_end) {
+          while(i < page_end && src[i] == dst[i]) i++;
+
+          if(i == page_end) {
+            break;
+          }
+        }
+
+        const size_t literal_begin = i;
+
+        while(i + sizeof(u64) <= page_end && ReadU64(src.data(), i) != ReadU64(dst.data(), i)) {
+          i += sizeof(u64);
+        }
+
+        // Less than a word left in the page, simply take all of it.
+        if(i + sizeof(u64) > page_end) {
+          i = page_end;
+        }
+
+        emit_literal(literal_begin, i);
+      }
+    }
+
+    if(total_size > common_size) {
+      emit_literal(common_size, total_size);
+    }
+  }
+
+  void RewindBuffer::ApplyDelta(std::span<const u8> delta, std::vector<u8>& state) {
+    size_t offset = 0u;
+    size_t position = 0u;
+
+    const size_t src_size = ReadU32(delta, offset);
+
+    // @note: resizing fills new bytes with zeroes, which is what the encoder assumed for bytes past the end.
+    state.resize(std::max(state.size(), src_size));
+
+    while(offset < delta.size()) {
+      position += ReadU32(delta, offset);
+
+      const size_t literal_size = ReadU32(delta, offset);
+
+      if(offset + literal_size > delta.size() || position + literal_size > state.size()) {
+        ATOM_PANIC("rewind: bad delta");
+      }
+
+      const u8* literal = &delta[offset];
+      u8* data = &state[position];
+
+      for(size_t i = 0; i < literal_size; i++) {
+        data[i] ^= literal[i];
+      }
+
+      offset += literal_size;
+      position += literal_size;
+    }
+
+    state.resize(src_size);
+  }
+
+} // namespace dual
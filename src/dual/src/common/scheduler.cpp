@@ -1,97 +1,528 @@
 
+#include <algorithm>
 #include <atom/panic.hpp>
+#include <bit>
 #include <dual/common/scheduler.hpp>
+#include <dual/common/scheduler_trace.hpp>
 
 namespace dual {
 
-  Scheduler::Scheduler() {
-    for(int i = 0; i < k_event_limit; i++) {
-      m_heap[i] = &m_pool[i];
-      m_heap[i]->handle = i;
-    }
+  Scheduler::Scheduler(Backend backend) : m_backend{backend} {
     Reset();
   }
 
+  void Scheduler::SetBackend(Backend backend) {
+    if(backend == m_backend) {
+      return;
+    }
+
+    std::vector<Event*> events{};
+
+    for(Event* event : m_heap) {
+      events.push_back(event);
+    }
+
+    for(Event* head : m_wheel) {
+      if(head) {
+        Event* event = head;
+        do {
+          events.push_back(event);
+          event = event->next;
+        } while(event != head);
+      }
+    }
+
+    for(Event* event : events) {
+      Unlink(event);
+    }
+
+    m_backend = backend;
+    m_wheel_base = m_timestamp_now;
+
+    for(Event* event : events) {
+      Insert(event);
+    }
+
+    UpdateTarget();
+  }
+
   void Scheduler::Reset() {
-    m_heap_size = 0;
+    Clear();
+
     m_timestamp_now = 0;
+    m_timestamp_target = std::numeric_limits<u64>::max();
+    m_wheel_base = 0;
+
+    // Subsystems register their persistent events again after a reset, which gives them the IDs that save states refer to.
+    m_persistent_events.clear();
 
-    Add(std::numeric_limits<u64>::max(), [](int) {
+    Register(&m_end_of_queue_event, nullptr, [](void*, int) {
       ATOM_PANIC("reached end of the event queue.");
     });
+    Retarget(&m_end_of_queue_event, std::numeric_limits<u64>::max());
+  }
+
+  void Scheduler::Clear() {
+    // Persistent events outlive a reset, make sure that none of them still refers to the queue.
+    for(Event* event : m_heap) {
+      event->handle = -1;
+    }
+
+    for(Event*& head : m_wheel) {
+      if(head) {
+        Event* event = head;
+        do {
+          event->slot = -1;
+          event = event->next;
+        } while(event != head);
+        head = nullptr;
+      }
+    }
+
+    m_heap.clear();
+    std::fill(std::begin(m_wheel_occupied), std::end(m_wheel_occupied), 0u);
+
+    m_pool_free.clear();
+    for(auto& event : m_pool) {
+      m_pool_free.push_back(&event);
+    }
+  }
+
+  void Scheduler::SaveState(StateWriter& state) const {
+    /**
+     * Events are saved in the order in which they are stored in the queue.
+     * Inserting them in the same order again rebuilds the same heap and the same wheel slots,
+     * so that events with the same timestamp fire in the same order as before.
+     */
+    std::vector<const Event*> events{};
+
+    for(const Event* event : m_heap) {
+      events.push_back(event);
+    }
+
+    for(const Event* head : m_wheel) {
+      if(head) {
+        const Event* event = head;
+        do {
+          events.push_back(event);
+          event = event->next;
+        } while(event != head);
+      }
+    }
+
+    state.Write(m_timestamp_now);
+    state.Write(m_wheel_base);
+    state.Write((u32)events.size());
+
+    for(const Event* event : events) {
+      if(!IsPersistent(event)) {
+        ATOM_PANIC("scheduler: cannot save an event which was not registered");
+      }
+
+      state.Write((u32)event->id);
+      state.Write(event->timestamp);
+    }
+  }
+
+  void Scheduler::LoadState(StateReader& state) {
+    Clear();
+
+    state.Read(m_timestamp_now);
+    state.Read(m_wheel_base);
+
+    m_timestamp_target = std::numeric_limits<u64>::max();
+
+    const u32 event_count = state.Read<u32>();
+
+    for(u32 i = 0; i < event_count; i++) {
+      const u32 id = state.Read<u32>();
+      const u64 timestamp = state.Read<u64>();
+
+      if(id >= m_persistent_events.size()) {
+        ATOM_PANIC("scheduler: save state refers to an unknown event (id={})", id);
+      }
+
+      Event* event = m_persistent_events[id];
+
+      if(event->IsScheduled()) {
+        ATOM_PANIC("scheduler: save state holds the same event twice (id={})", id);
+      }
+
+      event->timestamp = timestamp;
+      event->fired = false;
+      Insert(event);
+    }
   }
 
   void Scheduler::Step() {
     const u64 now = GetTimestampNow();
 
-    while(m_heap_size > 0 && m_heap[0]->timestamp <= now) {
-      auto event = m_heap[0];
+    while(m_timestamp_target <= now) {
+      auto event = GetNextEvent();
+
+      if(m_trace) [[unlikely]] {
+        m_trace->Record(SchedulerTrace::Op::FireBegin, event, 0u);
+      }
+
+      /**
+       * The event stays in the queue while its callback runs.
+       * Re-arming it from the callback then only needs to move it within the queue,
+       * which is cheaper than removing it and inserting it again.
+       */
+      event->fired = true;
+#ifdef DUAL_ENABLE_PROFILER
+      if(m_profiler && event->profile_id != -1) {
+        ProfileScope profile_scope{m_profiler->GetEventCounter(event->profile_id)};
+        event->callback(event->object, int(now - event->timestamp));
+      } else {
+        event->callback(event->object, int(now - event->timestamp));
+      }
+#else
+      event->callback(event->object, int(now - event->timestamp));
+#endif
 
-      event->callback(int(now - event->timestamp));
+      // @note: the callback may have re-armed or cancelled the event.
+      if(event->fired && event->IsScheduled()) {
+        Remove(event);
+      }
 
-      // @note: the handle may have changed due to the event callback.
-      Remove(event->handle);
+      if(m_trace) [[unlikely]] {
+        m_trace->Record(SchedulerTrace::Op::FireEnd, event, 0u);
+      }
+    }
+
+    // All remaining events lie in the future now, so the wheel can safely catch up with the current time.
+    if(m_backend == Backend::TimingWheel && now > m_wheel_base) {
+      WheelAdvance(now);
     }
   }
 
-  auto Scheduler::Add(u64 delay, std::function<void(int)> callback) -> Event* {
-    int n = m_heap_size++;
-    int p = Parent(n);
+  auto Scheduler::Add(u64 delay, void* object, Callback callback) -> Event* {
+    if(m_pool_free.empty()) {
+      auto& event = m_pool.emplace_back();
+      event.pooled = true;
+      m_pool_free.push_back(&event);
+    }
+
+    auto event = m_pool_free.back();
+    m_pool_free.pop_back();
+    event->object = object;
+    event->callback = callback;
+    event->profile_id = -1;
+    Retarget(event, GetTimestampNow() + delay);
+    return event;
+  }
+
+  void Scheduler::Cancel(Event* event) {
+    if(m_trace) [[unlikely]] {
+      m_trace->Record(SchedulerTrace::Op::Cancel, event, 0u);
+    }
 
-    if(m_heap_size > k_event_limit) {
-      ATOM_PANIC("exceeded maximum number of scheduler events.");
+    if(event->IsScheduled()) {
+      Remove(event);
     }
+  }
 
-    auto event = m_heap[n];
-    event->timestamp = GetTimestampNow() + delay;
+  void Scheduler::Register(Event* event, void* object, Callback callback) {
+    Cancel(event);
+    event->object = object;
     event->callback = callback;
+    event->profile_id = -1;
 
-    while(n != 0 && m_heap[p]->timestamp > m_heap[n]->timestamp) {
-      Swap(n, p);
-      n = p;
-      p = Parent(n);
+    if(!IsPersistent(event)) {
+      event->id = (int)m_persistent_events.size();
+      m_persistent_events.push_back(event);
+    }
+  }
+
+  bool Scheduler::IsPersistent(const Event* event) const {
+    // @note: the ID may be left over from before the last reset.
+    return event->id != -1 && event->id < (int)m_persistent_events.size() && m_persistent_events[event->id] == event;
+  }
+
+  void Scheduler::Retarget(Event* event, u64 timestamp) {
+    if(m_trace) [[unlikely]] {
+      m_trace->Record(SchedulerTrace::Op::Arm, event, timestamp - GetTimestampNow());
+    }
+
+    event->fired = false;
+
+    if(event->handle != -1 && m_backend == Backend::BinaryHeap) {
+      const u64 old_timestamp = event->timestamp;
+
+      event->timestamp = timestamp;
+
+      if(timestamp < old_timestamp) {
+        HeapSiftUp(event->handle);
+      } else {
+        HeapSiftDown(event->handle);
+      }
+
+      m_timestamp_target = m_heap[0]->timestamp;
+      return;
+    }
+
+    if(event->IsScheduled()) {
+      Unlink(event);
+    }
+
+    event->timestamp = timestamp;
+    Insert(event);
+  }
+
+  void Scheduler::Insert(Event* event) {
+    if(m_backend == Backend::TimingWheel) {
+      WheelInsert(event);
+    } else {
+      HeapInsert(event);
+    }
+
+    m_timestamp_target = std::min(m_timestamp_target, event->timestamp);
+  }
+
+  void Scheduler::Unlink(Event* event) {
+    if(event->slot != -1) {
+      WheelRemove(event);
+    } else {
+      HeapRemove(event);
+    }
+
+    if(event->timestamp <= m_timestamp_target) {
+      UpdateTarget();
+    }
+  }
+
+  void Scheduler::Remove(Event* event) {
+    Unlink(event);
+
+    if(event->pooled) {
+      m_pool_free.push_back(event);
+    }
+  }
+
+  void Scheduler::UpdateTarget() {
+    for(int level = 0; level < k_wheel_levels; level++) {
+      const u64 occupied = m_wheel_occupied[level];
+
+      if(occupied != 0u) {
+        /**
+         * Every event on a level lies after all events on the levels below it,
+         * and within a level the lowest occupied slot holds the earliest events.
+         */
+        Event* head = m_wheel[level * k_wheel_slots + std::countr_zero(occupied)];
+        Event* event = head->next;
+
+        u64 target = head->timestamp;
+
+        while(event != head) {
+          target = std::min(target, event->timestamp);
+          event = event->next;
+        }
+
+        m_timestamp_target = target;
+        return;
+      }
+    }
+
+    if(m_heap.empty()) {
+      m_timestamp_target = std::numeric_limits<u64>::max();
+    } else {
+      m_timestamp_target = m_heap[0]->timestamp;
+    }
+  }
+
+  auto Scheduler::GetNextEvent() -> Event* {
+    if(m_backend == Backend::BinaryHeap) {
+      return m_heap[0];
+    }
+
+    // Advancing the wheel to the target cascades the earliest events down into the first level.
+    if(m_timestamp_target > m_wheel_base) {
+      WheelAdvance(m_timestamp_target);
+    }
+
+    Event* head = m_wheel[m_wheel_base & (k_wheel_slots - 1)];
+    Event* event = head;
+
+    // @note: events with the same timestamp fire in the order they were scheduled in.
+    while(event->timestamp != m_timestamp_target) {
+      event = event->next;
     }
 
     return event;
   }
 
-  void Scheduler::Remove(int n) {
-    Swap(n, --m_heap_size);
+  void Scheduler::RecordAddCycles(int cycles) {
+    m_trace->Record(SchedulerTrace::Op::AddCycles, nullptr, (u64)cycles);
+  }
+
+  void Scheduler::HeapInsert(Event* event) {
+    const int n = (int)m_heap.size();
+
+    m_heap.push_back(event);
+    event->handle = n;
+    HeapSiftUp(n);
+  }
+
+  void Scheduler::HeapRemove(Event* event) {
+    const int n = event->handle;
+    Event* last = m_heap.back();
+
+    m_heap.pop_back();
+    event->handle = -1;
+
+    if(last != event) {
+      m_heap[n] = last;
+      last->handle = n;
+
+      if(n != 0 && m_heap[Parent(n)]->timestamp > last->timestamp) {
+        HeapSiftUp(n);
+      } else {
+        HeapSiftDown(n);
+      }
+    }
+  }
+
+  void Scheduler::HeapSiftUp(int n) {
+    Event* event = m_heap[n];
+
+    while(n != 0) {
+      const int p = Parent(n);
+      Event* parent = m_heap[p];
+
+      if(parent->timestamp <= event->timestamp) {
+        break;
+      }
+
+      m_heap[n] = parent;
+      parent->handle = n;
+      n = p;
+    }
+
+    m_heap[n] = event;
+    event->handle = n;
+  }
+
+  void Scheduler::HeapSiftDown(int n) {
+    const int size = (int)m_heap.size();
+
+    Event* event = m_heap[n];
+
+    while(true) {
+      int c = LeftChild(n);
+
+      if(c >= size) {
+        break;
+      }
+
+      if(c + 1 < size && m_heap[c + 1]->timestamp < m_heap[c]->timestamp) {
+        c++;
+      }
+
+      Event* child = m_heap[c];
+
+      if(child->timestamp >= event->timestamp) {
+        break;
+      }
+
+      m_heap[n] = child;
+      child->handle = n;
+      n = c;
+    }
+
+    m_heap[n] = event;
+    event->handle = n;
+  }
+
+  void Scheduler::WheelInsert(Event* event) {
+    /**
+     * Each level of the wheel holds the events which share all digits above that level with the wheel base,
+     * with one slot per value of the digit. Events that are already late sit in the current slot of the first level.
+     */
+    const u64 timestamp = std::max(event->timestamp, m_wheel_base);
+    const u64 difference = timestamp ^ m_wheel_base;
+
+    if(difference >> (k_wheel_bits * k_wheel_levels)) {
+      HeapInsert(event);
+      return;
+    }
+
+    const int level = difference == 0u ? 0 : (std::bit_width(difference) - 1) / k_wheel_bits;
+    const int slot  = level * k_wheel_slots + (int)((timestamp >> (level * k_wheel_bits)) & (k_wheel_slots - 1));
 
-    int p = Parent(n);
+    Event*& head = m_wheel[slot];
 
-    if(n != 0 && m_heap[p]->timestamp > m_heap[n]->timestamp) {
-      do {
-        Swap(n, p);
-        n = p;
-        p = Parent(n);
-      } while(n != 0 && m_heap[p]->timestamp > m_heap[n]->timestamp);
+    if(head) {
+      event->prev = head->prev;
+      event->next = head;
+      head->prev->next = event;
+      head->prev = event;
     } else {
-      Heapify(n);
+      event->prev = event;
+      event->next = event;
+      head = event;
+      m_wheel_occupied[level] |= 1ull << (slot & (k_wheel_slots - 1));
     }
+
+    event->slot = slot;
   }
 
-  void Scheduler::Swap(int i, int j) {
-    auto tmp = m_heap[i];
-    m_heap[i] = m_heap[j];
-    m_heap[j] = tmp;
-    m_heap[i]->handle = i;
-    m_heap[j]->handle = j;
+  void Scheduler::WheelRemove(Event* event) {
+    const int slot = event->slot;
+
+    Event*& head = m_wheel[slot];
+
+    if(event->next == event) {
+      head = nullptr;
+      m_wheel_occupied[slot / k_wheel_slots] &= ~(1ull << (slot & (k_wheel_slots - 1)));
+    } else {
+      event->prev->next = event->next;
+      event->next->prev = event->prev;
+
+      if(head == event) {
+        head = event->next;
+      }
+    }
+
+    event->slot = -1;
   }
 
-  void Scheduler::Heapify(int n) {
-    const int l = LeftChild(n);
-    const int r = RightChild(n);
+  void Scheduler::WheelAdvance(u64 timestamp) {
+    const u64 difference = timestamp ^ m_wheel_base;
+
+    m_wheel_base = timestamp;
+
+    /**
+     * The new base may not lie past any event in the wheel, so all levels below the highest changed digit are empty.
+     * The events in the slot of that digit now share it with the base and must move to the lower levels.
+     */
+    const int level = (std::bit_width(difference) - 1) / k_wheel_bits;
+
+    if(level < k_wheel_levels) {
+      const int slot = level * k_wheel_slots + (int)((timestamp >> (level * k_wheel_bits)) & (k_wheel_slots - 1));
+
+      Event* head = m_wheel[slot];
+
+      if(head) {
+        m_wheel[slot] = nullptr;
+        m_wheel_occupied[level] &= ~(1ull << (slot & (k_wheel_slots - 1)));
+
+        head->prev->next = nullptr;
 
-    if(l < m_heap_size && m_heap[l]->timestamp < m_heap[n]->timestamp) {
-      Swap(l, n);
-      Heapify(l);
+        while(head) {
+          Event* next = head->next;
+          WheelInsert(head);
+          head = next;
+        }
+      }
     }
 
-    if(r < m_heap_size && m_heap[r]->timestamp < m_heap[n]->timestamp) {
-      Swap(r, n);
-      Heapify(r);
+    // Far events which came within reach of the wheel move over from the heap.
+    while(!m_heap.empty() && ((m_heap[0]->timestamp ^ m_wheel_base) >> (k_wheel_bits * k_wheel_levels)) == 0u) {
+      Event* event = m_heap[0];
+      HeapRemove(event);
+      WheelInsert(event);
     }
   }
 
-} // namespace dual
\ No newline at end of file
+} // namespace dual
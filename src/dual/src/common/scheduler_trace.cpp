@@ -0,0 +1,98 @@
+
+#include <algorithm>
+#include <dual/common/scheduler_trace.hpp>
+#include <fstream>
+
+namespace dual {
+
+  static constexpr u32 k_trace_magic = 0x52545344u; // "DSTR"
+  static constexpr u32 k_trace_version = 1u;
+
+  void SchedulerTrace::Record(Op op, const void* event, u64 value) {
+    if(m_entries.size() >= m_capacity) [[unlikely]] {
+      m_dropped_count++;
+      return;
+    }
+
+    u32 event_id = 0u;
+
+    if(event) {
+      const auto match = m_event_ids.find(event);
+
+      if(match == m_event_ids.end()) {
+        event_id = (u32)m_event_count++;
+        m_event_ids[event] = event_id;
+      } else {
+        event_id = match->second;
+      }
+    }
+
+    m_entries.push_back({op, event_id, value});
+  }
+
+  void SchedulerTrace::Clear() {
+    m_entries.clear();
+    m_event_ids.clear();
+    m_event_count = 0u;
+    m_dropped_count = 0u;
+  }
+
+  bool SchedulerTrace::Load(const std::string& path) {
+    std::ifstream file{path, std::ios::binary};
+
+    if(!file.good()) {
+      return false;
+    }
+
+    u32 header[2];
+    u64 entry_count;
+
+    file.read((char*)header, sizeof(header));
+    file.read((char*)&entry_count, sizeof(entry_count));
+
+    if(!file.good() || header[0] != k_trace_magic || header[1] != k_trace_version) {
+      return false;
+    }
+
+    Clear();
+    m_entries.resize(entry_count);
+
+    for(auto& entry : m_entries) {
+      u8 op;
+
+      file.read((char*)&op, sizeof(op));
+      file.read((char*)&entry.event_id, sizeof(entry.event_id));
+      file.read((char*)&entry.value, sizeof(entry.value));
+      entry.op = (Op)op;
+
+      m_event_count = std::max(m_event_count, (size_t)entry.event_id + 1u);
+    }
+
+    return file.good();
+  }
+
+  bool SchedulerTrace::Save(const std::string& path) const {
+    std::ofstream file{path, std::ios::binary};
+
+    if(!file.good()) {
+      return false;
+    }
+
+    const u32 header[2] { k_trace_magic, k_trace_version };
+    const u64 entry_count = m_entries.size();
+
+    file.write((const char*)header, sizeof(header));
+    file.write((const char*)&entry_count, sizeof(entry_count));
+
+    for(const auto& entry : m_entries) {
+      const u8 op = (u8)entry.op;
+
+      file.write((const char*)&op, sizeof(op));
+      file.write((const char*)&entry.event_id, sizeof(entry.event_id));
+      file.write((const char*)&entry.value, sizeof(entry.value));
+    }
+
+    return file.good();
+  }
+
+} // namespace dual
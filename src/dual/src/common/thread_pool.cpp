@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <atom/panic.hpp>
+#include <atomic>
+#include <dual/common/thread_pool.hpp>
+#include <dual/common/tracer.hpp>
+#include <memory>
+
+namespace dual {
+
+  ThreadPool::ThreadPool(int thread_count) {
+    if(thread_count < 1) {
+      ATOM_PANIC("bad number of worker threads: {}", thread_count);
+    }
+
+    for(int i = 0; i < thread_count; i++) {
+      m_threads.emplace_back(&ThreadPool::ThreadMain, this);
+    }
+  }
+
+  ThreadPool::~ThreadPool() {
+    {
+      std::lock_guard lock{m_mutex};
+      m_quit = true;
+    }
+
+    m_cv.notify_all();
+
+    for(auto& thread : m_threads) thread.join();
+  }
+
+  void ThreadPool::Submit(std::function<void()> task) {
+    {
+      std::lock_guard lock{m_mutex};
+      m_tasks.push_back(std::move(task));
+    }
+
+    m_cv.notify_one();
+  }
+
+  void ThreadPool::ParallelFor(int count, const std::function<void(int)>& task) {
+    struct Batch {
+      std::atomic_int next_index{};
+      int remaining;
+      std::mutex mutex{};
+      std::condition_variable cv{};
+    };
+
+    if(count <= 0) {
+      return;
+    }
+
+    // @note: workers may pick up their share after all indices are done, so the batch must outlive this call.
+    const auto batch = std::make_shared<Batch>();
+
+    batch->remaining = count;
+
+    const int worker_count = std::min(count, GetThreadCount());
+
+    for(int i = 0; i < worker_count; i++) {
+      Submit([batch, count, &task]() {
+        int index;
+
+        while((index = batch->next_index.fetch_add(1)) < count) {
+          task(index);
+
+          std::lock_guard lock{batch->mutex};
+
+          if(--batch->remaining == 0) {
+            batch->cv.notify_all();
+          }
+        }
+      });
+    }
+
+    // @note: the task is captured by reference, which is fine because once all indices are done, it is no longer called.
+    std::unique_lock lock{batch->mutex};
+    batch->cv.wait(lock, [&]() { return batch->remaining == 0; });
+  }
+
+  void ThreadPool::ThreadMain() {
+    Tracer::SetThreadName("Worker");
+
+    while(true) {
+      std::function<void()> task;
+
+      {
+        std::unique_lock lock{m_mutex};
+        m_cv.wait(lock, [this]() { return m_quit || !m_tasks.empty(); });
+
+        if(m_tasks.empty()) {
+          return;
+        }
+
+        task = std::move(m_tasks.front());
+        m_tasks.pop_front();
+      }
+
+      task();
+    }
+  }
+
+} // namespace dual
@@ -0,0 +1,241 @@
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <dual/common/tracer.hpp>
+#include <fmt/format.h>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace dual {
+
+  std::atomic_bool Tracer::s_enabled{false};
+
+  enum class TracePhase : u8 {
+    Begin,
+    End,
+    Counter
+  };
+
+  struct TraceEvent {
+    const char* name;
+    u64 timestamp;
+    s64 value;
+    TracePhase phase;
+  };
+
+  struct TraceBuffer {
+    static constexpr size_t k_capacity = 1u << 18;
+
+    // Only the owning thread writes events. It publishes them by incrementing the size.
+    std::unique_ptr<TraceEvent[]> events{};
+    std::atomic<size_t> size{};
+    std::atomic<u64> dropped_events{};
+    std::atomic<u64> generation{};
+    std::atomic<const char*> thread_name{};
+    int thread_id{};
+  };
+
+  static const auto g_time_base = std::chrono::steady_clock::now();
+
+  static std::mutex g_buffers_mutex{};
+  static std::vector<std::unique_ptr<TraceBuffer>> g_buffers{};
+
+  // Buffers of threads which have exited. They stay in g_buffers, so that Save() still writes their events.
+  static std::vector<TraceBuffer*> g_free_buffers{};
+
+  // Incremented by Clear(). Every thread empties its own buffer once it sees that its buffer belongs to an older generation.
+  static std::atomic<u64> g_generation{};
+
+  static thread_local TraceBuffer* t_buffer = nullptr;
+
+  static bool IsSameThreadName(const char* a, const char* b) {
+    return a == b || (a && b && std::strcmp(a, b) == 0);
+  }
+
+  /**
+   * Returns the buffer of the calling thread to the free list when the thread exits.
+   * Threads like the PPU render workers are recreated on every reset, which otherwise would leak one buffer each time.
+   */
+  class TraceBufferOwner {
+    public:
+     ~TraceBufferOwner() {
+        if(m_buffer) {
+          std::lock_guard lock_guard{g_buffers_mutex};
+          g_free_buffers.push_back(m_buffer);
+          t_buffer = nullptr;
+        }
+      }
+
+      void SetBuffer(TraceBuffer* buffer) {
+        m_buffer = buffer;
+      }
+
+    private:
+      TraceBuffer* m_buffer{};
+  };
+
+  static thread_local TraceBufferOwner t_buffer_owner{};
+
+  static TraceBuffer& AcquireThreadBuffer(const char* thread_name) {
+    std::lock_guard lock_guard{g_buffers_mutex};
+
+    const u64 generation = g_generation.load(std::memory_order_relaxed);
+
+    // @note: a free buffer continues the timeline of the exited thread, so it may only be taken over by a thread
+    // with the same name, unless none of its events would be saved anymore.
+    const auto match = std::find_if(g_free_buffers.begin(), g_free_buffers.end(), [&](TraceBuffer* buffer) {
+      return IsSameThreadName(buffer->thread_name.load(std::memory_order_relaxed), thread_name) ||
+             buffer->generation.load(std::memory_order_relaxed) != generation ||
+             buffer->size.load(std::memory_order_relaxed) == 0u;
+    });
+
+    TraceBuffer* buffer;
+
+    if(match != g_free_buffers.end()) {
+      buffer = *match;
+      g_free_buffers.erase(match);
+    } else {
+      buffer = g_buffers.emplace_back(std::make_unique<TraceBuffer>()).get();
+      buffer->thread_id = (int)g_buffers.size();
+      buffer->generation = generation;
+    }
+
+    buffer->thread_name.store(thread_name, std::memory_order_relaxed);
+    t_buffer = buffer;
+    t_buffer_owner.SetBuffer(buffer);
+    return *buffer;
+  }
+
+  static TraceBuffer& GetThreadBuffer() {
+    if(!t_buffer) [[unlikely]] {
+      return AcquireThreadBuffer(nullptr);
+    }
+    return *t_buffer;
+  }
+
+  static void Record(const char* name, TracePhase phase, s64 value) {
+    const auto timestamp = std::chrono::steady_clock::now() - g_time_base;
+
+    auto& buffer = GetThreadBuffer();
+
+    // @note: the events are allocated lazily, because many threads only ever name themselves.
+    if(!buffer.events) [[unlikely]] {
+      buffer.events = std::make_unique<TraceEvent[]>(TraceBuffer::k_capacity);
+    }
+
+    const u64 generation = g_generation.load(std::memory_order_relaxed);
+
+    if(buffer.generation.load(std::memory_order_relaxed) != generation) [[unlikely]] {
+      buffer.generation.store(generation, std::memory_order_relaxed);
+      buffer.size.store(0u, std::memory_order_relaxed);
+      buffer.dropped_events.store(0u, std::memory_order_relaxed);
+    }
+
+    const size_t size = buffer.size.load(std::memory_order_relaxed);
+
+    if(size == TraceBuffer::k_capacity) {
+      buffer.dropped_events.fetch_add(1u, std::memory_order_relaxed);
+      return;
+    }
+
+    buffer.events[size] = {
+      .name = name,
+      .timestamp = (u64)std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp).count(),
+      .value = value,
+      .phase = phase
+    };
+
+    buffer.size.store(size + 1u, std::memory_order_release);
+  }
+
+  void Tracer::SetThreadName(const char* name) {
+    if(!t_buffer) {
+      AcquireThreadBuffer(name);
+    } else {
+      t_buffer->thread_name.store(name, std::memory_order_relaxed);
+    }
+  }
+
+  void Tracer::Begin(const char* name) {
+    Record(name, TracePhase::Begin, 0);
+  }
+
+  void Tracer::End(const char* name) {
+    Record(name, TracePhase::End, 0);
+  }
+
+  void Tracer::Counter(const char* name, s64 value) {
+    Record(name, TracePhase::Counter, value);
+  }
+
+  bool Tracer::Save(const std::string& path) {
+    std::ofstream file{path, std::ios::out | std::ios::trunc};
+
+    if(!file.good()) {
+      return false;
+    }
+
+    std::lock_guard lock_guard{g_buffers_mutex};
+
+    bool first_event = true;
+
+    const auto write_event = [&](const std::string& event_json) {
+      file << (first_event ? "\n  " : ",\n  ") << event_json;
+      first_event = false;
+    };
+
+    file << "{\"traceEvents\": [";
+
+    const u64 generation = g_generation.load(std::memory_order_relaxed);
+
+    for(const auto& buffer : g_buffers) {
+      const int tid = buffer->thread_id;
+      const bool cleared = buffer->generation.load(std::memory_order_relaxed) != generation;
+      const char* thread_name = buffer->thread_name.load(std::memory_order_relaxed);
+
+      if(thread_name) {
+        write_event(fmt::format(R"({{"name": "thread_name", "ph": "M", "pid": 1, "tid": {}, "args": {{"name": "{}"}}}})", tid, thread_name));
+      }
+
+      const size_t size = cleared ? 0u : buffer->size.load(std::memory_order_acquire);
+
+      for(size_t i = 0; i < size; i++) {
+        const TraceEvent& event = buffer->events[i];
+        const double ts = (double)event.timestamp * 1e-3;
+
+        switch(event.phase) {
+          case TracePhase::Begin: {
+            write_event(fmt::format(R"({{"name": "{}", "ph": "B", "ts": {:.3f}, "pid": 1, "tid": {}}})", event.name, ts, tid));
+            break;
+          }
+          case TracePhase::End: {
+            write_event(fmt::format(R"({{"name": "{}", "ph": "E", "ts": {:.3f}, "pid": 1, "tid": {}}})", event.name, ts, tid));
+            break;
+          }
+          case TracePhase::Counter: {
+            write_event(fmt::format(R"({{"name": "{}", "ph": "C", "ts": {:.3f}, "pid": 1, "tid": {}, "args": {{"value": {}}}}})", event.name, ts, tid, event.value));
+            break;
+          }
+        }
+      }
+
+      const u64 dropped_events = cleared ? 0u : buffer->dropped_events.load(std::memory_order_relaxed);
+
+      if(dropped_events != 0u) {
+        write_event(fmt::format(R"({{"name": "dropped events", "ph": "M", "pid": 1, "tid": {}, "args": {{"count": {}}}}})", tid, dropped_events));
+      }
+    }
+
+    file << "\n]}\n";
+
+    return file.good();
+  }
+
+  void Tracer::Clear() {
+    g_generation.fetch_add(1u, std::memory_order_relaxed);
+  }
+
+} // namespace dual
@@ -1,5 +1,6 @@
 
 #include <algorithm>
+#include <atom/meta.hpp>
 #include <atom/panic.hpp>
 #include <dual/nds/arm7/apu.hpp>
 
@@ -22,7 +23,7 @@ namespace dual::nds::arm7 {
     0x7FFF
   };
 
-  APU::APU(Scheduler& scheduler, arm::Memory& bus) : m_scheduler{scheduler}, m_bus{bus} {}
+  APU::APU(Scheduler& scheduler, arm::Memory& bus, Profiler& profiler) : m_scheduler{scheduler}, m_bus{bus}, m_profiler{profiler} {}
 
   void APU::Reset() {
     m_soundxcnt.fill({});
@@ -34,15 +35,57 @@ namespace dual::nds::arm7 {
     m_soundbias = 0u;
     m_channels.fill({});
 
-    for(int id = 0; id < 16; id++) {
-      m_channels[id].sampling_event_fn = [this, id](int cycles_late) {
-        SampleChannel(id, cycles_late);
-      };
+    atom::static_for<int, 0, 16>([&](auto id) {
+      m_scheduler.Register<&APU::SampleChannel<id>>(&m_channels[id].sampling_event, this);
 
       RecomputeChannelSamplingInterval(id);
+    });
+
+    m_scheduler.Register<&APU::SampleMixers>(&m_mixer_event, this);
+    m_scheduler.Reschedule(&m_mixer_event, k_cycles_per_sample);
+  }
+
+  void APU::SaveState(StateWriter& state) const {
+    state.Write(m_soundxcnt);
+    state.Write(m_soundxsad);
+    state.Write(m_soundxtmr);
+    state.Write(m_soundxpnt);
+    state.Write(m_soundxlen);
+    state.Write(m_soundcnt);
+    state.Write(m_soundbias);
+
+    // @note: the sampling events are saved by the scheduler.
+    for(const Channel& channel : m_channels) {
+      state.Write(channel.sampling_interval);
+      state.Write(channel.current_sample);
+      state.Write(channel.current_address);
+      state.Write(channel.sample_format);
+      state.Write(channel.adpcm);
+      state.Write(channel.noise_lfsr);
+      state.Write(channel.samples_left);
+      state.Write(channel.samples_pipe);
     }
+  }
 
-    m_scheduler.Add(k_cycles_per_sample, this, &APU::SampleMixers);
+  void APU::LoadState(StateReader& state) {
+    state.Read(m_soundxcnt);
+    state.Read(m_soundxsad);
+    state.Read(m_soundxtmr);
+    state.Read(m_soundxpnt);
+    state.Read(m_soundxlen);
+    state.Read(m_soundcnt);
+    state.Read(m_soundbias);
+
+    for(Channel& channel : m_channels) {
+      state.Read(channel.sampling_interval);
+      state.Read(channel.current_sample);
+      state.Read(channel.current_address);
+      state.Read(channel.sample_format);
+      state.Read(channel.adpcm);
+      state.Read(channel.noise_lfsr);
+      state.Read(channel.samples_left);
+      state.Read(channel.samples_pipe);
+    }
   }
 
   AudioDriverBase* APU::GetAudioDriver() {
@@ -66,6 +109,17 @@ namespace dual::nds::arm7 {
   }
 
   void APU::SampleMixers(int cycles_late) {
+    DUAL_PROFILE_SCOPE(m_profiler, Profiler::Zone::APUMixer);
+
+    /**
+     * Nothing is mixed while the output is disabled (e.g. when fast-forwarding or running ahead).
+     * The partially filled buffer is kept as it is, so that the output continues seamlessly after a save state was loaded.
+     */
+    if(!m_output_enable) {
+      m_scheduler.Reschedule(&m_mixer_event, k_cycles_per_sample - cycles_late);
+      return;
+    }
+
     f32 samples[2] {0.f, 0.f};
 
     if(m_soundcnt.master_enable) {
@@ -94,13 +148,13 @@ namespace dual::nds::arm7 {
     m_audio_buffer.PushBack((i16)(samples[1] * 32767));
 
     if(m_audio_buffer.Full()) {
-      if(m_output_enable && m_audio_driver) {
+      if(m_audio_driver) {
         m_audio_driver->QueueSamples(m_audio_buffer);
       }
       m_audio_buffer.Clear();
     }
 
-    m_scheduler.Add(k_cycles_per_sample - cycles_late, this, &APU::SampleMixers);
+    m_scheduler.Reschedule(&m_mixer_event, k_cycles_per_sample - cycles_late);
   }
 
   void APU::SampleChannel(int id, int cycles_late) {
@@ -116,6 +170,11 @@ namespace dual::nds::arm7 {
     }
   }
 
+  template<int id>
+  void APU::SampleChannel(int cycles_late) {
+    SampleChannel(id, cycles_late);
+  }
+
   void APU::SampleChannelPSG(int id) {
     Channel& channel = m_channels[id];
 
@@ -262,11 +321,11 @@ namespace dual::nds::arm7 {
   void APU::ScheduleSampleChannel(int id, int cycles_late) {
     Channel& channel = m_channels[id];
 
-    channel.sampling_event = m_scheduler.Add(channel.sampling_interval - cycles_late, channel.sampling_event_fn);
+    m_scheduler.Reschedule(&channel.sampling_event, channel.sampling_interval - cycles_late);
   }
 
   void APU::CancelSampleChannel(int id) {
-    m_scheduler.Cancel(m_channels[id].sampling_event);
+    m_scheduler.Cancel(&m_channels[id].sampling_event);
   }
 
   void APU::RecomputeChannelSamplingInterval(int id) {
@@ -22,6 +22,20 @@ namespace dual::nds::arm7 {
     for(auto& latch : m_latch) latch = {};
   }
 
+  void DMA::SaveState(StateWriter& state) const {
+    state.Write(m_dmasad);
+    state.Write(m_dmadad);
+    state.Write(m_dmacnt);
+    state.Write(m_latch);
+  }
+
+  void DMA::LoadState(StateReader& state) {
+    state.Read(m_dmasad);
+    state.Read(m_dmadad);
+    state.Read(m_dmacnt);
+    state.Read(m_latch);
+  }
+
   void DMA::Request(StartTime timing) {
     for(int id : {0, 1, 2, 3}) {
       const auto& dmacnt = m_dmacnt[id];
@@ -88,6 +102,8 @@ namespace dual::nds::arm7 {
   }
 
   void DMA::Run(int id) {
+    DUAL_PROFILE_SCOPE(m_profiler, Profiler::Zone::DMA7);
+
     static constexpr int k_address_offset[2][4] {
       {2, -2, 0, 2},
       {4, -4, 0, 4}
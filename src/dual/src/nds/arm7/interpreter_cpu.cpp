@@ -0,0 +1,10 @@
+
+#include <dual/nds/arm7/memory.hpp>
+
+#include "arm/interpreter/interpreter_cpu.inl"
+
+namespace dual::arm {
+
+  template class InterpreterCPU<nds::arm7::MemoryBus>;
+
+} // namespace dual::arm
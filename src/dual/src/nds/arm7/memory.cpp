@@ -1,4 +1,5 @@
 
+#include <algorithm>
 #include <dual/nds/arm7/memory.hpp>
 
 namespace dual::nds::arm7 {
@@ -11,21 +12,40 @@ namespace dual::nds::arm7 {
       , m_iwram{memory.arm7.iwram.data()}
       , m_swram{memory.swram}
       , m_vram{memory.vram}
+      , m_shared_access_monitor{hw.shared_access_monitor}
+      , m_code_page_versions{memory.code_page_versions}
       , m_io{hw} {
+    // Keep the page tables in sync with the WRAMCNT mapping.
+    m_swram.AddCallback([this]() {
+      UpdatePageTables(0x03000000u, 0x03FFFFFFu);
+    });
+
+    UpdatePageTables(0u, arm::ReadPageTable::k_address_limit - 1u);
   }
 
   void MemoryBus::Reset() {
     m_io.postflg = 0u;
   }
 
-  template<typename T> T MemoryBus::Read(u32 address, Bus bus) {
-    address &= ~(sizeof(T) - 1u);
+  void MemoryBus::SaveState(StateWriter& state) const {
+    state.Write(m_io.postflg);
+  }
+
+  void MemoryBus::LoadState(StateReader& state) {
+    state.Read(m_io.postflg);
+  }
 
+  template<typename T> T MemoryBus::ReadSlow(u32 address, Bus bus) {
     switch(address >> 24) {
       case 0x00: {
         return atom::read<T>(m_boot_rom, address & 0x3FFFu);
       }
       case 0x02: {
+        m_shared_access_monitor.ThreadSync(CPU::ARM7);
+
+        if(bus == Bus::Data) {
+          m_shared_access_monitor.OnAccessEWRAM(CPU::ARM7, address);
+        }
         return atom::read<T>(m_ewram, address & 0x3FFFFFu);
       }
       case 0x03: {
@@ -35,6 +55,8 @@ namespace dual::nds::arm7 {
         return atom::read<T>(m_swram.arm7.data, address & m_swram.arm7.mask);
       }
       case 0x04: {
+        m_shared_access_monitor.OnReadIO(CPU::ARM7, address);
+
         if constexpr(std::is_same_v<T, u8 >) return m_io.ReadByte(address);
         if constexpr(std::is_same_v<T, u16>) return m_io.ReadHalf(address);
         if constexpr(std::is_same_v<T, u32>) return m_io.ReadWord(address);
@@ -42,6 +64,8 @@ namespace dual::nds::arm7 {
         return 0;
       }
       case 0x06: {
+        m_shared_access_monitor.ThreadSync(CPU::ARM7);
+
         return m_vram.region_arm7_wram.Read<T>(address);
       }
     }
@@ -50,29 +74,39 @@ namespace dual::nds::arm7 {
     return 0;
   }
 
-  template<typename T> void MemoryBus::Write(u32 address, T value, Bus bus) {
-    address &= ~(sizeof(T) - 1u);
-
+  template<typename T> void MemoryBus::WriteSlow(u32 address, T value, Bus bus) {
     switch(address >> 24) {
       case 0x02: {
+        m_shared_access_monitor.ThreadSync(CPU::ARM7);
+
+        if(bus == Bus::Data) {
+          m_shared_access_monitor.OnAccessEWRAM(CPU::ARM7, address);
+        }
         atom::write<T>(m_ewram, address & 0x3FFFFFu, value);
+        m_code_page_versions.ewram.OnWrite(address & 0x3FFFFFu);
         break;
       }
       case 0x03: {
         if((address & 0x00800000u) || !m_swram.arm7.data) {
           atom::write<T>(m_iwram, address & 0xFFFFu, value);
+          m_code_page_versions.arm7_iwram.OnWrite(address & 0xFFFFu);
         } else {
           atom::write<T>(m_swram.arm7.data, address & m_swram.arm7.mask, value);
+          m_code_page_versions.swram.OnWrite(m_swram.GetOffset(m_swram.arm7, address));
         }
         break;
       }
       case 0x04: {
+        m_shared_access_monitor.OnAccessIO(CPU::ARM7, address);
+
         if constexpr(std::is_same_v<T, u8 >) m_io.WriteByte(address, value);
         if constexpr(std::is_same_v<T, u16>) m_io.WriteHalf(address, value);
         if constexpr(std::is_same_v<T, u32>) m_io.WriteWord(address, value);
         break;
       }
       case 0x06: {
+        m_shared_access_monitor.ThreadSync(CPU::ARM7);
+
         m_vram.region_arm7_wram.Write<T>(address, value);
         break;
       }
@@ -86,28 +120,77 @@ namespace dual::nds::arm7 {
     }
   }
 
-  u8 MemoryBus::ReadByte(u32 address, Bus bus) {
-    return Read<u8>(address, bus);
-  }
+  template u8  MemoryBus::ReadSlow<u8 >(u32 address, Bus bus);
+  template u16 MemoryBus::ReadSlow<u16>(u32 address, Bus bus);
+  template u32 MemoryBus::ReadSlow<u32>(u32 address, Bus bus);
 
-  u16 MemoryBus::ReadHalf(u32 address, Bus bus) {
-    return Read<u16>(address, bus);
-  }
+  template void MemoryBus::WriteSlow<u8 >(u32 address, u8  value, Bus bus);
+  template void MemoryBus::WriteSlow<u16>(u32 address, u16 value, Bus bus);
+  template void MemoryBus::WriteSlow<u32>(u32 address, u32 value, Bus bus);
+
+  void MemoryBus::UpdatePageTables(u32 address_lo, u32 address_hi) {
+    if(address_lo >= arm::ReadPageTable::k_address_limit) {
+      return;
+    }
+
+    address_hi = std::min(address_hi, arm::ReadPageTable::k_address_limit - 1u);
 
-  u32 MemoryBus::ReadWord(u32 address, Bus bus) {
-    return Read<u32>(address, bus);
+    for(u32 address = address_lo & ~arm::ReadPageTable::k_page_mask; address <= address_hi; address += arm::ReadPageTable::k_page_size) {
+      m_read_pages.Set(address, GetReadablePage(address));
+      m_write_pages.Set(address, GetWritablePage(address));
+    }
   }
 
-  void MemoryBus::WriteByte(u32 address, u8 value, Bus bus) {
-    Write<u8>(address, value, bus);
+  const u8* MemoryBus::GetReadablePage(u32 address) {
+    // @note: this must resolve the address the same way as ReadSlow() does and may only map memory that can be read without side effects.
+    switch(address >> 24) {
+      case 0x00: {
+        return &m_boot_rom[address & 0x3FFFu];
+      }
+      case 0x03: {
+        if((address & 0x00800000u) || !m_swram.arm7.data) {
+          return &m_iwram[address & 0xFFFFu];
+        }
+        return &m_swram.arm7.data[address & m_swram.arm7.mask];
+      }
+    }
+
+    // Main memory, IO and VRAM accesses synchronize the CPUs.
+    return nullptr;
   }
 
-  void MemoryBus::WriteHalf(u32 address, u16 value, Bus bus) {
-    Write<u16>(address, value, bus);
+  arm::WritablePage MemoryBus::GetWritablePage(u32 address) {
+    // @note: this must resolve the address the same way as WriteSlow() does and may only map memory that can be written without side effects.
+    if((address >> 24) == 0x03) {
+      if((address & 0x00800000u) || !m_swram.arm7.data) {
+        return {&m_iwram[address & 0xFFFFu], m_code_page_versions.arm7_iwram.Get(address & 0xFFFFu)};
+      }
+      return {&m_swram.arm7.data[address & m_swram.arm7.mask], m_code_page_versions.swram.Get(m_swram.GetOffset(m_swram.arm7, address))};
+    }
+
+    // Main memory, IO and VRAM accesses synchronize the CPUs.
+    return {};
   }
 
-  void MemoryBus::WriteWord(u32 address, u32 value, Bus bus) {
-    Write<u32>(address, value, bus);
+  const u64* MemoryBus::GetCodePageVersion(u32 address) {
+    // @note: this must resolve the address the same way as ReadSlow() does.
+    switch(address >> 24) {
+      case 0x00: {
+        return m_code_page_versions.arm7_bios.Get(address & 0x3FFFu);
+      }
+      case 0x02: {
+        return m_code_page_versions.ewram.Get(address & 0x3FFFFFu);
+      }
+      case 0x03: {
+        if((address & 0x00800000u) || !m_swram.arm7.data) {
+          return m_code_page_versions.arm7_iwram.Get(address & 0xFFFFu);
+        }
+        return m_code_page_versions.swram.Get(m_swram.GetOffset(m_swram.arm7, address));
+      }
+    }
+
+    // VRAM and the other regions are rarely used for code and writes to them are not counted.
+    return nullptr;
   }
 
 } // namespace dual::nds::arm7
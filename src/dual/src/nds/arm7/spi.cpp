@@ -27,6 +27,22 @@ namespace dual::nds::arm7 {
     }
   }
 
+  void SPI::SaveState(StateWriter& state) const {
+    state.Write(m_spicnt);
+    state.Write(m_spidata);
+    state.Write(m_chip_select);
+    m_firmware->SaveState(state);
+    m_touch_screen->SaveState(state);
+  }
+
+  void SPI::LoadState(StateReader& state) {
+    state.Read(m_spicnt);
+    state.Read(m_spidata);
+    state.Read(m_chip_select);
+    m_firmware->LoadState(state);
+    m_touch_screen->LoadState(state);
+  }
+
   auto SPI::Read_SPICNT() -> u16 {
     return m_spicnt.half;
   }
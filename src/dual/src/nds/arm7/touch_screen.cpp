@@ -8,6 +8,20 @@ namespace dual::nds::arm7 {
     m_data_out = 0u;
   }
 
+  void TouchScreen::SaveState(StateWriter& state) const {
+    state.Write(m_data_out);
+    state.Write(m_pen_down);
+    state.Write(m_pen_x);
+    state.Write(m_pen_y);
+  }
+
+  void TouchScreen::LoadState(StateReader& state) {
+    state.Read(m_data_out);
+    state.Read(m_pen_down);
+    state.Read(m_pen_x);
+    state.Read(m_pen_y);
+  }
+
   void TouchScreen::Select() {
   }
 
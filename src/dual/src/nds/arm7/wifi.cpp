@@ -9,6 +9,16 @@ namespace dual::nds::arm7 {
     m_bb_regs.fill(0u);
   }
 
+  void WIFI::SaveState(StateWriter& state) const {
+    state.Write(m_io);
+    state.Write(m_bb_regs);
+  }
+
+  void WIFI::LoadState(StateReader& state) {
+    state.Read(m_io);
+    state.Read(m_bb_regs);
+  }
+
   u32 WIFI::Read_IO(u32 address) {
     // We hardcode W_POWERSTATE to indicate that the WiFi hardware is powered down.
     // This is done to break out of an otherwise infinite loop in the mainline Pokémon games.
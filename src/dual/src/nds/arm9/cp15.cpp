@@ -28,6 +28,23 @@ namespace dual::nds::arm9 {
     MCR(0, 9, 1, 1, 0x00000020);
   }
 
+  void CP15::SaveState(StateWriter& state) const {
+    state.Write(m_control.word);
+    state.Write(m_dtcm_region);
+    state.Write(m_itcm_region);
+  }
+
+  void CP15::LoadState(StateReader& state) {
+    const u32 control = state.Read<u32>();
+    const u32 dtcm_region = state.Read<u32>();
+    const u32 itcm_region = state.Read<u32>();
+
+    // Replay the register writes, which also updates the TCM configuration of the bus and the exception base.
+    MCR(0, 9, 1, 0, dtcm_region);
+    MCR(0, 9, 1, 1, itcm_region);
+    MCR(0, 1, 0, 0, control);
+  }
+
   u32 CP15::MRC(int opc1, int cn, int cm, int opc2) {
     switch(ID(opc1, cn, cm, opc2)) {
       case ID(0, 0, 0, 0): { // Main ID
@@ -13,6 +13,24 @@ namespace dual::nds::arm9 {
     m_less_than_half_full = true;
   }
 
+  void DMA::SaveState(StateWriter& state) const {
+    state.Write(m_dmasad);
+    state.Write(m_dmadad);
+    state.Write(m_dmacnt);
+    state.Write(m_dmafill);
+    state.Write(m_latch);
+    state.Write(m_less_than_half_full);
+  }
+
+  void DMA::LoadState(StateReader& state) {
+    state.Read(m_dmasad);
+    state.Read(m_dmadad);
+    state.Read(m_dmacnt);
+    state.Read(m_dmafill);
+    state.Read(m_latch);
+    state.Read(m_less_than_half_full);
+  }
+
   void DMA::Request(StartTime timing) {
     for(int id : {0, 1, 2, 3}) {
       const auto& dmacnt = m_dmacnt[id];
@@ -97,6 +115,8 @@ namespace dual::nds::arm9 {
   }
 
   void DMA::Run(int id) {
+    DUAL_PROFILE_SCOPE(m_profiler, Profiler::Zone::DMA9);
+
     static constexpr int k_address_offset[2][4] {
       {2, -2, 0, 2},
       {4, -4, 0, 4}
@@ -0,0 +1,10 @@
+
+#include <dual/nds/arm9/memory.hpp>
+
+#include "arm/interpreter/interpreter_cpu.inl"
+
+namespace dual::arm {
+
+  template class InterpreterCPU<nds::arm9::MemoryBus>;
+
+} // namespace dual::arm
@@ -1,4 +1,5 @@
 
+#include <algorithm>
 #include <dual/nds/arm9/memory.hpp>
 
 namespace dual::nds::arm9 {
@@ -12,26 +13,78 @@ namespace dual::nds::arm9 {
       , m_oam{memory.oam.data()}
       , m_swram{hw.swram}
       , m_vram{hw.vram}
+      , m_shared_access_monitor{hw.shared_access_monitor}
+      , m_code_page_versions{memory.code_page_versions}
       , m_io{hw} {
     m_dtcm.data = memory.arm9.dtcm.data();
     m_itcm.data = memory.arm9.itcm.data();
+
+    // Keep the page tables in sync with the WRAMCNT and VRAMCNT mappings.
+    m_swram.AddCallback([this]() {
+      UpdatePageTables(0x03000000u, 0x03FFFFFFu);
+    });
+
+    m_vram.region_ppu_bg[0].AddCallback([this](u32, size_t) {
+      UpdatePageTables(0x06000000u, 0x061FFFFFu);
+    });
+
+    m_vram.region_ppu_bg[1].AddCallback([this](u32, size_t) {
+      UpdatePageTables(0x06200000u, 0x063FFFFFu);
+    });
+
+    m_vram.region_ppu_obj[0].AddCallback([this](u32, size_t) {
+      UpdatePageTables(0x06400000u, 0x065FFFFFu);
+    });
+
+    m_vram.region_ppu_obj[1].AddCallback([this](u32, size_t) {
+      UpdatePageTables(0x06600000u, 0x067FFFFFu);
+    });
+
+    m_vram.region_lcdc.AddCallback([this](u32, size_t) {
+      UpdatePageTables(0x06800000u, 0x06FFFFFFu);
+    });
+
+    UpdatePageTables(0u, arm::ReadPageTable::k_address_limit - 1u);
   }
 
   void MemoryBus::Reset() {
     m_io.postflg = 0u;
   }
 
+  void MemoryBus::SaveState(StateWriter& state) const {
+    state.Write(m_io.postflg);
+  }
+
+  void MemoryBus::LoadState(StateReader& state) {
+    state.Read(m_io.postflg);
+  }
+
   void MemoryBus::SetupDTCM(const TCM::Config& config) {
-    m_dtcm.config = config;
+    if(config != m_dtcm.config) {
+      const TCM::Config old_config = m_dtcm.config;
+
+      m_dtcm.config = config;
+      UpdatePageTables(old_config.base_address, old_config.high_address);
+      UpdatePageTables(config.base_address, config.high_address);
+    }
   }
 
   void MemoryBus::SetupITCM(const TCM::Config& config) {
-    m_itcm.config = config;
+    if(config != m_itcm.config) {
+      const TCM::Config old_config = m_itcm.config;
+
+      m_itcm.config = config;
+      m_code_page_versions.InvalidateAll();
+      UpdatePageTables(old_config.base_address, old_config.high_address);
+      UpdatePageTables(config.base_address, config.high_address);
+    }
   }
 
-  template<typename T> T MemoryBus::Read(u32 address, Bus bus) {
-    address &= ~(sizeof(T) - 1u);
+  void MemoryBus::OnWatchRegionsChanged() {
+    UpdatePageTables(0x02000000u, 0x02FFFFFFu);
+  }
 
+  template<typename T> T MemoryBus::ReadSlow(u32 address, Bus bus) {
     if(
       bus != Bus::System && m_itcm.config.readable &&
       address >= m_itcm.config.base_address &&
@@ -50,6 +103,9 @@ namespace dual::nds::arm9 {
 
     switch(address >> 24) {
       case 0x02: {
+        if(bus == Bus::Data) {
+          m_shared_access_monitor.OnAccessEWRAM(CPU::ARM9, address);
+        }
         return atom::read<T>(m_ewram, address & 0x3FFFFFu);
       }
       case 0x03: {
@@ -59,6 +115,8 @@ namespace dual::nds::arm9 {
         return atom::read<T>(m_swram.arm9.data, address & m_swram.arm9.mask);
       }
       case 0x04: {
+        m_shared_access_monitor.OnAccessIO(CPU::ARM9, address);
+
         if constexpr(std::is_same_v<T, u8 >) return m_io.ReadByte(address);
         if constexpr(std::is_same_v<T, u16>) return m_io.ReadHalf(address);
         if constexpr(std::is_same_v<T, u32>) return m_io.ReadWord(address);
@@ -92,15 +150,16 @@ namespace dual::nds::arm9 {
     return 0;
   }
 
-  template<typename T> void MemoryBus::Write(u32 address, T value, Bus bus) {
-    address &= ~(sizeof(T) - 1u);
-
+  template<typename T> void MemoryBus::WriteSlow(u32 address, T value, Bus bus) {
     if(
       bus != Bus::System && m_itcm.config.writable &&
       address >= m_itcm.config.base_address &&
       address <= m_itcm.config.high_address
     ) {
-      atom::write<T>(m_itcm.data, (address - m_itcm.config.base_address) & 0x7FFFu, value);
+      const u32 offset = (address - m_itcm.config.base_address) & 0x7FFFu;
+
+      atom::write<T>(m_itcm.data, offset, value);
+      m_code_page_versions.arm9_itcm.OnWrite(offset);
       return;
     }
 
@@ -115,7 +174,11 @@ namespace dual::nds::arm9 {
 
     switch(address >> 24) {
       case 0x02: {
+        if(bus == Bus::Data) {
+          m_shared_access_monitor.OnAccessEWRAM(CPU::ARM9, address);
+        }
         atom::write<T>(m_ewram, address & 0x3FFFFFu, value);
+        m_code_page_versions.ewram.OnWrite(address & 0x3FFFFFu);
         break;
       }
       case 0x03: {
@@ -123,9 +186,12 @@ namespace dual::nds::arm9 {
           return;
         }
         atom::write<T>(m_swram.arm9.data, address & m_swram.arm9.mask, value);
+        m_code_page_versions.swram.OnWrite(m_swram.GetOffset(m_swram.arm9, address));
         break;
       }
       case 0x04: {
+        m_shared_access_monitor.OnAccessIO(CPU::ARM9, address);
+
         if constexpr(std::is_same_v<T, u8 >) m_io.WriteByte(address, value);
         if constexpr(std::is_same_v<T, u16>) m_io.WriteHalf(address, value);
         if constexpr(std::is_same_v<T, u32>) m_io.WriteWord(address, value);
@@ -169,28 +235,146 @@ namespace dual::nds::arm9 {
     }
   }
 
-  u8 MemoryBus::ReadByte(u32 address, Bus bus) {
-    return Read<u8>(address, bus);
-  }
+  template u8  MemoryBus::ReadSlow<u8 >(u32 address, Bus bus);
+  template u16 MemoryBus::ReadSlow<u16>(u32 address, Bus bus);
+  template u32 MemoryBus::ReadSlow<u32>(u32 address, Bus bus);
 
-  u16 MemoryBus::ReadHalf(u32 address, Bus bus) {
-    return Read<u16>(address, bus);
-  }
+  template void MemoryBus::WriteSlow<u8 >(u32 address, u8  value, Bus bus);
+  template void MemoryBus::WriteSlow<u16>(u32 address, u16 value, Bus bus);
+  template void MemoryBus::WriteSlow<u32>(u32 address, u32 value, Bus bus);
 
-  u32 MemoryBus::ReadWord(u32 address, Bus bus) {
-    return Read<u32>(address, bus);
+  void MemoryBus::UpdatePageTables(u32 address_lo, u32 address_hi) {
+    if(address_lo >= arm::ReadPageTable::k_address_limit) {
+      return;
+    }
+
+    address_hi = std::min(address_hi, arm::ReadPageTable::k_address_limit - 1u);
+
+    for(u32 address = address_lo & ~arm::ReadPageTable::k_page_mask; address <= address_hi; address += arm::ReadPageTable::k_page_size) {
+      m_read_pages[(int)Bus::Code].Set(address, GetReadablePage(address, Bus::Code));
+      m_read_pages[(int)Bus::Data].Set(address, GetReadablePage(address, Bus::Data));
+      m_read_pages[(int)Bus::System].Set(address, GetReadablePage(address, Bus::System));
+      m_write_pages[0].Set(address, GetWritablePage(address, Bus::Data));
+      m_write_pages[1].Set(address, GetWritablePage(address, Bus::System));
+    }
   }
 
-  void MemoryBus::WriteByte(u32 address, u8 value, Bus bus) {
-    Write<u8>(address, value, bus);
+  const u8* MemoryBus::GetReadablePage(u32 address, Bus bus) {
+    // @note: this must resolve the address the same way as ReadSlow() does and may only map memory that can be read without side effects.
+    if(
+      bus != Bus::System && m_itcm.config.readable &&
+      address >= m_itcm.config.base_address &&
+      address <= m_itcm.config.high_address
+    ) {
+      return &m_itcm.data[(address - m_itcm.config.base_address) & 0x7FFFu];
+    }
+
+    if(
+      bus == Bus::Data && m_dtcm.config.readable &&
+      address >= m_dtcm.config.base_address &&
+      address <= m_dtcm.config.high_address
+    ) {
+      return &m_dtcm.data[(address - m_dtcm.config.base_address) & 0x3FFFu];
+    }
+
+    switch(address >> 24) {
+      case 0x02: {
+        if(bus == Bus::Data && m_shared_access_monitor.IsWatched(address)) {
+          return nullptr;
+        }
+        return &m_ewram[address & 0x3FFFFFu];
+      }
+      case 0x03: {
+        if(!m_swram.arm9.data) {
+          return nullptr;
+        }
+        return &m_swram.arm9.data[address & m_swram.arm9.mask];
+      }
+      case 0x06: {
+        // @note: pages where no bank or multiple banks are mapped have no single host page.
+        switch((address >> 20) & 15) {
+          case 0: case 1: return m_vram.region_ppu_bg [0].GetUnsafePointer<u8>(address & 0x1FFFFFu);
+          case 2: case 3: return m_vram.region_ppu_bg [1].GetUnsafePointer<u8>(address & 0x1FFFFFu);
+          case 4: case 5: return m_vram.region_ppu_obj[0].GetUnsafePointer<u8>(address & 0x1FFFFFu);
+          case 6: case 7: return m_vram.region_ppu_obj[1].GetUnsafePointer<u8>(address & 0x1FFFFFu);
+          default:        return m_vram.region_lcdc.GetUnsafePointer<u8>(address & 0xFFFFFu);
+        }
+      }
+    }
+
+    // IO has side effects, PRAM depends on the PPU power state and both PRAM and OAM mirror every 2 KiB.
+    return nullptr;
   }
 
-  void MemoryBus::WriteHalf(u32 address, u16 value, Bus bus) {
-    Write<u16>(address, value, bus);
+  arm::WritablePage MemoryBus::GetWritablePage(u32 address, Bus bus) {
+    // @note: this must resolve the address the same way as WriteSlow() does and may only map memory that can be written without side effects.
+    if(
+      bus != Bus::System && m_itcm.config.writable &&
+      address >= m_itcm.config.base_address &&
+      address <= m_itcm.config.high_address
+    ) {
+      const u32 offset = (address - m_itcm.config.base_address) & 0x7FFFu;
+
+      return {&m_itcm.data[offset], m_code_page_versions.arm9_itcm.Get(offset)};
+    }
+
+    if(
+      bus == Bus::Data && m_dtcm.config.writable &&
+      address >= m_dtcm.config.base_address &&
+      address <= m_dtcm.config.high_address
+    ) {
+      return {&m_dtcm.data[(address - m_dtcm.config.base_address) & 0x3FFFu], &m_dtcm_write_count};
+    }
+
+    switch(address >> 24) {
+      case 0x02: {
+        if(bus == Bus::Data && m_shared_access_monitor.IsWatched(address)) {
+          return {};
+        }
+        return {&m_ewram[address & 0x3FFFFFu], m_code_page_versions.ewram.Get(address & 0x3FFFFFu)};
+      }
+      case 0x03: {
+        if(!m_swram.arm9.data) {
+          return {};
+        }
+        return {&m_swram.arm9.data[address & m_swram.arm9.mask], m_code_page_versions.swram.Get(m_swram.GetOffset(m_swram.arm9, address))};
+      }
+    }
+
+    // VRAM, PRAM and OAM writes notify the PPUs.
+    return {};
   }
 
-  void MemoryBus::WriteWord(u32 address, u32 value, Bus bus) {
-    Write<u32>(address, value, bus);
+  const u64* MemoryBus::GetCodePageVersion(u32 address) {
+    // @note: this must resolve the address the same way as ReadSlow() does for the code bus.
+    if(
+      m_itcm.config.readable &&
+      address >= m_itcm.config.base_address &&
+      address <= m_itcm.config.high_address
+    ) {
+      return m_code_page_versions.arm9_itcm.Get((address - m_itcm.config.base_address) & 0x7FFFu);
+    }
+
+    switch(address >> 24) {
+      case 0x02: {
+        return m_code_page_versions.ewram.Get(address & 0x3FFFFFu);
+      }
+      case 0x03: {
+        if(!m_swram.arm9.data) {
+          return nullptr;
+        }
+        return m_code_page_versions.swram.Get(m_swram.GetOffset(m_swram.arm9, address));
+      }
+      case 0xFF: {
+        if(address >= 0xFFFF0000u) {
+          return m_code_page_versions.arm9_bios.Get(address & 0x7FFFu);
+        }
+        return nullptr;
+      }
+    }
+
+    // VRAM and the other regions are rarely used for code and writes to them are not counted.
+    return nullptr;
   }
 
 } // namespace dual::nds::arm9
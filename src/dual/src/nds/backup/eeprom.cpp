@@ -4,10 +4,11 @@
 
 namespace dual::nds {
 
-  EEPROM::EEPROM(const std::string& save_path, Size size_hint, bool fram)
+  EEPROM::EEPROM(const std::string& save_path, Size size_hint, bool fram, bool write_back)
       : m_save_path(save_path)
       , m_size_hint(size_hint)
-      , m_fram(fram) {
+      , m_fram(fram)
+      , m_write_back(write_back) {
     Reset();
   }
 
@@ -16,7 +17,7 @@ namespace dual::nds {
       8192, 32768, 65536, 131072
     };
 
-    m_file = BackupFile::OpenOrCreate(m_save_path, k_backup_sizes, k_backup_sizes[(int)m_size_hint]);
+    m_file = BackupFile::OpenOrCreate(m_save_path, k_backup_sizes, k_backup_sizes[(int)m_size_hint], m_write_back);
 
     const size_t save_size = m_file->Size();
 
@@ -68,6 +69,26 @@ namespace dual::nds {
     m_status_reg_write_disable = false;
   }
 
+  void EEPROM::SaveState(StateWriter& state) const {
+    state.Write(m_state);
+    state.Write(m_current_cmd);
+    state.Write(m_address);
+    state.Write(m_write_enable_latch);
+    state.Write(m_write_protect_mode);
+    state.Write(m_status_reg_write_disable);
+    m_file->SaveState(state);
+  }
+
+  void EEPROM::LoadState(StateReader& state) {
+    state.Read(m_state);
+    state.Read(m_current_cmd);
+    state.Read(m_address);
+    state.Read(m_write_enable_latch);
+    state.Read(m_write_protect_mode);
+    state.Read(m_status_reg_write_disable);
+    m_file->LoadState(state);
+  }
+
   void EEPROM::Select() {
     if(m_state == State::Deselected) {
       m_state = State::ReceiveCommand;
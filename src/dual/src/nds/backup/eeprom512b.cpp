@@ -4,21 +4,40 @@
 
 namespace dual::nds {
 
-  EEPROM512B::EEPROM512B(const std::string& save_path)
-      : m_save_path(save_path) {
+  EEPROM512B::EEPROM512B(const std::string& save_path, bool write_back)
+      : m_save_path(save_path)
+      , m_write_back(write_back) {
     Reset();
   }
 
   void EEPROM512B::Reset() {
     static const std::vector<size_t> k_backup_sizes { 512 };
 
-    m_file = BackupFile::OpenOrCreate(m_save_path, k_backup_sizes, 512);
+    m_file = BackupFile::OpenOrCreate(m_save_path, k_backup_sizes, 512, m_write_back);
     Deselect();
 
     m_write_enable_latch = false;
     m_write_protect_mode = 0;
   }
 
+  void EEPROM512B::SaveState(StateWriter& state) const {
+    state.Write(m_state);
+    state.Write(m_current_cmd);
+    state.Write(m_address);
+    state.Write(m_write_enable_latch);
+    state.Write(m_write_protect_mode);
+    m_file->SaveState(state);
+  }
+
+  void EEPROM512B::LoadState(StateReader& state) {
+    state.Read(m_state);
+    state.Read(m_current_cmd);
+    state.Read(m_address);
+    state.Read(m_write_enable_latch);
+    state.Read(m_write_protect_mode);
+    m_file->LoadState(state);
+  }
+
   void EEPROM512B::Select() {
     if(m_state == State::Deselected) {
       m_state = State::ReceiveCommand;
@@ -11,9 +11,10 @@
 
 namespace dual::nds {
 
-  FLASH::FLASH(const std::string& save_path, Size size_hint)
+  FLASH::FLASH(const std::string& save_path, Size size_hint, bool write_back)
       : m_save_path(save_path)
-      , m_size_hint(size_hint) {
+      , m_size_hint(size_hint)
+      , m_write_back(write_back) {
     Reset();
   }
 
@@ -22,7 +23,7 @@ namespace dual::nds {
       0x40000, 0x80000, 0x100000
     };
 
-    m_file = BackupFile::OpenOrCreate(m_save_path, k_backup_sizes, k_backup_sizes[static_cast<int>(m_size_hint)]);
+    m_file = BackupFile::OpenOrCreate(m_save_path, k_backup_sizes, k_backup_sizes[static_cast<int>(m_size_hint)], m_write_back);
     m_mask = m_file->Size() - 1U;
     Deselect();
 
@@ -30,6 +31,24 @@ namespace dual::nds {
     m_deep_power_down = false;
   }
 
+  void FLASH::SaveState(StateWriter& state) const {
+    state.Write(m_state);
+    state.Write(m_current_cmd);
+    state.Write(m_address);
+    state.Write(m_write_enable_latch);
+    state.Write(m_deep_power_down);
+    m_file->SaveState(state);
+  }
+
+  void FLASH::LoadState(StateReader& state) {
+    state.Read(m_state);
+    state.Read(m_current_cmd);
+    state.Read(m_address);
+    state.Read(m_write_enable_latch);
+    state.Read(m_deep_power_down);
+    m_file->LoadState(state);
+  }
+
   void FLASH::Select() {
     if(m_state == State::Deselected) {
       m_state = State::ReceiveCommand;
@@ -0,0 +1,54 @@
+#include <algorithm>
+#include <atomic>
+#include <dual/nds/batch_runner.hpp>
+
+namespace dual::nds {
+
+  BatchRunner::BatchRunner(int thread_count) : m_thread_pool{thread_count} {
+  }
+
+  BatchRunner::~BatchRunner() {
+    for(NDS* nds : m_instances) nds->SetThreadPool(nullptr);
+  }
+
+  void BatchRunner::Add(NDS* nds) {
+    if(std::find(m_instances.begin(), m_instances.end(), nds) != m_instances.end()) {
+      return;
+    }
+
+    nds->SetThreadPool(&m_thread_pool);
+    m_instances.push_back(nds);
+  }
+
+  void BatchRunner::Remove(NDS* nds) {
+    const auto match = std::find(m_instances.begin(), m_instances.end(), nds);
+
+    if(match != m_instances.end()) {
+      nds->SetThreadPool(nullptr);
+      m_instances.erase(match);
+    }
+  }
+
+  u64 BatchRunner::RunFrames(int frames, const std::function<void(NDS& nds, int frame)>& frame_callback) {
+    std::atomic<u64> cycles{};
+
+    // @note: each system runs all of its frames in one go, which keeps it on the same worker and thus in the same cache.
+    m_thread_pool.ParallelFor((int)m_instances.size(), [&](int index) {
+      NDS& nds = *m_instances[index];
+      u64 nds_cycles = 0u;
+
+      for(int frame = 0; frame < frames; frame++) {
+        nds_cycles += nds.RunFrame();
+
+        if(frame_callback) {
+          frame_callback(nds, frame);
+        }
+      }
+
+      cycles += nds_cycles;
+    });
+
+    return cycles;
+  }
+
+} // namespace dual::nds
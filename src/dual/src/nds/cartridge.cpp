@@ -27,6 +27,48 @@ namespace dual::nds {
     m_romctrl = {};
     m_cardcmd = {};
     m_transfer = {};
+
+    m_scheduler.Register<&Cartridge::HandleCommand>(&m_command_event, this);
+    m_scheduler.Register<&Cartridge::OnDataReady>(&m_data_ready_event, this);
+  }
+
+  void Cartridge::SaveState(StateWriter& state) const {
+    state.Write(m_data_mode);
+    state.Write(m_auxspicnt);
+    state.Write(m_auxspidata);
+    state.Write(m_romctrl);
+    state.Write(m_cardcmd);
+
+    // Only the part of the transfer buffer that is in use is saved.
+    state.Write(m_transfer.index);
+    state.Write(m_transfer.count);
+    state.Write(m_transfer.data_count);
+    state.WriteBytes(m_transfer.data, m_transfer.data_count * sizeof(u32));
+
+    if(m_backup) {
+      m_backup->SaveState(state);
+    }
+  }
+
+  void Cartridge::LoadState(StateReader& state) {
+    state.Read(m_data_mode);
+    state.Read(m_auxspicnt);
+    state.Read(m_auxspidata);
+    state.Read(m_romctrl);
+    state.Read(m_cardcmd);
+
+    state.Read(m_transfer.index);
+    state.Read(m_transfer.count);
+    state.Read(m_transfer.data_count);
+
+    if(m_transfer.data_count < 0 || m_transfer.data_count > (int)std::size(m_transfer.data)) {
+      ATOM_PANIC("Cartridge: bad transfer size in save state: {}", m_transfer.data_count);
+    }
+    state.ReadBytes(m_transfer.data, m_transfer.data_count * sizeof(u32));
+
+    if(m_backup) {
+      m_backup->LoadState(state);
+    }
   }
 
   void Cartridge::DirectBoot() {
@@ -95,9 +137,7 @@ namespace dual::nds {
 
       const int transfer_duration = k_cycles_per_byte[m_romctrl.transfer_clk_rate] * 8;
 
-      m_scheduler.Add(transfer_duration, [this](int _) {
-        HandleCommand();
-      });
+      m_scheduler.Reschedule(&m_command_event, transfer_duration);
     }
   }
 
@@ -139,23 +179,26 @@ namespace dual::nds {
         for(auto irq : m_irq) irq->Request(IRQ::Source::Cart_DataReady);
       }
     } else {
-      m_scheduler.Add(k_cycles_per_byte[m_romctrl.transfer_clk_rate] * 4, [this](int _) {
-        m_romctrl.data_ready = true;
-
-        // if(exmemcnt.nds_slot_access == EXMEMCNT::CPU::ARM7) {
-        //   dma7.Request(DMA7::Time::Slot1);
-        // } else {
-        //  dma9.Request(DMA9::Time::Slot1);
-        //  }
-        m_dma9.Request(arm9::DMA::StartTime::Slot1);
-        m_dma7.Request(arm7::DMA::StartTime::Slot1);
-      });
+      m_scheduler.Reschedule(&m_data_ready_event, k_cycles_per_byte[m_romctrl.transfer_clk_rate] * 4);
     }
 
     return data;
   }
 
-  void Cartridge::HandleCommand() {
+  void Cartridge::OnDataReady(int cycles_late) {
+    m_romctrl.data_ready = true;
+
+    // @todo
+    // if(exmemcnt.nds_slot_access == EXMEMCNT::CPU::ARM7) {
+    //   dma7.Request(DMA7::Time::Slot1);
+    // } else {
+    //   dma9.Request(DMA9::Time::Slot1);
+    // }
+    m_dma9.Request(arm9::DMA::StartTime::Slot1);
+    m_dma7.Request(arm7::DMA::StartTime::Slot1);
+  }
+
+  void Cartridge::HandleCommand(int cycles_late) {
     const auto Unhandled = [this]() {
       const u8* cmd = m_cardcmd.byte;
 
@@ -330,18 +373,7 @@ namespace dual::nds {
     m_romctrl.busy = m_transfer.data_count != 0;
 
     if(m_romctrl.busy) {
-      m_scheduler.Add(k_cycles_per_byte[m_romctrl.transfer_clk_rate] * 4, [this](int late) {
-        m_romctrl.data_ready = true;
-
-        // @todo
-        // if(exmemcnt.nds_slot_access == EXMEMCNT::CPU::ARM7) {
-        //   dma7.Request(DMA7::Time::Slot1);
-        // } else {
-        //   dma9.Request(DMA9::Time::Slot1);
-        // }
-        m_dma9.Request(arm9::DMA::StartTime::Slot1);
-        m_dma7.Request(arm7::DMA::StartTime::Slot1);
-      });
+      m_scheduler.Reschedule(&m_data_ready_event, k_cycles_per_byte[m_romctrl.transfer_clk_rate] * 4);
     } else if(m_auxspicnt.enable_transfer_ready_irq) {
       // @todo
       // if(exmemcnt.nds_slot_access == EXMEMCNT::CPU::ARM7) {
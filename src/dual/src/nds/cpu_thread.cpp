@@ -0,0 +1,105 @@
+
+#include <dual/common/tracer.hpp>
+
+#include "cpu_thread.hpp"
+
+namespace dual::nds {
+
+  // Set on the ARM7 thread, which lets OnSharedAccess() tell apart accesses from the ARM7 thread and from the emulator thread.
+  static thread_local bool t_is_cpu_thread = false;
+
+  CPUThread::CPUThread(Profiler& profiler) : m_profiler{profiler} {
+    m_thread = std::thread{&CPUThread::ThreadMain, this};
+  }
+
+  CPUThread::~CPUThread() {
+    m_quit = true;
+    m_slice_id.fetch_add(1u, std::memory_order_release);
+    m_slice_id.notify_one();
+    m_thread.join();
+  }
+
+  void CPUThread::BeginSlice(arm::CPU* cpu, int cycles) {
+    m_cpu = cpu;
+    m_cycles = cycles;
+    m_arm9_done.store(false, std::memory_order_relaxed);
+    m_state.store(State::Running, std::memory_order_relaxed);
+
+    m_slice_id.fetch_add(1u, std::memory_order_release);
+    m_slice_id.notify_one();
+  }
+
+  void CPUThread::EndSlice() {
+    DUAL_TRACE_SCOPE("CPUThread::EndSlice");
+
+    m_arm9_done.store(true, std::memory_order_release);
+
+    SpinWait([this]() {
+      return m_state.load(std::memory_order_acquire) == State::Done;
+    });
+
+    m_state.store(State::Idle, std::memory_order_relaxed);
+  }
+
+  void CPUThread::OnSharedAccess(CPU cpu) {
+    if(cpu == CPU::ARM7) {
+      // Accesses from the emulator thread happen outside of slices (i.e. from events) and need no synchronization.
+      if(!t_is_cpu_thread || m_arm9_done.load(std::memory_order_acquire)) {
+        return;
+      }
+
+      m_state.store(State::Waiting, std::memory_order_release);
+
+      SpinWait([this]() {
+        return m_arm9_done.load(std::memory_order_acquire);
+      });
+
+      m_state.store(State::Running, std::memory_order_relaxed);
+    } else {
+      SpinWait([this]() {
+        return m_state.load(std::memory_order_acquire) != State::Running;
+      });
+    }
+  }
+
+  template<typename Predicate>
+  void CPUThread::SpinWait(Predicate predicate) {
+    // @note: slices are only a few microseconds long, so waiting on an OS primitive would be much too slow.
+    for(int i = 0; !predicate(); i++) {
+      if(i >= 256) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  void CPUThread::ThreadMain() {
+    u64 slice_id = 0u;
+
+    t_is_cpu_thread = true;
+
+    Tracer::SetThreadName("ARM7");
+
+    while(true) {
+      for(int i = 0; m_slice_id.load(std::memory_order_acquire) == slice_id; i++) {
+        // Sleep while the emulator thread is idle (i.e. throttled or paused)
+        if(i >= 4096) {
+          m_slice_id.wait(slice_id, std::memory_order_acquire);
+        }
+      }
+
+      slice_id = m_slice_id.load(std::memory_order_acquire);
+
+      if(m_quit) {
+        break;
+      }
+
+      {
+        DUAL_PROFILE_SCOPE(m_profiler, Profiler::Zone::ARM7);
+        m_cpu->Run(m_cycles);
+      }
+
+      m_state.store(State::Done, std::memory_order_release);
+    }
+  }
+
+} // namespace dual::nds
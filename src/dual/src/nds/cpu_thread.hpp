@@ -0,0 +1,56 @@
+
+#pragma once
+
+#include <atomic>
+#include <atom/integer.hpp>
+#include <dual/arm/cpu.hpp>
+#include <dual/common/profiler.hpp>
+#include <dual/nds/enums.hpp>
+#include <thread>
+
+namespace dual::nds {
+
+  /**
+   * Runs the ARM7 on its own host thread, one slice at a time, while the ARM9 runs the same slice on the calling thread.
+   *
+   * During a slice the ARM7 may only touch state that is private to it.
+   * Before it touches state which the ARM9 can modify, it waits until the ARM9 has finished the slice.
+   * Before the ARM9 touches state which the ARM7 can observe, it waits until the ARM7 has either finished the slice
+   * or is waiting to touch shared state itself. Neither of these points depends on host timing, so that the emulation stays deterministic.
+   */
+  class CPUThread {
+    public:
+      explicit CPUThread(Profiler& profiler);
+     ~CPUThread();
+
+      void BeginSlice(arm::CPU* cpu, int cycles);
+      void EndSlice();
+
+      void OnSharedAccess(CPU cpu);
+
+    private:
+      enum class State : int {
+        Idle,
+        Running,
+        Waiting,
+        Done
+      };
+
+      template<typename Predicate>
+      static void SpinWait(Predicate predicate);
+
+      void ThreadMain();
+
+      std::thread m_thread{};
+      std::atomic_bool m_quit{};
+      std::atomic<u64> m_slice_id{};
+      std::atomic<State> m_state{State::Idle};
+      std::atomic_bool m_arm9_done{true};
+
+      arm::CPU* m_cpu{};
+      int m_cycles{};
+
+      Profiler& m_profiler;
+  };
+
+} // namespace dual::nds
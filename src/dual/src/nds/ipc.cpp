@@ -4,7 +4,7 @@
 
 namespace dual::nds {
 
-  IPC::IPC(IRQ& irq9, IRQ& irq7) {
+  IPC::IPC(IRQ& irq9, IRQ& irq7, SharedAccessMonitor& shared_access_monitor) : m_shared_access_monitor{shared_access_monitor} {
     m_irq[(int)CPU::ARM9] = &irq9;
     m_irq[(int)CPU::ARM7] = &irq7;
   }
@@ -14,13 +14,26 @@ namespace dual::nds {
     for(auto& fifo : m_fifo) fifo = {};
   }
 
+  void IPC::SaveState(StateWriter& state) const {
+    state.Write(m_sync);
+    state.Write(m_fifo);
+  }
+
+  void IPC::LoadState(StateReader& state) {
+    state.Read(m_sync);
+    state.Read(m_fifo);
+  }
+
   u32 IPC::Read_SYNC(CPU cpu) {
+    m_shared_access_monitor.Sync(cpu);
     return m_sync[(int)cpu].word;
   }
 
   void IPC::Write_SYNC(CPU cpu, u32 value, u32 mask) {
     const u32 write_mask = 0x4F00u & mask;
 
+    m_shared_access_monitor.Sync(cpu);
+
     auto& sync_tx = m_sync[(int) cpu];
     auto& sync_rx = m_sync[(int)~cpu];
 
@@ -36,6 +49,8 @@ namespace dual::nds {
     const auto& fifo_tx = m_fifo[(int) cpu];
     const auto& fifo_rx = m_fifo[(int)~cpu];
 
+    m_shared_access_monitor.Sync(cpu);
+
     u32 word = fifo_tx.control.word;
 
     word |= fifo_tx.send.IsEmpty() ?   1u : 0u;
@@ -49,6 +64,8 @@ namespace dual::nds {
   void IPC::Write_FIFOCNT(CPU cpu, u32 value, u32 mask) {
     const u32 write_mask = 0x8404u & mask;
 
+    m_shared_access_monitor.Sync(cpu);
+
     auto& fifo_tx = m_fifo[(int) cpu];
     auto& fifo_rx = m_fifo[(int)~cpu];
 
@@ -80,6 +97,8 @@ namespace dual::nds {
     auto& fifo_tx = m_fifo[(int) cpu];
     auto& fifo_rx = m_fifo[(int)~cpu];
 
+    m_shared_access_monitor.Sync(cpu);
+
     if(!fifo_tx.control.enable) {
       ATOM_ERROR("{}: IPC: attempted to read FIFO but FIFOs are disabled", cpu);
       return fifo_rx.send.Peek();
@@ -104,6 +123,8 @@ namespace dual::nds {
     auto& fifo_tx = m_fifo[(int) cpu];
     auto& fifo_rx = m_fifo[(int)~cpu];
 
+    m_shared_access_monitor.Sync(cpu);
+
     if(!fifo_tx.control.enable) {
       ATOM_ERROR("{}: IPC: attempted to write FIFO but FIFOs are disabled", cpu);
       return;
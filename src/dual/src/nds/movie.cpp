@@ -0,0 +1,92 @@
+#include <dual/common/save_state.hpp>
+#include <dual/nds/movie.hpp>
+#include <fstream>
+#include <iterator>
+
+namespace dual::nds {
+
+  static constexpr u32 k_movie_magic = 0x564F4D44u; // "DMOV"
+  static constexpr u32 k_movie_version = 1u;
+
+  bool Movie::Save(const std::string& path) const {
+    std::vector<u8> data{};
+    StateWriter writer{data};
+
+    writer.Write(k_movie_magic);
+    writer.Write(k_movie_version);
+    writer.Write(rom_game_code);
+    writer.Write(rom_header_crc);
+    writer.Write(start_timestamp);
+
+    writer.Write((u32)inputs.size());
+
+    // @note: the fields are written one by one, so that the file does not contain any padding bytes.
+    for(const Input& input : inputs) {
+      writer.Write(input.timestamp);
+      writer.Write(input.type);
+      writer.Write(input.key);
+      writer.Write((u8)input.pressed);
+      writer.Write(input.x);
+      writer.Write(input.y);
+    }
+
+    writer.Write((u32)frame_hashes.size());
+    writer.WriteBytes(frame_hashes.data(), frame_hashes.size() * sizeof(u64));
+
+    std::ofstream file{path, std::ios::binary | std::ios::trunc};
+
+    if(!file.good()) {
+      return false;
+    }
+
+    file.write((const char*)data.data(), (std::streamsize)data.size());
+    return file.good();
+  }
+
+  bool Movie::Load(const std::string& path) {
+    std::ifstream file{path, std::ios::binary};
+
+    if(!file.good()) {
+      return false;
+    }
+
+    const std::vector<u8> data{std::istreambuf_iterator<char>{file}, {}};
+    StateReader reader{data};
+
+    if(reader.Read<u32>() != k_movie_magic || reader.Read<u32>() != k_movie_version) {
+      return false;
+    }
+
+    reader.Read(rom_game_code);
+    reader.Read(rom_header_crc);
+    reader.Read(start_timestamp);
+
+    const u32 input_count = reader.Read<u32>();
+
+    inputs.clear();
+
+    for(u32 i = 0; i < input_count && reader.Good(); i++) {
+      Input input{};
+
+      reader.Read(input.timestamp);
+      reader.Read(input.type);
+      reader.Read(input.key);
+      input.pressed = reader.Read<u8>() != 0u;
+      reader.Read(input.x);
+      reader.Read(input.y);
+      inputs.push_back(input);
+    }
+
+    const u32 frame_count = reader.Read<u32>();
+
+    if(!reader.Good() || frame_count > data.size() / sizeof(u64)) {
+      return false;
+    }
+
+    frame_hashes.resize(frame_count);
+    reader.ReadBytes(frame_hashes.data(), frame_count * sizeof(u64));
+
+    return reader.Good() && reader.AtEnd();
+  }
+
+} // namespace dual::nds
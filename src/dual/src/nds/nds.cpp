@@ -1,22 +1,37 @@
 
 #include <algorithm>
 #include <atom/punning.hpp>
+#include <bit>
+#include <cstring>
+#include <dual/common/tracer.hpp>
 #include <dual/nds/arm7/touch_screen.hpp>
 #include <dual/nds/nds.hpp>
 #include <dual/nds/header.hpp>
 #include <dual/nds/backup/eeprom.hpp>
 
 #include "arm/interpreter/interpreter_cpu.hpp"
+#include "nds/cpu_thread.hpp"
 #ifdef DUAL_ENABLE_JIT
   #include "arm/jit/lunatic_cpu.hpp"
 #endif
 
+namespace dual::arm {
+
+  // @note: these are instantiated in nds/arm9/interpreter_cpu.cpp and nds/arm7/interpreter_cpu.cpp.
+  extern template class InterpreterCPU<nds::arm9::MemoryBus>;
+  extern template class InterpreterCPU<nds::arm7::MemoryBus>;
+
+} // namespace dual::arm
+
 namespace dual::nds {
 
   NDS::NDS() {
+    m_scheduler.SetProfiler(&m_profiler);
     m_arm9.cp15 = std::make_unique<arm9::CP15>(&m_arm9.bus);
   }
 
+  NDS::~NDS() = default;
+
   void NDS::SetCPUExecutionEngine(CPUExecutionEngine cpu_execution_engine) {
     m_cpu_execution_engine = cpu_execution_engine;
   }
@@ -66,7 +81,18 @@ namespace dual::nds {
 
     m_ipc.Reset();
 
+    m_shared_access_monitor.Reset();
+
     m_step_target = 0u;
+
+    StopMovie();
+
+    m_quantum_stats = {};
+    m_quantum_stats.quantum = m_quantum_policy.min_cycles;
+    m_quiet_slices = 0;
+
+    UpdateSyncCallbacks();
+    UpdateIdleLoopDetection();
   }
 
   void NDS::CreateCPUCores() {
@@ -74,14 +100,14 @@ namespace dual::nds {
 
     switch(m_cpu_execution_engine) {
       case CPUExecutionEngine::Interpreter: {
-        m_arm9.cpu = std::make_unique<arm::InterpreterCPU>(m_arm9.bus, m_scheduler, m_arm9.cycle_counter, arm::CPU::Model::ARM9, std::span<const arm::AttachCPn>{{attach_cp15}});
-        m_arm7.cpu = std::make_unique<arm::InterpreterCPU>(m_arm7.bus, m_scheduler, m_arm7.cycle_counter, arm::CPU::Model::ARM7);
+        m_arm9.cpu = std::make_unique<arm::InterpreterCPU<arm9::MemoryBus>>(m_arm9.bus, m_scheduler, m_arm9.cycle_counter, arm::CPU::Model::ARM9, std::span<const arm::AttachCPn>{{attach_cp15}});
+        m_arm7.cpu = std::make_unique<arm::InterpreterCPU<arm7::MemoryBus>>(m_arm7.bus, m_scheduler, m_arm7.cycle_counter, arm::CPU::Model::ARM7);
         break;
       }
 #ifdef DUAL_ENABLE_JIT
       case CPUExecutionEngine::JIT: {
-        m_arm9.cpu = std::make_unique<arm::LunaticCPU>(m_arm9.bus, m_arm9.cycle_counter, arm::CPU::Model::ARM9, std::span<const arm::AttachCPn>{{attach_cp15}});
-        m_arm7.cpu = std::make_unique<arm::LunaticCPU>(m_arm7.bus, m_arm7.cycle_counter, arm::CPU::Model::ARM7);
+        m_arm9.cpu = std::make_unique<arm::LunaticCPU>(m_arm9.bus, m_scheduler, m_arm9.cycle_counter, arm::CPU::Model::ARM9, std::span<const arm::AttachCPn>{{attach_cp15}});
+        m_arm7.cpu = std::make_unique<arm::LunaticCPU>(m_arm7.bus, m_scheduler, m_arm7.cycle_counter, arm::CPU::Model::ARM7);
         break;
       }
 #endif
@@ -93,32 +119,282 @@ namespace dual::nds {
   }
 
   void NDS::Step(int cycles_to_run) {
+    DUAL_TRACE_SCOPE("NDS::Step");
+
     const u64 step_target = m_step_target + cycles_to_run;
+    const bool catch_up = IsCatchUpEnabled();
+    const bool threaded_arm7 = IsThreadedARM7Enabled();
 
     while(m_scheduler.GetTimestampNow() < step_target) {
-      const u64 target = std::min(m_scheduler.GetTimestampTarget(), step_target);
+      // Apply the movie input in between two slices, which is where the frontend applied it while recording.
+      if(m_scheduler.GetTimestampNow() >= m_movie_next_timestamp) [[unlikely]] {
+        ApplyMovieInput();
+      }
+
+      /**
+       * @note: the slice is not clamped to the step target, otherwise the slices (and thus the emulation)
+       * would depend on the amount of cycles the frontend steps the emulator by. The excess is carried over into the next step.
+       */
+      const u64 target = m_scheduler.GetTimestampTarget();
 
-      // Run both CPUs for up to 32 cycles. Skip to the next event if both CPUs are halting.
+      const bool arm9_halted = m_arm9.cpu->GetWaitingForIRQ();
+      const bool arm7_halted = m_arm7.cpu->GetWaitingForIRQ();
+
+      // Run both CPUs for up to one quantum. Skip to the next event if both CPUs are halting.
       int cycles = static_cast<int>(target - m_scheduler.GetTimestampNow());
-      if(!m_arm9.cpu->GetWaitingForIRQ() || !m_arm7.cpu->GetWaitingForIRQ()) {
-        cycles = std::min(cycles, 32);
+
+      m_quantum_stats.slices++;
+
+      if(arm9_halted && arm7_halted) {
+        m_quantum_stats.idle_slices++;
+      } else if((arm9_halted || arm7_halted) && m_quantum_policy.skip_halted_cpu) {
+        m_quantum_stats.single_cpu_slices++;
+      } else if(!catch_up) {
+        cycles = std::min(cycles, m_quantum_stats.quantum);
       }
 
-      m_arm9.cpu->Run(cycles * 2);
-      m_arm7.cpu->Run(cycles);
+      const u64 shared_access_count = m_shared_access_monitor.GetAccessCount();
+      const u64 slice_end = m_scheduler.GetTimestampNow() + cycles;
+
+      /**
+       * A halted CPU can only be woken up by an IRQ, which is raised either by an event or by the other CPU.
+       * Run the awake CPU first, so that the halted CPU sees a wake-up from it within the same slice.
+       * When catching up, the second CPU may already have run for a part of the slice.
+       */
+      if(threaded_arm7 && !arm9_halted && !arm7_halted) {
+        // Run the ARM7 on its own thread, it synchronizes with the ARM9 via the shared access monitor.
+        m_arm7_thread->BeginSlice(m_arm7.cpu.get(), cycles);
+        RunCPU(CPU::ARM9, slice_end);
+        m_arm7_thread->EndSlice();
+
+        m_quantum_stats.cpu_runs++;
+        m_quantum_stats.parallel_slices++;
+      } else if(arm9_halted) {
+        RunCPU(CPU::ARM7, slice_end);
+        RunCPU(CPU::ARM9, slice_end);
+      } else {
+        RunCPU(CPU::ARM9, slice_end);
+        RunCPU(CPU::ARM7, slice_end);
+      }
 
       m_scheduler.AddCycles(cycles);
+
+      m_quantum_stats.cycles += cycles;
+
+      UpdateQuantum(m_shared_access_monitor.GetAccessCount() != shared_access_count);
+
+      // The video unit began the scanline that RunUntil() waits for.
+      if(m_video_unit.GetBreakLineReached()) [[unlikely]] {
+        m_step_target = m_scheduler.GetTimestampNow();
+        return;
+      }
     }
 
     m_step_target = step_target;
   }
 
+  u64 NDS::RunFrame() {
+    return RunUntil(RunTarget::Scanline(0));
+  }
+
+  u64 NDS::RunUntil(RunTarget target) {
+    // A frame lasts 263 scanlines of 2130 cycles each, so the target line is reached within a single frame.
+    constexpr int k_cycles_per_frame = 560190;
+
+    if(target.line < 0 || target.line >= VideoUnit::k_total_lines) {
+      ATOM_PANIC("bad scanline: {}", target.line);
+    }
+
+    const u64 timestamp_begin = m_scheduler.GetTimestampNow();
+
+    m_video_unit.SetBreakLine(target.line);
+
+    while(!m_video_unit.GetBreakLineReached()) {
+      Step(k_cycles_per_frame);
+    }
+
+    m_video_unit.ClearBreakLine();
+
+    return m_scheduler.GetTimestampNow() - timestamp_begin;
+  }
+
+  bool NDS::RunCPU(CPU cpu, u64 timestamp) {
+    const u64 timestamp_now = cpu == CPU::ARM9 ? m_arm9.cycle_counter.GetTimestampNow() : m_arm7.cycle_counter.GetTimestampNow();
+
+    if(timestamp_now >= timestamp) {
+      return false;
+    }
+
+    const int cycles = static_cast<int>(timestamp - timestamp_now);
+
+    if(cpu == CPU::ARM9) {
+      DUAL_PROFILE_SCOPE(m_profiler, Profiler::Zone::ARM9);
+      m_arm9.cpu->Run(cycles * 2);
+    } else {
+      DUAL_PROFILE_SCOPE(m_profiler, Profiler::Zone::ARM7);
+      m_arm7.cpu->Run(cycles);
+    }
+
+    m_quantum_stats.cpu_runs++;
+    return true;
+  }
+
+  void NDS::CatchUp(CPU cpu) {
+    /**
+     * The CPU which is about to access shared state is ahead of the other CPU.
+     * Run the other CPU up to the current time of the accessing CPU, so that the access observes its side effects.
+     * While catching up, the lagging CPU may access shared state too, but then the other CPU is ahead already.
+     */
+    if(cpu == CPU::ARM9) {
+      if(RunCPU(CPU::ARM7, m_arm9.cycle_counter.GetTimestampNow())) {
+        m_quantum_stats.catch_ups++;
+      }
+    } else {
+      if(RunCPU(CPU::ARM9, m_arm7.cycle_counter.GetTimestampNow())) {
+        m_quantum_stats.catch_ups++;
+      }
+    }
+  }
+
+  bool NDS::IsCatchUpEnabled() const {
+    // @note: the JIT only updates the cycle counter after it ran, so the other CPU could not catch up with it.
+    return m_quantum_policy.catch_up && m_cpu_execution_engine == CPUExecutionEngine::Interpreter;
+  }
+
+  bool NDS::IsThreadedARM7Enabled() const {
+    // @note: the interpreter checks the scheduler after every instruction, which the ARM9 may modify while the ARM7 runs.
+    return m_quantum_policy.threaded_arm7 && m_cpu_execution_engine == CPUExecutionEngine::JIT;
+  }
+
+  void NDS::UpdateSyncCallbacks() {
+    if(IsCatchUpEnabled()) {
+      m_shared_access_monitor.SetSyncCallback([](void* nds, CPU cpu) {
+        ((NDS*)nds)->CatchUp(cpu);
+      }, this);
+    } else {
+      m_shared_access_monitor.SetSyncCallback(nullptr, nullptr);
+    }
+
+    if(IsThreadedARM7Enabled()) {
+      if(!m_arm7_thread) {
+        m_arm7_thread = std::make_unique<CPUThread>(m_profiler);
+      }
+
+      m_shared_access_monitor.SetThreadSyncCallback([](void* cpu_thread, CPU cpu) {
+        ((CPUThread*)cpu_thread)->OnSharedAccess(cpu);
+      }, m_arm7_thread.get());
+    } else {
+      m_shared_access_monitor.SetThreadSyncCallback(nullptr, nullptr);
+      m_arm7_thread.reset();
+    }
+  }
+
+  void NDS::UpdateIdleLoopDetection() {
+    if(!m_arm9.cpu) {
+      return;
+    }
+
+    // @note: the ARM7 thread must not read the scheduler, because the ARM9 may modify it at the same time.
+    m_arm9.cpu->GetIdleLoopDetector().SetEnable(m_quantum_policy.skip_idle_loops);
+    m_arm7.cpu->GetIdleLoopDetector().SetEnable(m_quantum_policy.skip_idle_loops && !IsThreadedARM7Enabled());
+  }
+
+  void NDS::UpdateQuantum(bool shared_access) {
+    if(shared_access) {
+      m_quantum_stats.shared_slices++;
+    }
+
+    if(!m_quantum_policy.adaptive) {
+      return;
+    }
+
+    // Fall back to the shortest quantum as soon as the CPUs communicate and slowly grow it again once they stop.
+    if(shared_access) {
+      m_quantum_stats.quantum = m_quantum_policy.min_cycles;
+      m_quiet_slices = 0;
+    } else if(++m_quiet_slices >= m_quantum_policy.grow_after) {
+      m_quantum_stats.quantum = std::min(m_quantum_stats.quantum * 2, m_quantum_policy.max_cycles);
+      m_quiet_slices = 0;
+    }
+  }
+
+  void NDS::SetQuantumPolicy(const QuantumPolicy& policy) {
+    if(policy.min_cycles < 1 || policy.max_cycles < policy.min_cycles || policy.grow_after < 1) {
+      ATOM_PANIC("bad quantum policy (min_cycles={}, max_cycles={}, grow_after={})", policy.min_cycles, policy.max_cycles, policy.grow_after);
+    }
+
+    m_quantum_policy = policy;
+    m_quantum_stats.quantum = policy.min_cycles;
+    m_quiet_slices = 0;
+
+    UpdateSyncCallbacks();
+    UpdateIdleLoopDetection();
+  }
+
+  void NDS::ResetQuantumStats() {
+    m_quantum_stats = {.quantum = m_quantum_stats.quantum};
+  }
+
+  const arm::IdleLoopStats& NDS::GetIdleLoopStats(CPU cpu) const {
+    if(cpu == CPU::ARM9) {
+      return m_arm9.cpu->GetIdleLoopDetector().GetStats();
+    }
+    return m_arm7.cpu->GetIdleLoopDetector().GetStats();
+  }
+
+  u64 NDS::GetRetiredInstructions(CPU cpu) const {
+    if(cpu == CPU::ARM9) {
+      return m_arm9.cpu->GetRetiredInstructions();
+    }
+    return m_arm7.cpu->GetRetiredInstructions();
+  }
+
+  Profile NDS::GetProfile() const {
+#ifdef DUAL_ENABLE_PROFILER
+    return m_profiler.GetProfile();
+#else
+    return {};
+#endif
+  }
+
+  void NDS::ResetProfile() {
+#ifdef DUAL_ENABLE_PROFILER
+    m_profiler.Reset();
+#endif
+  }
+
+  size_t NDS::GetMemoryUsage() const {
+    return sizeof(NDS) + m_video_unit.GetLazyMemoryUsage();
+  }
+
+  void NDS::ResetIdleLoopStats() {
+    m_arm9.cpu->GetIdleLoopDetector().ResetStats();
+    m_arm7.cpu->GetIdleLoopDetector().ResetStats();
+  }
+
+  void NDS::AddSyncWatchRegion(u32 address, u32 size) {
+    m_shared_access_monitor.AddWatchRegion(address, size);
+    m_arm9.bus.OnWatchRegionsChanged();
+  }
+
+  void NDS::ClearSyncWatchRegions() {
+    m_shared_access_monitor.ClearWatchRegions();
+    m_arm9.bus.OnWatchRegionsChanged();
+  }
+
+  void NDS::SetThreadPool(ThreadPool* thread_pool) {
+    m_thread_pool = thread_pool;
+    m_video_unit.SetThreadPool(thread_pool);
+  }
+
   void NDS::LoadBootROM9(std::span<u8, 0x8000> data) {
     std::copy(data.begin(), data.end(), m_memory.arm9.bios.begin());
+    m_memory.code_page_versions.arm9_bios.InvalidateAll();
   }
 
   void NDS::LoadBootROM7(std::span<u8, 0x4000> data) {
     std::copy(data.begin(), data.end(), m_memory.arm7.bios.begin());
+    m_memory.code_page_versions.arm7_bios.InvalidateAll();
   }
 
   void NDS::LoadROM(std::shared_ptr<ROM> rom, std::shared_ptr<dual::nds::arm7::SPI::Device> backup) {
@@ -211,6 +487,9 @@ namespace dual::nds {
     atom::write<u16>(m_memory.ewram.data(), 0x3FFC10u, 0x5835u); // Copy of ARM7 BIOS CRC
     atom::write<u16>(m_memory.ewram.data(), 0x3FFC40u, 0x0001u); // Boot indicator
 
+    // The header and the values above were written into main memory directly.
+    m_memory.code_page_versions.ewram.InvalidateAll();
+
     m_arm9.bus.WriteByte(0x04000300, 1u, dual::arm::Memory::Bus::Data);
     m_arm7.bus.WriteByte(0x04000300, 1u, dual::arm::Memory::Bus::Data);
 
@@ -219,7 +498,156 @@ namespace dual::nds {
     m_video_unit.DirectBoot();
   }
 
+  static constexpr u32 k_save_state_magic = 0x4C415544u; // "DUAL"
+  static constexpr u32 k_save_state_version = 4u;
+
+  void NDS::SaveState(std::vector<u8>& state) {
+    DUAL_TRACE_SCOPE("NDS::SaveState");
+
+    StateWriter writer{state};
+
+    writer.Write(k_save_state_magic);
+    writer.Write(k_save_state_version);
+
+    /**
+     * The large fixed-size parts come first and anything with a variable size (like the scheduler) comes last.
+     * This keeps the big arrays at the same offsets from one state to the next, which the rewind buffer relies on to compress states well.
+     */
+    writer.Write(m_memory.ewram);
+    writer.Write(m_memory.pram);
+    writer.Write(m_memory.oam);
+    writer.Write(m_memory.arm9.dtcm);
+    writer.Write(m_memory.arm9.itcm);
+    writer.Write(m_memory.arm7.iwram);
+    m_memory.swram.SaveState(writer);
+    m_memory.vram.SaveState(writer);
+
+    m_video_unit.SaveState(writer);
+    m_scheduler.SaveState(writer);
+    m_cartridge.SaveState(writer);
+
+    m_arm9.cycle_counter.SaveState(writer);
+    m_arm9.cp15->SaveState(writer);
+    m_arm9.cpu->SaveState(writer);
+    m_arm9.bus.SaveState(writer);
+    m_arm9.irq.SaveState(writer);
+    m_arm9.timer.SaveState(writer);
+    m_arm9.dma.SaveState(writer);
+    m_arm9.math.SaveState(writer);
+
+    m_arm7.cycle_counter.SaveState(writer);
+    m_arm7.cpu->SaveState(writer);
+    m_arm7.bus.SaveState(writer);
+    m_arm7.irq.SaveState(writer);
+    m_arm7.timer.SaveState(writer);
+    m_arm7.dma.SaveState(writer);
+    m_arm7.spi.SaveState(writer);
+    m_arm7.rtc.SaveState(writer);
+    m_arm7.apu.SaveState(writer);
+    m_arm7.wifi.SaveState(writer);
+
+    m_ipc.SaveState(writer);
+
+    writer.Write(m_key_input);
+    writer.Write(m_step_target);
+    writer.Write(m_quantum_stats.quantum);
+    writer.Write(m_quiet_slices);
+  }
+
+  bool NDS::LoadState(std::span<const u8> state) {
+    DUAL_TRACE_SCOPE("NDS::LoadState");
+
+    StateReader reader{state};
+
+    if(reader.Read<u32>() != k_save_state_magic || reader.Read<u32>() != k_save_state_version) {
+      return false;
+    }
+
+    reader.Read(m_memory.ewram);
+    reader.Read(m_memory.pram);
+    reader.Read(m_memory.oam);
+    reader.Read(m_memory.arm9.dtcm);
+    reader.Read(m_memory.arm9.itcm);
+    reader.Read(m_memory.arm7.iwram);
+
+    // The plain memory arrays were copied over directly, so the interpreters must not reuse any instructions they have decoded.
+    m_memory.code_page_versions.InvalidateAll();
+
+    m_memory.swram.LoadState(reader);
+    m_memory.vram.LoadState(reader);
+
+    // @note: the video unit must be loaded after VRAM, PRAM and OAM.
+    m_video_unit.LoadState(reader);
+    m_scheduler.LoadState(reader);
+    m_cartridge.LoadState(reader);
+
+    // @note: the CPUs refill their pipelines from memory, so they are loaded after the memory and the TCM configuration.
+    m_arm9.cycle_counter.LoadState(reader);
+    m_arm9.cp15->LoadState(reader);
+    m_arm9.cpu->LoadState(reader);
+    m_arm9.bus.LoadState(reader);
+    m_arm9.irq.LoadState(reader);
+    m_arm9.timer.LoadState(reader);
+    m_arm9.dma.LoadState(reader);
+    m_arm9.math.LoadState(reader);
+
+    m_arm7.cycle_counter.LoadState(reader);
+    m_arm7.cpu->LoadState(reader);
+    m_arm7.bus.LoadState(reader);
+    m_arm7.irq.LoadState(reader);
+    m_arm7.timer.LoadState(reader);
+    m_arm7.dma.LoadState(reader);
+    m_arm7.spi.LoadState(reader);
+    m_arm7.rtc.LoadState(reader);
+    m_arm7.apu.LoadState(reader);
+    m_arm7.wifi.LoadState(reader);
+
+    m_ipc.LoadState(reader);
+
+    reader.Read(m_key_input);
+    reader.Read(m_step_target);
+    reader.Read(m_quantum_stats.quantum);
+    reader.Read(m_quiet_slices);
+
+    // The system is left in an inconsistent state at this point, so there is no way to recover.
+    if(!reader.Good() || !reader.AtEnd()) {
+      ATOM_PANIC("save state has a bad size ({} bytes)", state.size());
+    }
+
+    // Move the movie to the loaded point in time: the recording forgets the input after it and the playback continues from there.
+    const u64 timestamp_now = m_scheduler.GetTimestampNow();
+
+    if(m_movie_recording) {
+      auto& inputs = m_movie_recording->inputs;
+
+      while(!inputs.empty() && inputs.back().timestamp > timestamp_now) {
+        inputs.pop_back();
+      }
+    }
+
+    if(m_movie_playback) {
+      const auto& inputs = m_movie_playback->inputs;
+
+      m_movie_input_index = std::partition_point(inputs.begin(), inputs.end(), [&](const Movie::Input& input) {
+        return input.timestamp < timestamp_now;
+      }) - inputs.begin();
+
+      m_movie_next_timestamp = m_movie_input_index < inputs.size() ? inputs[m_movie_input_index].timestamp : std::numeric_limits<u64>::max();
+    }
+
+    return true;
+  }
+
   void NDS::SetKeyState(Key key, bool pressed) {
+    if(m_movie_recording) {
+      m_movie_recording->inputs.push_back({
+        .timestamp = m_scheduler.GetTimestampNow(),
+        .type = Movie::InputType::Key,
+        .key = key,
+        .pressed = pressed
+      });
+    }
+
     if(pressed) {
       m_key_input &= ~(1u << (int)key);
     } else {
@@ -228,6 +656,16 @@ namespace dual::nds {
   }
 
   void NDS::SetTouchState(bool pen_down, u8 x, u8 y) {
+    if(m_movie_recording) {
+      m_movie_recording->inputs.push_back({
+        .timestamp = m_scheduler.GetTimestampNow(),
+        .type = Movie::InputType::Touch,
+        .pressed = pen_down,
+        .x = x,
+        .y = y
+      });
+    }
+
     m_arm7.spi.GetTouchScreen().SetTouchState(pen_down, x, y);
 
     if(pen_down) {
@@ -237,4 +675,115 @@ namespace dual::nds {
     }
   }
 
+  void NDS::RecordMovie(Movie* movie) {
+    StopMovie();
+
+    if(!m_rom) {
+      ATOM_PANIC("cannot record a movie without a ROM");
+    }
+
+    u32 game_code;
+    u16 header_crc;
+
+    m_rom->Read((u8*)&game_code, 0x00Cu, sizeof(game_code));
+    m_rom->Read((u8*)&header_crc, 0x15Eu, sizeof(header_crc));
+
+    movie->rom_game_code = game_code;
+    movie->rom_header_crc = header_crc;
+    movie->start_timestamp = m_scheduler.GetTimestampNow();
+    movie->inputs.clear();
+    movie->frame_hashes.clear();
+
+    m_movie_recording = movie;
+  }
+
+  bool NDS::PlayMovie(const Movie* movie) {
+    StopMovie();
+
+    if(!m_rom || movie->start_timestamp != m_scheduler.GetTimestampNow()) {
+      return false;
+    }
+
+    u32 game_code;
+    u16 header_crc;
+
+    m_rom->Read((u8*)&game_code, 0x00Cu, sizeof(game_code));
+    m_rom->Read((u8*)&header_crc, 0x15Eu, sizeof(header_crc));
+
+    if(movie->rom_game_code != game_code || movie->rom_header_crc != header_crc) {
+      return false;
+    }
+
+    m_movie_playback = movie;
+    m_movie_input_index = 0u;
+    m_movie_next_timestamp = movie->inputs.empty() ? std::numeric_limits<u64>::max() : movie->inputs[0].timestamp;
+    return true;
+  }
+
+  void NDS::StopMovie() {
+    m_movie_recording = nullptr;
+    m_movie_playback = nullptr;
+    m_movie_input_index = 0u;
+    m_movie_next_timestamp = std::numeric_limits<u64>::max();
+  }
+
+  void NDS::ApplyMovieInput() {
+    const auto& inputs = m_movie_playback->inputs;
+    const u64 timestamp_now = m_scheduler.GetTimestampNow();
+
+    while(m_movie_input_index < inputs.size() && inputs[m_movie_input_index].timestamp <= timestamp_now) {
+      const Movie::Input& input = inputs[m_movie_input_index++];
+
+      switch(input.type) {
+        case Movie::InputType::Key:   SetKeyState(input.key, input.pressed); break;
+        case Movie::InputType::Touch: SetTouchState(input.pressed, input.x, input.y); break;
+        default: ATOM_PANIC("bad movie input type: {}", (int)input.type);
+      }
+    }
+
+    m_movie_next_timestamp = m_movie_input_index < inputs.size() ? inputs[m_movie_input_index].timestamp : std::numeric_limits<u64>::max();
+  }
+
+  static u64 HashBytes(const u8* data, size_t size, u64 hash) {
+    constexpr u64 k_prime_1 = 0x9E3779B185EBCA87ull;
+    constexpr u64 k_prime_2 = 0xC2B2AE3D27D4EB4Full;
+
+    // @note: hashing main memory every frame must be cheap, so this only mixes a word at a time.
+    size_t i = 0u;
+
+    for(; i + sizeof(u64) <= size; i += sizeof(u64)) {
+      u64 word;
+      std::memcpy(&word, &data[i], sizeof(u64));
+      hash = std::rotl(hash ^ (word * k_prime_2), 31) * k_prime_1;
+    }
+
+    for(; i < size; i++) {
+      hash = (hash ^ data[i]) * k_prime_1;
+    }
+    return hash;
+  }
+
+  u64 NDS::HashFrame(const u32* fb_top, const u32* fb_bottom, bool include_memory) const {
+    constexpr size_t k_framebuffer_size = 256 * 192 * sizeof(u32);
+
+    u64 hash = 0u;
+
+    hash = HashBytes((const u8*)fb_top, k_framebuffer_size, hash);
+    hash = HashBytes((const u8*)fb_bottom, k_framebuffer_size, hash);
+
+    if(include_memory) {
+      hash = HashBytes(m_memory.ewram.data(), m_memory.ewram.size(), hash);
+      hash = HashBytes(m_memory.swram.m_swram.data(), m_memory.swram.m_swram.size(), hash);
+      hash = HashBytes(m_memory.arm7.iwram.data(), m_memory.arm7.iwram.size(), hash);
+    }
+
+    // Final avalanche (MurmurHash3 fmix64)
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ull;
+    hash ^= hash >> 33;
+    return hash;
+  }
+
 } // namespace dual::nds
@@ -8,6 +8,16 @@ namespace dual::nds {
     Write_WRAMCNT(3u);
   }
 
+  void SWRAM::SaveState(StateWriter& state) const {
+    state.Write(m_swram);
+    state.Write(m_wramcnt);
+  }
+
+  void SWRAM::LoadState(StateReader& state) {
+    state.Read(m_swram);
+    Write_WRAMCNT(state.Read<u8>());
+  }
+
   u32 SWRAM::Read_WRAMCNT() {
     return m_wramcnt;
   }
@@ -39,6 +49,11 @@ namespace dual::nds {
     }
 
     m_wramcnt = allocation;
+
+    // Code that either CPU decoded from the 0x03xxxxxx region may now come from somewhere else.
+    m_code_page_versions.InvalidateAll();
+
+    for(const auto& callback : m_callbacks) callback();
   }
 
 } // namespace dual::nds
\ No newline at end of file
@@ -1,4 +1,5 @@
 
+#include <atom/meta.hpp>
 #include <dual/nds/timer.hpp>
 
 namespace dual::nds {
@@ -11,6 +12,29 @@ namespace dual::nds {
 
   void Timer::Reset() {
     for(auto& channel : m_channel) channel = {};
+
+    atom::static_for<int, 0, 4>([&](auto id) {
+      m_scheduler.Register<&Timer::OnOverflow<id>>(&m_channel[id].event, this);
+    });
+  }
+
+  void Timer::SaveState(StateWriter& state) const {
+    // @note: the overflow events are saved by the scheduler.
+    for(const auto& channel : m_channel) {
+      state.Write(channel.tmcnt);
+      state.Write(channel.counter);
+      state.Write(channel.divider_shift);
+      state.Write(channel.timestamp_last_reload);
+    }
+  }
+
+  void Timer::LoadState(StateReader& state) {
+    for(auto& channel : m_channel) {
+      state.Read(channel.tmcnt);
+      state.Read(channel.counter);
+      state.Read(channel.divider_shift);
+      state.Read(channel.timestamp_last_reload);
+    }
   }
 
   auto Timer::Read_TMCNT(int id) -> u32 {
@@ -20,6 +44,11 @@ namespace dual::nds {
 
     if(channel.tmcnt.enable && channel.tmcnt.clock_select == 0u) {
       counter += GetTicksSinceLastReload(id);
+
+      // The counter advances without any event, so a loop which polls it must not be skipped as an idle loop.
+      if(arm::CPU* cpu = m_irq.GetCPU(); cpu != nullptr) {
+        cpu->GetIdleLoopDetector().OnVolatileRead();
+      }
     }
 
     return (channel.tmcnt.word & 0xFFFF0000u) | counter;
@@ -36,11 +65,10 @@ namespace dual::nds {
 
     const bool old_enable = tmcnt.enable;
 
-    if(channel.event != nullptr) {
+    if(channel.event.IsScheduled()) {
       // @todo: check if the timer can ever overflow from this operation.
       channel.counter += GetTicksSinceLastReload(id);
-      m_scheduler.Cancel(channel.event);
-      channel.event = nullptr;
+      m_scheduler.Cancel(&channel.event);
     }
 
     tmcnt.word = (value & write_mask) | (tmcnt.word & ~write_mask);
@@ -67,15 +95,17 @@ namespace dual::nds {
 
     const uint cycles = (0x10000u - channel.counter) << channel.divider_shift;
 
-    // @todo: do not recreate the lambda every time the timer overflows
-    channel.event = m_scheduler.Add(cycles + cycle_offset, [=, this](int cycles_late) {
-      DoOverflow(id);
-      ScheduleTimerOverflow(id, -cycles_late);
-    });
+    m_scheduler.Reschedule(&channel.event, cycles + cycle_offset);
 
     channel.timestamp_last_reload = m_cpu_cycle_counter.GetTimestampNow();
   }
 
+  template<int id>
+  void Timer::OnOverflow(int cycles_late) {
+    DoOverflow(id);
+    ScheduleTimerOverflow(id, -cycles_late);
+  }
+
   void Timer::DoOverflow(int id) {
     auto& channel = m_channel[id];
 
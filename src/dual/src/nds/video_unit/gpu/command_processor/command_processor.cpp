@@ -31,7 +31,7 @@ namespace dual::nds::gpu {
     m_unpack = {};
     m_cmd_pipe.Reset();
     m_cmd_fifo.Reset();
-    m_cmd_event = nullptr;
+    m_scheduler.Register<&CommandProcessor::OnCommandEvent>(&m_cmd_event, this);
     m_mtx_mode = 0;
     m_projection_mtx_index = 0;
     m_coordinate_mtx_index = 0;
@@ -44,6 +44,56 @@ namespace dual::nds::gpu {
     m_use_w_buffer_pending = false;
   }
 
+  void CommandProcessor::SaveState(StateWriter& state) const {
+    state.Write(m_unpack);
+    state.Write(m_cmd_pipe);
+    state.Write(m_cmd_fifo);
+    state.Write(m_mtx_mode);
+    state.Write(m_projection_mtx_stack);
+    state.Write(m_coordinate_mtx_stack);
+    state.Write(m_direction_mtx_stack);
+    state.Write(m_texture_mtx_stack);
+    state.Write(m_projection_mtx);
+    state.Write(m_coordinate_mtx);
+    state.Write(m_direction_mtx);
+    state.Write(m_texture_mtx);
+    state.Write(m_projection_mtx_index);
+    state.Write(m_coordinate_mtx_index);
+    state.Write(m_texture_mtx_index);
+    state.Write(m_clip_mtx_dirty);
+    state.Write(m_clip_mtx);
+    state.Write(m_last_position);
+    state.Write(m_manual_translucent_y_sorting_pending);
+    state.Write(m_swap_buffers_pending);
+    state.Write(m_use_w_buffer_pending);
+    state.Write(m_viewport);
+  }
+
+  void CommandProcessor::LoadState(StateReader& state) {
+    state.Read(m_unpack);
+    state.Read(m_cmd_pipe);
+    state.Read(m_cmd_fifo);
+    state.Read(m_mtx_mode);
+    state.Read(m_projection_mtx_stack);
+    state.Read(m_coordinate_mtx_stack);
+    state.Read(m_direction_mtx_stack);
+    state.Read(m_texture_mtx_stack);
+    state.Read(m_projection_mtx);
+    state.Read(m_coordinate_mtx);
+    state.Read(m_direction_mtx);
+    state.Read(m_texture_mtx);
+    state.Read(m_projection_mtx_index);
+    state.Read(m_coordinate_mtx_index);
+    state.Read(m_texture_mtx_index);
+    state.Read(m_clip_mtx_dirty);
+    state.Read(m_clip_mtx);
+    state.Read(m_last_position);
+    state.Read(m_manual_translucent_y_sorting_pending);
+    state.Read(m_swap_buffers_pending);
+    state.Read(m_use_w_buffer_pending);
+    state.Read(m_viewport);
+  }
+
   void CommandProcessor::SwapBuffers(gpu::RendererBase* renderer) {
     if(m_swap_buffers_pending) {
       m_swap_buffers_pending = false;
@@ -70,9 +120,7 @@ namespace dual::nds::gpu {
        */
       while(m_cmd_fifo.IsFull()) {
         m_gxstat.busy = false;
-        if(m_cmd_event) {
-          m_scheduler.Cancel(m_cmd_event);
-        }
+        m_scheduler.Cancel(&m_cmd_event);
         ProcessCommandsImpl();
       }
 
@@ -196,13 +244,14 @@ namespace dual::nds::gpu {
     if(!m_swap_buffers_pending) {
       // @todo: think of a more efficient solution.
       m_gxstat.busy = true;
-      m_cmd_event = m_scheduler.Add(1, [this](int _) {
-        m_cmd_event = nullptr;
-        ProcessCommands();
-      });
+      m_scheduler.Reschedule(&m_cmd_event, 1);
     }
   }
 
+  void CommandProcessor::OnCommandEvent(int cycles_late) {
+    ProcessCommands();
+  }
+
   void CommandProcessor::ExecuteCommand(u8 command) {
     switch(command) {
       case 0x00: DequeueFIFO(); break; // NOP
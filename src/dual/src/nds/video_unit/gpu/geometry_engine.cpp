@@ -34,6 +34,163 @@ namespace dual::nds::gpu {
     m_manual_translucent_y_sorting = false;
   }
 
+  void GeometryEngine::SaveState(StateWriter& state) const {
+    for(int buffer : {0, 1}) {
+      const auto& vert_ram = m_vertex_ram[buffer];
+      const auto& poly_ram = m_polygon_ram[buffer];
+
+      state.Write((u32)vert_ram.Size());
+      for(const Vertex& vertex : vert_ram) {
+        state.Write(vertex);
+      }
+
+      // Vertices are referenced by their index in the vertex RAM of the same buffer.
+      state.Write((u32)poly_ram.Size());
+      for(const Polygon& poly : poly_ram) {
+        state.Write(poly.attributes);
+        state.Write(poly.texture_params);
+        state.Write(poly.palette_base);
+        state.Write(poly.windedness);
+        state.Write(poly.translucent);
+        state.Write(poly.sorting_key);
+        state.Write((u32)poly.vertices.Size());
+        for(const Vertex* vertex : poly.vertices) {
+          state.Write((u16)(vertex - &vert_ram[0]));
+        }
+        state.Write((u32)poly.w_16.Size());
+        for(u16 w : poly.w_16) {
+          state.Write(w);
+        }
+        state.Write(poly.w_l_shift);
+        state.Write(poly.w_r_shift);
+      }
+    }
+
+    // The polygons to render are always taken from the buffer that is not currently written to.
+    const Polygon* poly_ram_base = &m_polygon_ram[m_current_buffer ^ 1][0];
+
+    state.Write((u32)m_polygons_sorted.Size());
+    for(const Polygon* poly : m_polygons_sorted) {
+      state.Write((u16)(poly - poly_ram_base));
+    }
+
+    state.Write((u32)m_current_vertex_list.Size());
+    for(const Vertex& vertex : m_current_vertex_list) {
+      state.Write(vertex);
+    }
+
+    state.Write(m_inside_vertex_list);
+    state.Write(m_primitive_is_quad);
+    state.Write(m_primitive_is_strip);
+    state.Write(m_first_vertex);
+    state.Write(m_polygon_strip_length);
+    state.Write(m_current_buffer);
+    state.Write(m_pending_polygon_attributes);
+    state.Write(m_polygon_attributes);
+    state.Write(m_texture_parameters);
+    state.Write(m_texture_palette_base);
+    state.Write(m_vertex_color);
+    state.Write(m_vertex_uv);
+    state.Write(m_vertex_uv_src);
+    state.Write(m_lights);
+    state.Write(m_material);
+    state.Write(m_manual_translucent_y_sorting);
+  }
+
+  void GeometryEngine::LoadState(StateReader& state) {
+    const auto read_count = [&](size_t capacity) {
+      const u32 count = state.Read<u32>();
+
+      if(count > capacity) {
+        ATOM_PANIC("gpu: bad element count in save state: {} (capacity is {})", count, capacity);
+      }
+      return count;
+    };
+
+    for(int buffer : {0, 1}) {
+      auto& vert_ram = m_vertex_ram[buffer];
+      auto& poly_ram = m_polygon_ram[buffer];
+
+      vert_ram.Clear();
+      for(u32 i = read_count(6144); i > 0; i--) {
+        vert_ram.PushBack(state.Read<Vertex>());
+      }
+
+      poly_ram.Clear();
+      for(u32 i = read_count(2048); i > 0; i--) {
+        Polygon poly{};
+
+        state.Read(poly.attributes);
+        state.Read(poly.texture_params);
+        state.Read(poly.palette_base);
+        state.Read(poly.windedness);
+        state.Read(poly.translucent);
+        state.Read(poly.sorting_key);
+
+        const u32 vertex_count = read_count(10);
+
+        for(u32 j = 0; j < vertex_count; j++) {
+          const u16 index = state.Read<u16>();
+
+          if(index >= vert_ram.Size()) {
+            ATOM_PANIC("gpu: bad vertex index in save state: {}", index);
+          }
+          poly.vertices.PushBack(&vert_ram[index]);
+        }
+        for(u32 j = read_count(10); j > 0; j--) {
+          poly.w_16.PushBack(state.Read<u16>());
+        }
+        state.Read(poly.w_l_shift);
+        state.Read(poly.w_r_shift);
+
+        poly_ram.PushBack(poly);
+      }
+    }
+
+    const u32 polygon_count = read_count(2048);
+
+    // @note: the sorted list refers to the polygons of the buffer that is not written to, but the current buffer is loaded further below.
+    u16 sorted_indices[2048];
+
+    for(u32 i = 0; i < polygon_count; i++) {
+      state.Read(sorted_indices[i]);
+    }
+
+    m_current_vertex_list.Clear();
+    for(u32 i = read_count(10); i > 0; i--) {
+      m_current_vertex_list.PushBack(state.Read<Vertex>());
+    }
+
+    state.Read(m_inside_vertex_list);
+    state.Read(m_primitive_is_quad);
+    state.Read(m_primitive_is_strip);
+    state.Read(m_first_vertex);
+    state.Read(m_polygon_strip_length);
+    state.Read(m_current_buffer);
+    state.Read(m_pending_polygon_attributes);
+    state.Read(m_polygon_attributes);
+    state.Read(m_texture_parameters);
+    state.Read(m_texture_palette_base);
+    state.Read(m_vertex_color);
+    state.Read(m_vertex_uv);
+    state.Read(m_vertex_uv_src);
+    state.Read(m_lights);
+    state.Read(m_material);
+    state.Read(m_manual_translucent_y_sorting);
+
+    m_current_buffer &= 1;
+
+    const auto& poly_ram = m_polygon_ram[m_current_buffer ^ 1];
+
+    m_polygons_sorted.Clear();
+    for(u32 i = 0; i < polygon_count; i++) {
+      if(sorted_indices[i] >= poly_ram.Size()) {
+        ATOM_PANIC("gpu: bad polygon index in save state: {}", sorted_indices[i]);
+      }
+      m_polygons_sorted.PushBack(&poly_ram[sorted_indices[i]]);
+    }
+  }
+
   void GeometryEngine::SwapBuffers() {
     // Create a sorted list of all polygons to draw in this frame.
     m_polygons_sorted.Clear();
@@ -8,10 +8,11 @@ namespace dual::nds {
     Scheduler& scheduler,
     IRQ& arm9_irq,
     arm9::DMA& arm9_dma,
-    const VRAM& vram
+    const VRAM& vram,
+    Profiler& profiler
   )   : m_cmd_processor{scheduler, arm9_irq, arm9_dma, m_io, m_geometry_engine}
       , m_geometry_engine{m_io} {
-    m_renderer = std::make_unique<gpu::SoftwareRenderer>(m_io, vram.region_gpu_texture, vram.region_gpu_palette);
+    m_renderer = std::make_unique<gpu::SoftwareRenderer>(m_io, vram.region_gpu_texture, vram.region_gpu_palette, profiler);
   }
 
   void GPU::Reset() {
@@ -22,6 +23,28 @@ namespace dual::nds {
     m_render_engine_power_on = false;
     m_geometry_engine_power_on = false;
 
+    m_renderer->UpdateEdgeColor(0u, m_io.edge_color);
+    m_renderer->UpdateToonTable(0u, m_io.toon_table);
+    m_renderer->DiscardPendingFrame();
+  }
+
+  void GPU::SaveState(StateWriter& state) const {
+    state.Write(m_io);
+    state.Write(m_render_engine_power_on);
+    state.Write(m_geometry_engine_power_on);
+    m_cmd_processor.SaveState(state);
+    m_geometry_engine.SaveState(state);
+    m_renderer->SaveState(state);
+  }
+
+  void GPU::LoadState(StateReader& state) {
+    state.Read(m_io);
+    state.Read(m_render_engine_power_on);
+    state.Read(m_geometry_engine_power_on);
+    m_cmd_processor.LoadState(state);
+    m_geometry_engine.LoadState(state);
+    m_renderer->LoadState(state, m_geometry_engine.GetPolygonsToRender());
+
     m_renderer->UpdateEdgeColor(0u, m_io.edge_color);
     m_renderer->UpdateToonTable(0u, m_io.toon_table);
   }
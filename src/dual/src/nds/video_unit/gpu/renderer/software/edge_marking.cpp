@@ -4,6 +4,8 @@
 namespace dual::nds::gpu {
 
   void SoftwareRenderer::RenderEdgeMarking() {
+    DUAL_PROFILE_SCOPE(m_profiler, Profiler::Zone::GPUEdgeMarking);
+
     // @todo: the expanded clear depth is already calculated in "RenderRearPlane". Do not calculate it twice.
     const u32 border_depth = m_clear_depth;
     const u8 border_poly_id = m_io.clear_color.polygon_id;
@@ -5,6 +5,8 @@
 namespace dual::nds::gpu {
 
   void SoftwareRenderer::RenderFog() {
+    DUAL_PROFILE_SCOPE(m_profiler, Profiler::Zone::GPUFog);
+
     Color4 fog_color;
     fog_color.R() = (i8)(m_io.fog_color.color_r << 1 | m_io.fog_color.color_r >> 4);
     fog_color.G() = (i8)(m_io.fog_color.color_g << 1 | m_io.fog_color.color_g >> 4);
@@ -58,6 +58,8 @@ namespace dual::nds::gpu {
   }
 
   void SoftwareRenderer::RenderPolygons(const Viewport& viewport, std::span<const Polygon* const> polygons) {
+    DUAL_PROFILE_SCOPE(m_profiler, Profiler::Zone::GPURasterize);
+
     for(const Polygon* polygon : polygons) {
       RenderPolygon(viewport, *polygon);
     }
@@ -676,6 +678,8 @@ namespace dual::nds::gpu {
   }
 
   void SoftwareRenderer::RenderAntiAliasing() {
+    DUAL_PROFILE_SCOPE(m_profiler, Profiler::Zone::GPUAntiAliasing);
+
     for(int y = 0; y < 192; y++) {
       for(int x = 0; x < 256; x++) {
         const Color4 top    = m_frame_buffer[0][y][x];
@@ -1,4 +1,5 @@
 
+#include <dual/common/tracer.hpp>
 #include <dual/nds/video_unit/gpu/renderer/software_renderer.hpp>
 
 namespace dual::nds::gpu {
@@ -6,29 +7,69 @@ namespace dual::nds::gpu {
   SoftwareRenderer::SoftwareRenderer(
     IO& io,
     const Region<4, 131072>& vram_texture,
-    const Region<8>& vram_palette
-  )   : m_io{io}
+    const Region<8>& vram_palette,
+    Profiler& profiler
+  )   : m_gpu_io{io}
       , m_vram_texture{vram_texture}
-      , m_vram_palette{vram_palette} {
+      , m_vram_palette{vram_palette}
+      , m_profiler{profiler} {
   }
 
   void SoftwareRenderer::Render(const Viewport& viewport, std::span<const Polygon* const> polygons) {
-    if(m_io.disp3dcnt.enable_rear_plane_bitmap) {
+    if(m_gpu_io.disp3dcnt.enable_rear_plane_bitmap) {
       ATOM_PANIC("gpu: sw: Unimplemented rear plane bitmap");
     }
 
+    /**
+     * Frames which are neither displayed nor captured are never rasterized (see RenderPendingFrame()).
+     * The snapshot makes the frame come out the same no matter when it is rasterized.
+     */
+    m_io = m_gpu_io;
+    m_edge_color = m_gpu_edge_color;
+    m_toon_table = m_gpu_toon_table;
+    m_viewport = viewport;
+    m_polygons = polygons;
+    m_frame_pending = true;
+
+    // Only polygons sample VRAM, so a frame without polygons does not need a copy of it.
+    if(!polygons.empty()) {
+      if(!m_buffers) {
+        AllocateBuffers();
+      }
+      CopyVRAM();
+    }
+  }
+
+  void SoftwareRenderer::RenderPendingFrame() {
+    // @note: this is called before every capture, which may read the initial contents of the color buffer if nothing was rasterized yet.
+    if(!m_buffers) [[unlikely]] {
+      AllocateBuffers();
+    }
+
+    if(!m_frame_pending) {
+      return;
+    }
+
+    DUAL_PROFILE_SCOPE(m_profiler, Profiler::Zone::GPURender);
+    DUAL_TRACE_SCOPE("GPU: render");
+
+    m_frame_pending = false;
+
     const bool enabled_aa = m_io.disp3dcnt.enable_anti_aliasing;
 
     m_clear_depth = (((u32)m_io.clear_depth << 9) + (((u32)m_io.clear_depth + 1u) >> 15)) * 0x1FFu;
 
-    CopyVRAM();
-    ClearColorBuffer();
-    ClearDepthBuffer();
-    ClearAttributeBuffer();
-    if(enabled_aa) {
-      ClearCoverageBuffer();
+    {
+      DUAL_PROFILE_SCOPE(m_profiler, Profiler::Zone::GPUClear);
+      ClearColorBuffer();
+      ClearDepthBuffer();
+      ClearAttributeBuffer();
+      if(enabled_aa) {
+        ClearCoverageBuffer();
+      }
     }
-    RenderPolygons(viewport, polygons);
+
+    RenderPolygons(m_viewport, m_polygons);
 
     if(m_io.disp3dcnt.enable_edge_marking) {
       RenderEdgeMarking();
@@ -43,6 +84,62 @@ namespace dual::nds::gpu {
     }
   }
 
+  void SoftwareRenderer::SaveState(StateWriter& state) const {
+    // Only the final color buffer is read back (by display capture and PPU A) after rendering.
+    state.Write(m_enable_w_buffer);
+    state.Write((bool)m_buffers);
+
+    if(m_buffers) {
+      state.Write(m_frame_buffer[0]);
+    }
+
+    // A pending frame is saved as its snapshot, so that saving does not force it to be rasterized.
+    state.Write(m_frame_pending);
+
+    if(m_frame_pending) {
+      state.Write(m_io);
+      state.Write(m_edge_color);
+      state.Write(m_toon_table);
+      state.Write(m_viewport);
+
+      if(!m_polygons.empty()) {
+        state.WriteBytes(m_vram_texture_copy, sizeof(Buffers::vram_texture_copy));
+        state.WriteBytes(m_vram_palette_copy, sizeof(Buffers::vram_palette_copy));
+      }
+    }
+  }
+
+  void SoftwareRenderer::LoadState(StateReader& state, std::span<const Polygon* const> polygons) {
+    state.Read(m_enable_w_buffer);
+
+    if(state.Read<bool>()) {
+      if(!m_buffers) {
+        AllocateBuffers();
+      }
+      state.Read(m_frame_buffer[0]);
+    } else {
+      m_buffers.reset();
+    }
+
+    state.Read(m_frame_pending);
+
+    if(m_frame_pending) {
+      state.Read(m_io);
+      state.Read(m_edge_color);
+      state.Read(m_toon_table);
+      state.Read(m_viewport);
+      m_polygons = polygons;
+
+      if(!m_polygons.empty()) {
+        if(!m_buffers) {
+          AllocateBuffers();
+        }
+        state.ReadBytes(m_vram_texture_copy, sizeof(Buffers::vram_texture_copy));
+        state.ReadBytes(m_vram_palette_copy, sizeof(Buffers::vram_palette_copy));
+      }
+    }
+  }
+
   void SoftwareRenderer::CaptureColor(int scanline, std::span<u16, 256> dst_buffer, int dst_width, bool display_capture) {
     // @todo: write a separate method for display capture?
 
@@ -66,7 +163,21 @@ namespace dual::nds::gpu {
     }
   }
 
+  void SoftwareRenderer::AllocateBuffers() {
+    // @note: value-initialization zeroes the buffers and sets the color buffers to the Color4 default.
+    m_buffers = std::make_unique<Buffers>();
+
+    m_vram_texture_copy = m_buffers->vram_texture_copy;
+    m_vram_palette_copy = m_buffers->vram_palette_copy;
+    m_frame_buffer = m_buffers->frame_buffer;
+    m_depth_buffer = m_buffers->depth_buffer;
+    m_attribute_buffer = m_buffers->attribute_buffer;
+    m_coverage_buffer = m_buffers->coverage_buffer;
+  }
+
   void SoftwareRenderer::CopyVRAM() {
+    DUAL_PROFILE_SCOPE(m_profiler, Profiler::Zone::GPUCopyVRAM);
+
     for(u32 address = 0; address < 0x80000u; address += 8u) {
       *(u64*)&m_vram_texture_copy[address] = m_vram_texture.Read<u64>(address);
     }
@@ -9,6 +9,7 @@ namespace dual::nds {
   PPU::PPU(
     int id,
     SystemMemory& memory,
+    Profiler& profiler,
     GPU* gpu
   )   : m_vram_bg{memory.vram.region_ppu_bg[id]}
       , m_vram_obj{memory.vram.region_ppu_obj[id]}
@@ -17,6 +18,8 @@ namespace dual::nds {
       , m_vram_lcdc{memory.vram.region_lcdc}
       , m_pram{&memory.pram[id * 0x400]}
       , m_oam{&memory.oam[id * 0x400]}
+      , m_id{id}
+      , m_profiler{profiler}
       , m_gpu{gpu} {
     if(id == 0) {
       m_mmio.dispcnt = DisplayControl{0xFFFFFFFFu};
@@ -65,15 +68,90 @@ namespace dual::nds {
     m_vram_obj_dirty = {0, sizeof(m_render_vram_obj)};
     m_extpal_bg_dirty = {0, sizeof(m_render_extpal_bg)};
     m_extpal_obj_dirty = {0, sizeof(m_render_extpal_obj)};
-    m_vram_lcdc_dirty = {0, sizeof(m_render_vram_lcdc)};
+    m_vram_lcdc_dirty = {0, k_render_vram_lcdc_size};
     m_pram_dirty = {0,sizeof(m_render_pram)};
     m_oam_dirty = {0, sizeof(m_render_oam)};
 
     m_power_on = false;
 
+    StopRenderWorker();
+    m_render_worker.vcount = 0;
+    m_render_worker.vcount_max = -1;
     SetupRenderWorker();
   }
 
+  void PPU::SaveState(StateWriter& state) {
+    WaitForRenderWorker();
+
+    state.Write(m_mmio);
+    state.Write(m_frame_buffer);
+    state.Write(m_buffer_win);
+    state.Write(m_window_scanline_enable);
+    state.Write(m_vcount);
+    state.Write(m_frame);
+    state.Write(m_power_on);
+  }
+
+  void PPU::LoadState(StateReader& state) {
+    WaitForRenderWorker();
+
+    state.Read(m_mmio);
+    state.Read(m_frame_buffer);
+    state.Read(m_buffer_win);
+    state.Read(m_window_scanline_enable);
+    state.Read(m_vcount);
+    state.Read(m_frame);
+    state.Read(m_power_on);
+
+    // The render copies of VRAM, PRAM and OAM are not saved, instead they are rebuilt from the loaded memory.
+    m_vram_bg_dirty = {0, sizeof(m_render_vram_bg)};
+    m_vram_obj_dirty = {0, sizeof(m_render_vram_obj)};
+    m_extpal_bg_dirty = {0, sizeof(m_render_extpal_bg)};
+    m_extpal_obj_dirty = {0, sizeof(m_render_extpal_obj)};
+    m_vram_lcdc_dirty = {0, k_render_vram_lcdc_size};
+    m_pram_dirty = {0,sizeof(m_render_pram)};
+    m_oam_dirty = {0, sizeof(m_render_oam)};
+
+    // During the visible lines the copies are only updated on write, so they must be rebuilt right away.
+    if(m_vcount < 192) {
+      CopyVRAM(m_vram_bg, m_render_vram_bg, m_vram_bg_dirty);
+      CopyVRAM(m_vram_obj, m_render_vram_obj, m_vram_obj_dirty);
+      CopyVRAM(m_extpal_bg, m_render_extpal_bg, m_extpal_bg_dirty);
+      CopyVRAM(m_extpal_obj, m_render_extpal_obj, m_extpal_obj_dirty);
+      if(m_render_vram_lcdc) {
+        CopyVRAM(m_vram_lcdc, m_render_vram_lcdc.get(), m_vram_lcdc_dirty);
+      }
+      CopyVRAM(m_pram, m_render_pram, m_pram_dirty);
+      CopyVRAM(m_oam, m_render_oam, m_oam_dirty);
+
+      m_vram_bg_dirty = {};
+      m_vram_obj_dirty = {};
+      m_extpal_bg_dirty = {};
+      m_extpal_obj_dirty = {};
+      m_vram_lcdc_dirty = {};
+      m_pram_dirty = {};
+      m_oam_dirty = {};
+    }
+
+    // Continue rendering after the current line, which has already been rendered when the state was saved.
+    m_render_worker.vcount_max = -1;
+    m_render_worker.vcount = m_vcount + 1;
+    m_render_worker.vcount_max = m_vcount;
+  }
+
+  void PPU::SetEnableOutput(bool enable) {
+    WaitForRenderWorker();
+
+    const int vcount = m_render_worker.vcount_max;
+
+    // The render worker is idle, so the scanline can be rendered on this thread.
+    if(enable && !m_enable_output && vcount >= 0 && vcount < 192) {
+      RenderScanline(vcount, m_mmio_copy[vcount].capture_bg_and_3d);
+    }
+
+    m_enable_output = enable;
+  }
+
   void PPU::OnDrawScanlineBegin(u16 vcount, bool capture_bg_and_3d) {
     m_vcount = vcount;
 
@@ -140,6 +218,8 @@ namespace dual::nds {
   }
 
   void PPU::RenderScanline(u16 vcount, bool capture_bg_and_3d) {
+    DUAL_PROFILE_SCOPE(m_profiler, m_id == 0 ? Profiler::Zone::PPU_A : Profiler::Zone::PPU_B);
+
     auto display_mode = m_mmio_copy[vcount].dispcnt.display_mode;
 
     if(capture_bg_and_3d || display_mode == 1) {
@@ -175,9 +255,10 @@ namespace dual::nds {
   void PPU::RenderVideoMemoryDisplay(u16 vcount) {
     u32* line = &m_frame_buffer[m_frame][vcount * 256];
     auto vram_block = m_mmio_copy[vcount].dispcnt.vram_block;
-    const u16* source = (const u16*)&m_render_vram_lcdc[vram_block * 0x20000 + vcount * 256 * sizeof(u16)];
 
-    if(source != nullptr) {
+    if(m_render_vram_lcdc) {
+      const u16* source = (const u16*)&m_render_vram_lcdc[vram_block * 0x20000 + vcount * 256 * sizeof(u16)];
+
       for(uint x = 0; x < 256; x++) {
         line[x] = ConvertColor(*source++);
       }
@@ -277,34 +358,27 @@ namespace dual::nds {
     ComposeScanline(vcount, 0, 3);
   }
 
-  void PPU::SetupRenderWorker() {
+  void PPU::SetThreadPool(ThreadPool* thread_pool) {
+    WaitForRenderWorker();
     StopRenderWorker();
+    m_thread_pool = thread_pool;
+    SetupRenderWorker();
+  }
+
+  void PPU::SetupRenderWorker() {
+    // With a thread pool the scanlines are rendered by tasks, which SubmitScanline() queues on demand.
+    if(m_thread_pool) {
+      return;
+    }
 
-    m_render_worker.vcount = 0;
-    m_render_worker.vcount_max = -1;
     m_render_worker.running = true;
     m_render_worker.ready = false;
 
     m_render_worker.thread = std::thread([this]() {
-      while(m_render_worker.running.load()) {
-        while(m_render_worker.vcount <= m_render_worker.vcount_max) {
-          // @todo: this might be racy with SubmitScanline() resetting render_thread_vcount.
-          int vcount = m_render_worker.vcount;
-
-          if(m_mmio.dispcnt.enable[ENABLE_WIN0]) {
-            RenderWindow(0, vcount);
-          }
-
-          if(m_mmio.dispcnt.enable[ENABLE_WIN1]) {
-            RenderWindow(1, vcount);
-          }
+      Tracer::SetThreadName(m_id == 0 ? "PPU A worker" : "PPU B worker");
 
-          if(vcount < 192) {
-            RenderScanline(vcount, m_mmio_copy[vcount].capture_bg_and_3d);
-          }
-
-          m_render_worker.vcount++;
-        }
+      while(m_render_worker.running.load()) {
+        RenderSubmittedScanlines();
 
         // Wait for the emulation thread to submit more work:
         std::unique_lock lock{m_render_worker.mutex};
@@ -315,24 +389,84 @@ namespace dual::nds {
   }
 
   void PPU::StopRenderWorker() {
+    // The tasks which are still queued on the pool reference the PPU.
+    while(m_render_worker.task_count > 0) {
+      std::this_thread::yield();
+    }
+
     if(!m_render_worker.running) {
       return;
     }
 
-    // Wake the render worker thread up if it is working for new data:
+    /**
+     * Tell the render worker thread to quit and wake it up if it is waiting for new data.
+     * @note: this must happen under the lock, otherwise the worker could wake up, still see itself running and wait forever.
+     */
     m_render_worker.mutex.lock();
+    m_render_worker.running = false;
     m_render_worker.ready = true;
     m_render_worker.cv.notify_one();
     m_render_worker.mutex.unlock();
 
-    // Tell the render worker thread to quit and join it:
-    m_render_worker.running = false;
     m_render_worker.thread.join();
   }
 
+  void PPU::RenderSubmittedScanlines() {
+    while(m_render_worker.vcount <= m_render_worker.vcount_max) {
+      DUAL_TRACE_SCOPE("PPU worker: render scanline");
+
+      // @todo: this might be racy with SubmitScanline() resetting render_thread_vcount.
+      int vcount = m_render_worker.vcount;
+
+      if(m_mmio.dispcnt.enable[ENABLE_WIN0]) {
+        RenderWindow(0, vcount);
+      }
+
+      if(m_mmio.dispcnt.enable[ENABLE_WIN1]) {
+        RenderWindow(1, vcount);
+      }
+
+      // @note: windows are always updated, since their state carries over from one scanline to the next.
+      if(vcount < 192 && (m_enable_output || m_mmio_copy[vcount].capture_bg_and_3d)) {
+        RenderScanline(vcount, m_mmio_copy[vcount].capture_bg_and_3d);
+      }
+
+      m_render_worker.vcount++;
+    }
+  }
+
+  void PPU::TryRenderSubmittedScanlines() {
+    /**
+     * Only one thread at a time may render, the others simply leave the work to it.
+     * After it is done, it checks again for scanlines that were submitted in the meantime, so that none is left behind.
+     */
+    while(m_render_worker.vcount <= m_render_worker.vcount_max) {
+      if(m_render_worker.busy.exchange(true, std::memory_order_acquire)) {
+        return;
+      }
+
+      RenderSubmittedScanlines();
+
+      m_render_worker.busy.store(false, std::memory_order_release);
+    }
+  }
+
+  void PPU::AllocateVRAMDisplayCopy() {
+    m_render_vram_lcdc = std::make_unique_for_overwrite<u8[]>(k_render_vram_lcdc_size);
+
+    // From here on the copy is kept up-to-date just like the other copies, so it only needs to be filled once.
+    CopyVRAM(m_vram_lcdc, m_render_vram_lcdc.get(), {0, k_render_vram_lcdc_size});
+    m_vram_lcdc_dirty = {};
+  }
+
   void PPU::SubmitScanline(u16 vcount, bool capture_bg_and_3d) {
     m_mmio.capture_bg_and_3d = capture_bg_and_3d;
 
+    // Most titles never display a scanline straight from VRAM, so the 1 MiB copy of the LCDC VRAM is only allocated once one does.
+    if(vcount < 192 && m_mmio.dispcnt.display_mode == 2 && !m_render_vram_lcdc) [[unlikely]] {
+      AllocateVRAMDisplayCopy();
+    }
+
     if(vcount < 192) {
       m_mmio_copy[vcount] = m_mmio;
     } else {
@@ -348,7 +482,9 @@ namespace dual::nds {
       CopyVRAM(m_vram_obj, m_render_vram_obj, m_vram_obj_dirty);
       CopyVRAM(m_extpal_bg, m_render_extpal_bg, m_extpal_bg_dirty);
       CopyVRAM(m_extpal_obj, m_render_extpal_obj, m_extpal_obj_dirty);
-      CopyVRAM(m_vram_lcdc, m_render_vram_lcdc, m_vram_lcdc_dirty);
+      if(m_render_vram_lcdc) {
+        CopyVRAM(m_vram_lcdc, m_render_vram_lcdc.get(), m_vram_lcdc_dirty);
+      }
       CopyVRAM(m_pram, m_render_pram, m_pram_dirty);
       CopyVRAM(m_oam, m_render_oam, m_oam_dirty);
 
@@ -365,6 +501,20 @@ namespace dual::nds {
 
     m_render_worker.vcount_max = vcount;
 
+    if(m_thread_pool) {
+      // At most one task is queued at a time, which renders all scanlines that have been submitted by the time it runs.
+      if(!m_render_worker.task_queued.exchange(true)) {
+        m_render_worker.task_count++;
+
+        m_thread_pool->Submit([this]() {
+          m_render_worker.task_queued = false;
+          TryRenderSubmittedScanlines();
+          m_render_worker.task_count--;
+        });
+      }
+      return;
+    }
+
     std::lock_guard lock{m_render_worker.mutex};
     m_render_worker.ready = true;
     m_render_worker.cv.notify_one();
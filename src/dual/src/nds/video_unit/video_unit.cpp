@@ -11,11 +11,12 @@ namespace dual::nds {
     IRQ& irq9,
     IRQ& irq7,
     arm9::DMA& dma9,
-    arm7::DMA& dma7
+    arm7::DMA& dma7,
+    Profiler& profiler
   )   : m_scheduler{scheduler}
       , m_vram{memory.vram}
-      , m_gpu{scheduler, irq9, dma9, memory.vram}
-      , m_ppu{{0, memory, &m_gpu}, {1, memory}}
+      , m_gpu{scheduler, irq9, dma9, memory.vram, profiler}
+      , m_ppu{{0, memory, profiler, &m_gpu}, {1, memory, profiler}}
       , m_dma9{dma9}
       , m_dma7{dma7} {
     m_irq[(int)CPU::ARM9] = &irq9;
@@ -34,9 +35,40 @@ namespace dual::nds {
     m_gpu.Reset();
     for(auto& ppu : m_ppu) ppu.Reset();
 
+    m_scheduler.Register<&VideoUnit::BeginHDraw>(&m_hdraw_event, this);
+    m_scheduler.Register<&VideoUnit::BeginHBlank>(&m_hblank_event, this);
+
     BeginHDraw(0);
   }
 
+  void VideoUnit::SaveState(StateWriter& state) {
+    // @note: the PPUs go first, because their size is fixed while the size of the GPU state is not.
+    for(auto& ppu : m_ppu) ppu.SaveState(state);
+
+    state.Write(m_dispstat);
+    state.Write(m_vcount);
+    state.Write(m_powcnt1);
+    state.Write(m_dispcapcnt);
+    state.Write(m_display_swap_latch);
+    state.Write(m_display_capture_active);
+
+    m_gpu.SaveState(state);
+  }
+
+  void VideoUnit::LoadState(StateReader& state) {
+    // @note: the PPUs rebuild their copies of VRAM from memory, so VRAM must have been loaded already.
+    for(auto& ppu : m_ppu) ppu.LoadState(state);
+
+    state.Read(m_dispstat);
+    state.Read(m_vcount);
+    state.Read(m_powcnt1);
+    state.Read(m_dispcapcnt);
+    state.Read(m_display_swap_latch);
+    state.Read(m_display_capture_active);
+
+    m_gpu.LoadState(state);
+  }
+
   void VideoUnit::DirectBoot() {
     /**
      * Enable the LCDs and PPU A and B. This is a mere guess based on how the DS firmware
@@ -46,6 +78,41 @@ namespace dual::nds {
     Write_POWCNT(0x0203u, 0xFFFFu);
   }
 
+  void VideoUnit::SetEnableOutput(bool enable) {
+    m_enable_output = enable;
+    UpdateEnableOutput();
+  }
+
+  void VideoUnit::SetFrameSkip(int frames) {
+    m_frame_skip = std::max(frames, 0);
+  }
+
+  void VideoUnit::UpdateFrameSkip() {
+    m_frame_skip_counter = (m_frame_skip_counter + 1) % (m_frame_skip + 1);
+
+    const bool skip_frame = m_frame_skip_counter != 0;
+
+    if(skip_frame != m_skip_frame) {
+      m_skip_frame = skip_frame;
+      UpdateEnableOutput();
+    }
+  }
+
+  void VideoUnit::UpdateEnableOutput() {
+    const bool enable = IsOutputEnabled();
+
+    // Enabling the output in the middle of a frame renders the last submitted scanline, which may show the 3D layer.
+    if(enable && m_vcount < k_drawing_lines) {
+      m_gpu.RenderPendingFrame();
+    }
+
+    for(auto& ppu : m_ppu) ppu.SetEnableOutput(enable);
+  }
+
+  void VideoUnit::SetThreadPool(ThreadPool* thread_pool) {
+    for(auto& ppu : m_ppu) ppu.SetThreadPool(thread_pool);
+  }
+
   void VideoUnit::UpdateVerticalCounterMatchFlag(CPU cpu) {
     auto& dispstat = m_dispstat[(int)cpu];
 
@@ -62,7 +129,7 @@ namespace dual::nds {
     if(++m_vcount == k_total_lines) {
       for(auto& ppu : m_ppu) ppu.WaitForRenderWorker();
 
-      if(m_present_callback) [[likely]] {
+      if(m_present_callback && IsOutputEnabled()) [[likely]] {
         const u32* frames[2] {
           m_ppu[1].GetFrameBuffer(),
           m_ppu[0].GetFrameBuffer()
@@ -77,15 +144,26 @@ namespace dual::nds {
 
       for(auto& ppu : m_ppu) ppu.SwapBuffers();
 
+      UpdateFrameSkip();
+
       m_display_swap_latch = m_powcnt1.enable_display_swap;
       m_display_capture_active = m_dispcapcnt.capture_enable;
       m_vcount = 0u;
     }
 
+    if(m_vcount == m_break_line) {
+      m_break_line_reached = true;
+    }
+
     UpdateVerticalCounterMatchFlag(CPU::ARM9);
     UpdateVerticalCounterMatchFlag(CPU::ARM7);
 
     if(m_vcount < k_drawing_lines) {
+      // The GPU only rasterizes a frame once a scanline which shows it is rendered, so that hidden frames are never rasterized.
+      if((IsOutputEnabled() || m_display_capture_active) && m_ppu[0].GetUses3DLayer()) {
+        m_gpu.RenderPendingFrame();
+      }
+
       // @todo: check if display capture reads BG+3D
       m_ppu[0].OnDrawScanlineBegin(m_vcount, m_display_capture_active);
       m_ppu[1].OnDrawScanlineBegin(m_vcount, false);
@@ -116,16 +194,12 @@ namespace dual::nds {
         m_display_capture_active = false;
       }
 
-      // The GPU begins rendering the frame in the last 48 scanlines of V-blank.
+      /**
+       * The GPU begins rendering the frame in the last 48 scanlines of V-blank.
+       * @note: this only takes a snapshot, so PPU A may still be reading the last frame from the framebuffer on its worker.
+       * The new frame is rasterized once a scanline reads it (see above), by which time PPU A has finished the last frame.
+       */
       if(m_vcount == k_total_lines - 48) {
-        /**
-         * PPU A may read from the GPU's framebuffer, so make sure that it finishes its frame
-         * before we start rendering the next GPU frame.
-         *
-         * @todo: see if using a double buffer would be more efficient instead of always syncing?
-         */
-        m_ppu[0].WaitForRenderWorker();
-
         m_gpu.Render();
       }
 
@@ -138,7 +212,7 @@ namespace dual::nds {
     m_dispstat[(int)CPU::ARM9].hblank_flag = false;
     m_dispstat[(int)CPU::ARM7].hblank_flag = false;
 
-    m_scheduler.Add(1606 - late, this, &VideoUnit::BeginHBlank);
+    m_scheduler.Reschedule(&m_hblank_event, 1606 - late);
   }
 
   void VideoUnit::BeginHBlank(int late) {
@@ -162,7 +236,7 @@ namespace dual::nds {
       }
     }
 
-    m_scheduler.Add(524 - late, this, &VideoUnit::BeginHDraw);
+    m_scheduler.Reschedule(&m_hdraw_event, 524 - late);
   }
 
   u16 VideoUnit::Read_DISPSTAT(CPU cpu) {
@@ -242,6 +316,7 @@ namespace dual::nds {
         std::memcpy(dst, m_ppu[0].GetLayerMergeOutput(), sizeof(u16) * width);
       } else {
         // @todo: perhaps a fixed-size span is not ideal for this.
+        m_gpu.RenderPendingFrame();
         m_gpu.CaptureColor(m_vcount, std::span<u16, 256>{dst, 256}, width, true);
       }
     };
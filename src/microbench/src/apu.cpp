@@ -0,0 +1,77 @@
+#include <dual/nds/arm7/apu.hpp>
+#include <memory>
+
+#include "microbench.hpp"
+
+namespace dual::microbench {
+
+  using nds::arm7::APU;
+
+  /**
+   * All sixteen channels play looping samples at slightly different rates around 32 kHz, like a sequenced music track does.
+   * Every iteration advances the emulated time by one mixer sample, which includes sampling the channels.
+   */
+  struct APUFixture {
+    explicit APUFixture(u32 soundxcnt) {
+      static constexpr u32 k_sample_address = 0x1000u;
+      static constexpr u32 k_sample_words = 0x400u;
+
+      u32 seed = 0x13579BDu;
+
+      for(u32 i = 0; i < k_sample_words; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        memory.WriteWord(k_sample_address + i * sizeof(u32), seed, arm::Memory::Bus::System);
+      }
+
+      // Valid ADPCM header: initial sample 0, table index 0
+      memory.WriteWord(k_sample_address, 0u, arm::Memory::Bus::System);
+
+      apu.Reset();
+      apu.Write_SOUNDCNT(0x807Fu, 0xFFFFFFFFu);
+
+      for(int id = 0; id < 16; id++) {
+        apu.Write_SOUNDxSAD(id, k_sample_address, 0xFFFFFFFFu);
+        apu.Write_SOUNDxTMR(id, (u16)(0xFE00u - id * 8u), 0xFFFFu);
+        apu.Write_SOUNDxPNT(id, 0u, 0xFFFFu);
+        apu.Write_SOUNDxLEN(id, k_sample_words - 1u, 0xFFFFFFFFu);
+        apu.Write_SOUNDxCNT(id, soundxcnt, 0xFFFFFFFFu);
+      }
+    }
+
+    u64 Run(u64 samples) {
+      for(u64 i = 0; i < samples; i++) {
+        scheduler.AddCycles(1024);
+      }
+      return samples;
+    }
+
+    FlatMemory memory{};
+    Scheduler scheduler{};
+    Profiler profiler{};
+    APU apu{scheduler, memory, profiler};
+  };
+
+  void RegisterAPUBenchmarks(Suite& suite) {
+    struct Variant {
+      const char* name;
+      u32 soundxcnt;
+    };
+
+    // SOUNDxCNT: full volume, centered, looping, running (except for the mixer-only case)
+    static constexpr Variant k_variants[] {
+      {"apu/sample_mixers (channels stopped)", 0x2840007Fu},
+      {"apu/sample_mixers (16 PCM16 channels)", 0xA840007Fu},
+      {"apu/sample_mixers (16 ADPCM channels)", 0xC840007Fu}
+    };
+
+    for(const Variant& variant : k_variants) {
+      // @note: the fixture must not move, because the APU and its scheduler events refer to it.
+      const auto fixture = std::make_shared<APUFixture>(variant.soundxcnt);
+
+      suite.Add(variant.name, "samples", [fixture](u64 iterations) {
+        return fixture->Run(iterations);
+      });
+    }
+  }
+
+} // namespace dual::microbench
@@ -0,0 +1,143 @@
+#include <arm/interpreter/interpreter_cpu.hpp>
+#include <dual/nds/nds.hpp>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "microbench.hpp"
+
+namespace dual::microbench {
+
+  using arm::CPU;
+  using arm::InterpreterCPU;
+
+  /**
+   * A loop that keeps the ALU, the barrel shifter, the multiplier and the load/store units busy,
+   * but never stops writing memory, so that it is not detected as an idle loop.
+   */
+  static const std::vector<u32> k_arm_loop{
+    0xE2800001, // add r0, r0, #1
+    0xE0211180, // eor r1, r1, r0, lsl #3
+    0xE5932000, // ldr r2, [r3]
+    0xE5832004, // str r2, [r3, #4]
+    0xE1A043E1, // mov r4, r1, ror #7
+    0xE0060094, // mul r6, r4, r0
+    0xEAFFFFF8  // b <loop>
+  };
+
+  static const std::vector<u16> k_thumb_loop{
+    0x3001, // adds r0, #1
+    0x00C1, // lsls r1, r0, #3
+    0x4041, // eors r1, r0
+    0x681A, // ldr r2, [r3, #0]
+    0x605A, // str r2, [r3, #4]
+    0x4344, // muls r4, r0
+    0x186D, // adds r5, r5, r1
+    0xE7F7  // b <loop>
+  };
+
+  struct InterpreterFixture {
+    template<typename T>
+    InterpreterFixture(CPU::Model model, std::span<const T> code, bool thumb) : cpu{memory, scheduler, cycle_counter, model} {
+      for(size_t i = 0; i < code.size(); i++) {
+        if constexpr(sizeof(T) == 4) {
+          memory.WriteWord(i * sizeof(T), code[i], arm::Memory::Bus::System);
+        } else {
+          memory.WriteHalf(i * sizeof(T), code[i], arm::Memory::Bus::System);
+        }
+      }
+
+      cpu.Reset();
+      cpu.SetGPR(CPU::GPR::R3, 0x8000u);
+      cpu.SetCPSR(static_cast<u32>(CPU::Mode::System) | (thumb ? 0x20u : 0u));
+      cpu.SetGPR(CPU::GPR::PC, 0u);
+    }
+
+    FlatMemory memory{};
+    Scheduler scheduler{};
+    CycleCounter cycle_counter{0};
+    InterpreterCPU<> cpu;
+  };
+
+  /**
+   * Runs the same loops from main memory on the ARM9 memory bus of an NDS, either through the virtual arm::Memory interface
+   * or through the interpreter specialization for the concrete bus type, to measure the cost of the indirection.
+   */
+  template<typename MemoryImpl>
+  struct ARM9BusInterpreterFixture {
+    static constexpr u32 k_code_address = 0x02000000u;
+    static constexpr u32 k_data_address = 0x02100000u;
+
+    template<typename T>
+    ARM9BusInterpreterFixture(std::span<const T> code, bool thumb) : cpu{nds.GetARM9MemoryBus(), scheduler, cycle_counter, CPU::Model::ARM9} {
+      auto& bus = nds.GetARM9MemoryBus();
+
+      for(size_t i = 0; i < code.size(); i++) {
+        if constexpr(sizeof(T) == 4) {
+          bus.WriteWord(k_code_address + i * sizeof(T), code[i], arm::Memory::Bus::System);
+        } else {
+          bus.WriteHalf(k_code_address + i * sizeof(T), code[i], arm::Memory::Bus::System);
+        }
+      }
+
+      cpu.Reset();
+      cpu.SetGPR(CPU::GPR::R3, k_data_address);
+      cpu.SetCPSR(static_cast<u32>(CPU::Mode::System) | (thumb ? 0x20u : 0u));
+      cpu.SetGPR(CPU::GPR::PC, k_code_address);
+    }
+
+    nds::NDS nds{};
+    Scheduler scheduler{};
+    CycleCounter cycle_counter{0};
+    InterpreterCPU<MemoryImpl> cpu;
+  };
+
+  template<typename Fixture>
+  static void AddInterpreterBenchmark(Suite& suite, const char* name, std::shared_ptr<Fixture> fixture) {
+    suite.Add(name, "instructions", [fixture](u64 iterations) {
+      static constexpr int k_instructions_per_run = 1024;
+
+      for(u64 i = 0; i < iterations; i++) {
+        fixture->cpu.Run(k_instructions_per_run);
+      }
+      return iterations * k_instructions_per_run;
+    });
+  }
+
+  void RegisterInterpreterBenchmarks(Suite& suite) {
+    struct Variant {
+      const char* name;
+      CPU::Model model;
+      bool thumb;
+    };
+
+    static constexpr Variant k_variants[] {
+      {"interpreter/dispatch (ARM9, ARM)",   CPU::Model::ARM9, false},
+      {"interpreter/dispatch (ARM9, Thumb)", CPU::Model::ARM9, true},
+      {"interpreter/dispatch (ARM7, ARM)",   CPU::Model::ARM7, false},
+      {"interpreter/dispatch (ARM7, Thumb)", CPU::Model::ARM7, true}
+    };
+
+    for(const Variant& variant : k_variants) {
+      // @note: the fixture must not move, because the CPU refers to the memory, scheduler and cycle counter.
+      std::shared_ptr<InterpreterFixture> fixture;
+
+      if(variant.thumb) {
+        fixture = std::make_shared<InterpreterFixture>(variant.model, std::span<const u16>{k_thumb_loop}, true);
+      } else {
+        fixture = std::make_shared<InterpreterFixture>(variant.model, std::span<const u32>{k_arm_loop}, false);
+      }
+
+      AddInterpreterBenchmark(suite, variant.name, fixture);
+    }
+
+    using VirtualBusFixture = ARM9BusInterpreterFixture<arm::Memory>;
+    using DirectBusFixture = ARM9BusInterpreterFixture<nds::arm9::MemoryBus>;
+
+    AddInterpreterBenchmark(suite, "interpreter/arm9_bus (virtual, ARM)",   std::make_shared<VirtualBusFixture>(std::span<const u32>{k_arm_loop}, false));
+    AddInterpreterBenchmark(suite, "interpreter/arm9_bus (virtual, Thumb)", std::make_shared<VirtualBusFixture>(std::span<const u16>{k_thumb_loop}, true));
+    AddInterpreterBenchmark(suite, "interpreter/arm9_bus (direct, ARM)",    std::make_shared<DirectBusFixture>(std::span<const u32>{k_arm_loop}, false));
+    AddInterpreterBenchmark(suite, "interpreter/arm9_bus (direct, Thumb)",  std::make_shared<DirectBusFixture>(std::span<const u16>{k_thumb_loop}, true));
+  }
+
+} // namespace dual::microbench
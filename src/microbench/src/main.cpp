@@ -0,0 +1,40 @@
+#include <atom/arguments.hpp>
+#include <atom/logger/logger.hpp>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "microbench.hpp"
+
+using namespace dual::microbench;
+
+int main(int argc, char** argv) {
+  std::vector<const char*> files{};
+  std::string filter;
+  int min_time_ms = 250;
+  std::string scheduler_trace_path;
+
+  atom::Arguments args{"dual-microbench", "Microbenchmarks for the irisdual emulator core.", {0, 1, 0}};
+  args.RegisterArgument(filter, true, "filter", "Only run benchmarks whose name contains this string", "string");
+  args.RegisterArgument(min_time_ms, true, "min-time", "Minimum measurement time per benchmark in milliseconds", "ms");
+  args.RegisterArgument(scheduler_trace_path, true, "scheduler-trace", "Scheduler event trace to replay (see dual-bench or irisdual --scheduler-trace)", "path");
+
+  if(!args.Parse(argc, argv, &files)) {
+    std::exit(-1);
+  }
+
+  atom::get_logger().SetLogMask(0);
+
+  Suite suite{min_time_ms};
+
+  RegisterSchedulerBenchmarks(suite, scheduler_trace_path);
+  RegisterRegionBenchmarks(suite);
+  RegisterInterpreterBenchmarks(suite);
+  RegisterMemoryBusBenchmarks(suite);
+  RegisterPPUBenchmarks(suite);
+  RegisterSoftwareRendererBenchmarks(suite);
+  RegisterAPUBenchmarks(suite);
+
+  suite.Run(filter);
+  return 0;
+}
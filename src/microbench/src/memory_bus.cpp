@@ -0,0 +1,81 @@
+#include <dual/nds/nds.hpp>
+#include <fmt/format.h>
+#include <memory>
+
+#include "microbench.hpp"
+
+namespace dual::microbench {
+
+  using Bus = arm::Memory::Bus;
+
+  static std::shared_ptr<nds::NDS> CreateARM9MemoryBusFixture() {
+    auto nds = std::make_shared<nds::NDS>();
+    auto& bus = nds->GetARM9MemoryBus();
+
+    // Same TCM layout that the boot ROM sets up.
+    bus.SetupITCM({.readable = true, .writable = true, .base_address = 0x00000000u, .high_address = 0x01FFFFFFu});
+    bus.SetupDTCM({.readable = true, .writable = true, .base_address = 0x027C0000u, .high_address = 0x027C3FFFu});
+
+    bus.WriteHalf(0x04000304u, 0x820Fu, Bus::System); // POWCNT1: power on both PPUs
+    bus.WriteByte(0x04000240u, 0x80u, Bus::System);   // VRAMCNT_A: map bank A to LCDC
+    bus.WriteByte(0x04000247u, 0x00u, Bus::System);   // WRAMCNT: all shared WRAM to the ARM9
+
+    return nds;
+  }
+
+  void RegisterMemoryBusBenchmarks(Suite& suite) {
+    struct Area {
+      const char* name;
+      u32 base_address;
+      u32 mask;
+      Bus bus;
+    };
+
+    static constexpr Area k_areas[] {
+      {"ITCM",        0x00000000u, 0x3FFCu, Bus::Data},
+      {"EWRAM",       0x02000000u, 0x3FFCu, Bus::Data},
+      {"DTCM",        0x027C0000u, 0x3FFCu, Bus::Data},
+      {"SWRAM",       0x03000000u, 0x3FFCu, Bus::Data},
+      {"IO (IME)",    0x04000208u, 0x0000u, Bus::Data},
+      {"PRAM",        0x05000000u, 0x07FCu, Bus::Data},
+      {"VRAM (LCDC)", 0x06800000u, 0x3FFCu, Bus::Data},
+      {"OAM",         0x07000000u, 0x07FCu, Bus::Data},
+      {"boot ROM",    0xFFFF0000u, 0x3FFCu, Bus::Code}
+    };
+
+    const auto fixture = CreateARM9MemoryBusFixture();
+
+    for(const Area& area : k_areas) {
+      suite.Add(fmt::format("arm9_bus/read<u32> ({})", area.name), "accesses", [fixture, area](u64 iterations) {
+        static constexpr u32 k_reads_per_iteration = 4096u;
+
+        auto& bus = fixture->GetARM9MemoryBus();
+
+        u32 sum = 0u;
+
+        for(u64 i = 0; i < iterations; i++) {
+          for(u32 j = 0; j < k_reads_per_iteration; j++) {
+            sum += bus.ReadWord(area.base_address + ((j << 2) & area.mask), area.bus);
+          }
+        }
+
+        DoNotOptimize(sum);
+        return iterations * k_reads_per_iteration;
+      });
+    }
+
+    suite.Add("arm9_bus/write<u32> (EWRAM)", "accesses", [fixture](u64 iterations) {
+      static constexpr u32 k_writes_per_iteration = 4096u;
+
+      auto& bus = fixture->GetARM9MemoryBus();
+
+      for(u64 i = 0; i < iterations; i++) {
+        for(u32 j = 0; j < k_writes_per_iteration; j++) {
+          bus.WriteWord(0x02000000u + ((j << 2) & 0x3FFCu), j, Bus::Data);
+        }
+      }
+      return iterations * k_writes_per_iteration;
+    });
+  }
+
+} // namespace dual::microbench
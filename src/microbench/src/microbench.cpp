@@ -0,0 +1,56 @@
+#include <atom/float.hpp>
+#include <chrono>
+#include <fmt/format.h>
+
+#include "microbench.hpp"
+
+namespace dual::microbench {
+
+  void Suite::Add(std::string name, std::string unit, Body body) {
+    m_benchmarks.push_back({std::move(name), std::move(unit), std::move(body)});
+  }
+
+  void Suite::Run(std::string_view filter) const {
+    using Clock = std::chrono::steady_clock;
+
+    fmt::print("{:<60} {:>14} {:>12} {:>16}\n", "benchmark", "operations", "ns/op", "ops/s");
+
+    for(const auto& benchmark : m_benchmarks) {
+      if(!filter.empty() && benchmark.name.find(filter) == std::string::npos) {
+        continue;
+      }
+
+      // Warm up caches and branch predictors, then grow the iteration count until the run is long enough.
+      benchmark.body(1);
+
+      u64 iterations = 1;
+      u64 operations;
+      f64 elapsed_ns;
+
+      while(true) {
+        const auto t0 = Clock::now();
+        operations = benchmark.body(iterations);
+        elapsed_ns = (f64)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count();
+
+        if(elapsed_ns >= m_min_time_ms * 1e6 || iterations >= (1ull << 40)) {
+          break;
+        }
+
+        iterations *= elapsed_ns < m_min_time_ms * 1e5 ? 10 : 2;
+      }
+
+      const f64 ns_per_op = elapsed_ns / (f64)operations;
+      const f64 ops_per_second = 1e9 / ns_per_op;
+
+      // Slow kernels (whole frames, scanlines) are easier to read without the mega prefix.
+      if(ops_per_second >= 1e6) {
+        fmt::print("{:<60} {:>14} {:>12.3f} {:>13.2f} M{}/s\n",
+          benchmark.name, operations, ns_per_op, ops_per_second * 1e-6, benchmark.unit);
+      } else {
+        fmt::print("{:<60} {:>14} {:>12.3f} {:>13.2f}  {}/s\n",
+          benchmark.name, operations, ns_per_op, ops_per_second, benchmark.unit);
+      }
+    }
+  }
+
+} // namespace dual::microbench
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atom/integer.hpp>
+#include <atom/punning.hpp>
+#include <dual/arm/memory.hpp>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dual::microbench {
+
+  class Suite {
+    public:
+      /**
+       * A benchmark body runs its kernel for the requested number of iterations
+       * and returns the number of operations (events, instructions, ...) it performed.
+       */
+      using Body = std::function<u64(u64 iterations)>;
+
+      explicit Suite(int min_time_ms) : m_min_time_ms{min_time_ms} {}
+
+      void Add(std::string name, std::string unit, Body body);
+      void Run(std::string_view filter) const;
+
+    private:
+      struct Benchmark {
+        std::string name;
+        std::string unit;
+        Body body;
+      };
+
+      int m_min_time_ms;
+      std::vector<Benchmark> m_benchmarks{};
+  };
+
+  template<typename T>
+  inline void DoNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+  }
+
+  /**
+   * 64 KiB of memory without any side effects, mirrored across the whole address space.
+   * Used to run kernels in isolation that need a memory bus.
+   */
+  class FlatMemory final : public dual::arm::Memory {
+    public:
+      u8  ReadByte(u32 address, Bus bus) override { return atom::read<u8 >(m_data, address & 0xFFFFu); }
+      u16 ReadHalf(u32 address, Bus bus) override { return atom::read<u16>(m_data, address & 0xFFFEu); }
+      u32 ReadWord(u32 address, Bus bus) override { return atom::read<u32>(m_data, address & 0xFFFCu); }
+
+      void WriteByte(u32 address, u8  value, Bus bus) override { atom::write<u8 >(m_data, address & 0xFFFFu, value); }
+      void WriteHalf(u32 address, u16 value, Bus bus) override { atom::write<u16>(m_data, address & 0xFFFEu, value); }
+      void WriteWord(u32 address, u32 value, Bus bus) override { atom::write<u32>(m_data, address & 0xFFFCu, value); }
+
+    private:
+      u8 m_data[0x10000]{};
+  };
+
+  void RegisterSchedulerBenchmarks(Suite& suite, const std::string& trace_path);
+  void RegisterRegionBenchmarks(Suite& suite);
+  void RegisterInterpreterBenchmarks(Suite& suite);
+  void RegisterMemoryBusBenchmarks(Suite& suite);
+  void RegisterPPUBenchmarks(Suite& suite);
+  void RegisterSoftwareRendererBenchmarks(Suite& suite);
+  void RegisterAPUBenchmarks(Suite& suite);
+
+} // namespace dual::microbench
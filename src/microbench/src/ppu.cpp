@@ -0,0 +1,121 @@
+#include <dual/nds/system_memory.hpp>
+#include <dual/nds/video_unit/ppu/ppu.hpp>
+#include <memory>
+
+#include "microbench.hpp"
+
+namespace dual::microbench {
+
+  using nds::PPU;
+  using nds::VRAM;
+
+  /**
+   * PPU A with four scrolling 4bpp text backgrounds on pseudo-random tiles, maps and palettes.
+   * Each scanline goes through the render worker, the same way the video unit submits it.
+   */
+  struct PPUFixture {
+    PPUFixture() {
+      u32 seed = 0x2468ACEu;
+
+      const auto random = [&]() {
+        seed = seed * 1664525u + 1013904223u;
+        return seed >> 8;
+      };
+
+      // 1024 4bpp tiles (32 KiB), followed by four 32x32 maps at map blocks 16 to 19.
+      auto& bank_a = memory->vram.bank_a;
+
+      for(size_t i = 0; i < 0x8000u; i++) {
+        bank_a[i] = (u8)random();
+      }
+
+      for(size_t i = 0x8000u; i < 0xA000u; i += 2u) {
+        const u16 tile = (u16)(random() & 0xFFFFu);
+
+        atom::write<u16>(bank_a.data(), i, tile);
+      }
+
+      for(size_t i = 0; i < 0x400u; i += 2u) {
+        atom::write<u16>(memory->pram.data(), i, (u16)(random() & 0x7FFFu));
+      }
+
+      memory->vram.Write_VRAMCNT(VRAM::Bank::A, 0x81u); // PPU A BG, offset 0
+
+      ppu.SetPowerOn(true);
+      ppu.OnWriteVRAM_BG(0u, 0x20000u);
+      ppu.OnWritePRAM(0u, 0x400u);
+
+      auto& mmio = ppu.m_mmio;
+
+      mmio.dispcnt.WriteWord(0x00010F00u, 0xFFFFFFFFu); // mode 0, BG0 to BG3, normal display
+      mmio.mosaic.WriteHalf(0u, 0xFFFFu);
+
+      for(int i = 0; i < 4; i++) {
+        mmio.bgcnt[i].WriteHalf((u16)(i | (16 + i) << 8), 0xFFFFu);
+        mmio.bghofs[i].WriteHalf((u16)(i * 37), 0xFFFFu);
+        mmio.bgvofs[i].WriteHalf((u16)(i * 53), 0xFFFFu);
+      }
+    }
+
+    void EnableAlphaBlending() {
+      auto& mmio = ppu.m_mmio;
+
+      mmio.bldcnt.WriteHalf(0x3E41u, 0xFFFFu);   // BG0 over BG1 to BG3 and the backdrop
+      mmio.bldalpha.WriteHalf(0x0808u, 0xFFFFu); // EVA = EVB = 8/16
+    }
+
+    void EnableWindows() {
+      auto& mmio = ppu.m_mmio;
+
+      mmio.dispcnt.WriteWord(mmio.dispcnt.word | 0x6000u, 0xFFFFFFFFu);
+      mmio.winh[0].WriteHalf(0x20A0u, 0xFFFFu);
+      mmio.winv[0].WriteHalf(0x1080u, 0xFFFFu);
+      mmio.winh[1].WriteHalf(0x60F0u, 0xFFFFu);
+      mmio.winv[1].WriteHalf(0x40B0u, 0xFFFFu);
+      mmio.winin.WriteHalf(0x3B37u, 0xFFFFu);
+      mmio.winout.WriteHalf(0x003Du, 0xFFFFu);
+    }
+
+    u64 RenderFrames(u64 frames) {
+      for(u64 i = 0; i < frames; i++) {
+        for(u16 vcount = 0; vcount < 192; vcount++) {
+          ppu.OnDrawScanlineBegin(vcount, false);
+          ppu.OnDrawScanlineEnd();
+        }
+        ppu.WaitForRenderWorker();
+      }
+
+      DoNotOptimize(ppu.GetFrameBuffer()[0]);
+      return frames * 192u;
+    }
+
+    // @note: the system memory is large, so it lives on the heap. It must be declared first, because the PPU refers to it.
+    std::unique_ptr<nds::SystemMemory> memory = std::make_unique<nds::SystemMemory>();
+    Profiler profiler{};
+    PPU ppu{0, *memory, profiler};
+  };
+
+  void RegisterPPUBenchmarks(Suite& suite) {
+    const auto text = std::make_shared<PPUFixture>();
+
+    suite.Add("ppu/render_scanline (4 text BGs)", "scanlines", [text](u64 iterations) {
+      return text->RenderFrames(iterations);
+    });
+
+    const auto blend = std::make_shared<PPUFixture>();
+    blend->EnableAlphaBlending();
+
+    suite.Add("ppu/render_scanline (4 text BGs, alpha blending)", "scanlines", [blend](u64 iterations) {
+      return blend->RenderFrames(iterations);
+    });
+
+    const auto window = std::make_shared<PPUFixture>();
+    window->EnableAlphaBlending();
+    window->EnableWindows();
+
+    suite.Add("ppu/render_scanline (4 text BGs, alpha blending, windows)", "scanlines", [window](u64 iterations) {
+      return window->RenderFrames(iterations);
+    });
+  }
+
+} // namespace dual::microbench
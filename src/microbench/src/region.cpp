@@ -0,0 +1,83 @@
+#include <array>
+#include <dual/nds/vram/region.hpp>
+#include <fmt/format.h>
+#include <memory>
+
+#include "microbench.hpp"
+
+namespace dual::microbench {
+
+  using nds::Region;
+
+  /**
+   * Same shape as a PPU background region: 32 pages of 16 KiB, backed by two 128 KiB banks.
+   * With overlapping mappings both banks are mapped to the same pages, which takes the slow path for every access.
+   */
+  struct RegionFixture {
+    explicit RegionFixture(bool overlapping) {
+      region.Map(0x00000u, bank_a);
+      region.Map(overlapping ? 0x00000u : 0x20000u, bank_b);
+
+      // Pseudo-random halfword offsets into the mapped area, like the tile fetches of a scrolling background.
+      u32 seed = 0x1234567u;
+
+      for(auto& offset : offsets) {
+        seed = seed * 1664525u + 1013904223u;
+        offset = (seed >> 8) & (overlapping ? 0x1FFFEu : 0x3FFFEu);
+      }
+    }
+
+    Region<32> region{31};
+    std::array<u8, 0x20000> bank_a{};
+    std::array<u8, 0x20000> bank_b{};
+    std::array<u32, 4096> offsets{};
+  };
+
+  template<typename T>
+  static u64 RunRegionRead(const RegionFixture& fixture, u64 iterations) {
+    T sum = 0u;
+
+    for(u64 i = 0; i < iterations; i++) {
+      for(u32 offset : fixture.offsets) {
+        sum += fixture.region.Read<T>(offset);
+      }
+    }
+
+    DoNotOptimize(sum);
+    return iterations * fixture.offsets.size();
+  }
+
+  template<typename T>
+  static u64 RunRegionWrite(RegionFixture& fixture, u64 iterations) {
+    for(u64 i = 0; i < iterations; i++) {
+      for(u32 offset : fixture.offsets) {
+        fixture.region.Write<T>(offset, (T)offset);
+      }
+    }
+
+    DoNotOptimize(fixture.bank_a);
+    return iterations * fixture.offsets.size();
+  }
+
+  void RegisterRegionBenchmarks(Suite& suite) {
+    for(bool overlapping : {false, true}) {
+      const char* mapping = overlapping ? "overlapping" : "single";
+
+      // @note: the fixture is shared by all runs of the benchmark and must not move, since the region refers to the banks.
+      const auto fixture = std::make_shared<RegionFixture>(overlapping);
+
+      suite.Add(fmt::format("region/read<u16> ({})", mapping), "accesses", [fixture](u64 iterations) {
+        return RunRegionRead<u16>(*fixture, iterations);
+      });
+
+      suite.Add(fmt::format("region/read<u32> ({})", mapping), "accesses", [fixture](u64 iterations) {
+        return RunRegionRead<u32>(*fixture, iterations);
+      });
+
+      suite.Add(fmt::format("region/write<u16> ({})", mapping), "accesses", [fixture](u64 iterations) {
+        return RunRegionWrite<u16>(*fixture, iterations);
+      });
+    }
+  }
+
+} // namespace dual::microbench
@@ -0,0 +1,442 @@
+#include <algorithm>
+#include <atom/panic.hpp>
+#include <dual/common/scheduler.hpp>
+#include <dual/common/scheduler_trace.hpp>
+#include <fmt/format.h>
+#include <functional>
+#include <string>
+#include <utility>
+#include <type_traits>
+#include <vector>
+
+#include "microbench.hpp"
+
+namespace dual::microbench {
+
+  /**
+   * Periods (in cycles) of the event sources that are active during typical gameplay:
+   * the APU mixer, sixteen APU channels, the two halves of a scanline, timers and the GX command processor.
+   */
+  static const std::vector<int> k_event_periods{
+    1024,
+    512, 598, 683, 760, 1024, 1024, 1196, 1366, 1520, 1520, 2048, 2390, 2732, 3040, 4096, 4096,
+    1606, 524,
+    1024, 16384, 65536,
+    12
+  };
+
+  /**
+   * Reference implementation of the event queue before the switch to static dispatch:
+   * same binary heap, but every event carries a type-erased std::function that is rebuilt on each re-arm.
+   */
+  class FunctionScheduler {
+    public:
+      struct Event {
+        std::function<void(int)> callback;
+        int handle{};
+        u64 timestamp{};
+      };
+
+      FunctionScheduler() {
+        for(int i = 0; i < k_event_limit; i++) {
+          m_heap[i] = &m_pool[i];
+          m_heap[i]->handle = i;
+        }
+      }
+
+      void Reset() {
+        m_heap_size = 0;
+        m_timestamp_now = 0;
+        Add(std::numeric_limits<u64>::max(), [](int) {});
+      }
+
+      int GetRemainingCycleCount() const {
+        return int(m_heap[0]->timestamp - m_timestamp_now);
+      }
+
+      void AddCycles(int cycles) {
+        m_timestamp_now += cycles;
+
+        while(m_heap_size > 0 && m_heap[0]->timestamp <= m_timestamp_now) {
+          auto event = m_heap[0];
+          event->callback(int(m_timestamp_now - event->timestamp));
+          Remove(event->handle);
+        }
+      }
+
+      template<class T>
+      auto Add(u64 delay, T* object, void (T::*method)(int)) -> Event* {
+        return Add(delay, [object, method](int cycles_late) {
+          (object->*method)(cycles_late);
+        });
+      }
+
+      auto Add(u64 delay, std::function<void(int)> callback) -> Event* {
+        int n = m_heap_size++;
+        int p = (n - 1) >> 1;
+
+        auto event = m_heap[n];
+        event->timestamp = m_timestamp_now + delay;
+        event->callback = callback;
+
+        while(n != 0 && m_heap[p]->timestamp > m_heap[n]->timestamp) {
+          Swap(n, p);
+          n = p;
+          p = (n - 1) >> 1;
+        }
+
+        return event;
+      }
+
+    private:
+      static constexpr int k_event_limit = 64;
+
+      void Remove(int n) {
+        Swap(n, --m_heap_size);
+
+        int p = (n - 1) >> 1;
+
+        if(n != 0 && m_heap[p]->timestamp > m_heap[n]->timestamp) {
+          do {
+            Swap(n, p);
+            n = p;
+            p = (n - 1) >> 1;
+          } while(n != 0 && m_heap[p]->timestamp > m_heap[n]->timestamp);
+        } else {
+          Heapify(n);
+        }
+      }
+
+      void Swap(int i, int j) {
+        std::swap(m_heap[i], m_heap[j]);
+        m_heap[i]->handle = i;
+        m_heap[j]->handle = j;
+      }
+
+      void Heapify(int n) {
+        const int l = n * 2 + 1;
+        const int r = n * 2 + 2;
+
+        if(l < m_heap_size && m_heap[l]->timestamp < m_heap[n]->timestamp) {
+          Swap(l, n);
+          Heapify(l);
+        }
+
+        if(r < m_heap_size && m_heap[r]->timestamp < m_heap[n]->timestamp) {
+          Swap(r, n);
+          Heapify(r);
+        }
+      }
+
+      u64 m_timestamp_now = 0u;
+      int m_heap_size = 0;
+      Event* m_heap[k_event_limit]{};
+      Event  m_pool[k_event_limit]{};
+  };
+
+  template<typename SchedulerT>
+  struct PeriodicSource {
+    SchedulerT* scheduler;
+    int period;
+    u64* event_count;
+
+    void Fire(int cycles_late) {
+      (*event_count)++;
+
+      if constexpr(std::is_same_v<SchedulerT, Scheduler>) {
+        scheduler->template Add<&PeriodicSource::Fire>(period - cycles_late, this);
+      } else {
+        scheduler->Add(period - cycles_late, this, &PeriodicSource::Fire);
+      }
+    }
+  };
+
+  struct PersistentSource {
+    Scheduler* scheduler;
+    int period;
+    u64* event_count;
+    Scheduler::Event event{};
+
+    void Fire(int cycles_late) {
+      (*event_count)++;
+      scheduler->Reschedule(&event, period - cycles_late);
+    }
+  };
+
+  template<typename SourceT, typename SchedulerT>
+  static u64 RunPeriodicSources(SchedulerT& scheduler, u64 iterations) {
+    u64 event_count = 0u;
+    std::vector<SourceT> sources{};
+
+    sources.reserve(k_event_periods.size());
+
+    for(int period : k_event_periods) {
+      sources.push_back({&scheduler, period, &event_count});
+    }
+
+    scheduler.Reset();
+
+    for(auto& source : sources) {
+      if constexpr(std::is_same_v<SourceT, PersistentSource>) {
+        scheduler.template Register<&PersistentSource::Fire>(&source.event, &source);
+      }
+      source.Fire(0);
+    }
+    event_count = 0u;
+
+    for(u64 i = 0; i < iterations; i++) {
+      scheduler.AddCycles(scheduler.GetRemainingCycleCount());
+    }
+
+    // Detach the persistent events before the sources go out of scope.
+    scheduler.Reset();
+    return event_count;
+  }
+
+  /**
+   * Events which are armed and then cancelled before they fire, like a timer being reprogrammed or a DMA being stopped,
+   * on top of the periodic sources. Both the near and the far end of the queue are hit.
+   */
+  static u64 RunAddCancel(Scheduler& scheduler, u64 iterations) {
+    struct CancelledSource {
+      void Fire(int cycles_late) {
+        ATOM_PANIC("cancelled event fired");
+      }
+    } cancelled_source{};
+
+    static constexpr u64 k_delays[8] {16, 120, 1024, 2130, 4096, 16384, 65536, 1u << 20};
+
+    u64 event_count = 0u;
+    std::vector<PersistentSource> sources{};
+
+    sources.reserve(k_event_periods.size());
+
+    for(int period : k_event_periods) {
+      sources.push_back({&scheduler, period, &event_count});
+    }
+
+    scheduler.Reset();
+
+    for(auto& source : sources) {
+      scheduler.Register<&PersistentSource::Fire>(&source.event, &source);
+      source.Fire(0);
+    }
+
+    Scheduler::Event* events[8];
+
+    for(u64 i = 0; i < iterations; i++) {
+      for(int j = 0; j < 8; j++) {
+        events[j] = scheduler.Add<&CancelledSource::Fire>(k_delays[j], &cancelled_source);
+      }
+
+      for(int j = 7; j >= 0; j--) {
+        scheduler.Cancel(events[j]);
+      }
+
+      scheduler.AddCycles(8);
+    }
+
+    scheduler.Reset();
+    return iterations * 8u;
+  }
+
+  /**
+   * Records a trace of a synthetic workload that mimics the event mix of a running game:
+   * the periodic sources, GX command bursts, far-off timer overflows and the emulator stepping in 32 cycle slices.
+   */
+  static auto RecordSyntheticTrace() -> SchedulerTrace {
+    struct BurstSource {
+      Scheduler* scheduler;
+      Scheduler::Event event{};
+      int burst_left{};
+
+      void Fire(int cycles_late) {
+        if(burst_left-- == 0) {
+          burst_left = 48;
+          scheduler->Reschedule(&event, 2130 - cycles_late);
+        } else {
+          scheduler->Reschedule(&event, 1);
+        }
+      }
+    };
+
+    Scheduler scheduler{};
+    SchedulerTrace trace{};
+
+    u64 event_count = 0u;
+    std::vector<PersistentSource> sources{};
+    BurstSource burst_source{&scheduler};
+
+    sources.reserve(k_event_periods.size() + 2u);
+
+    for(int period : k_event_periods) {
+      sources.push_back({&scheduler, period, &event_count});
+    }
+    sources.push_back({&scheduler, 0x10000 << 10, &event_count});
+    sources.push_back({&scheduler, 0x8000 << 8, &event_count});
+
+    scheduler.SetTrace(&trace);
+
+    for(auto& source : sources) {
+      scheduler.Register<&PersistentSource::Fire>(&source.event, &source);
+      source.Fire(0);
+    }
+
+    scheduler.Register<&BurstSource::Fire>(&burst_source.event, &burst_source);
+    burst_source.Fire(0);
+
+    // Roughly four frames worth of emulated time
+    while(scheduler.GetTimestampNow() < 560190u * 4u) {
+      scheduler.AddCycles(std::min(scheduler.GetRemainingCycleCount(), 32));
+    }
+
+    scheduler.SetTrace(nullptr);
+    return trace;
+  }
+
+  /**
+   * Replays a recorded trace: top-level operations are applied in order, while the operations
+   * that were recorded inside of an event callback are applied when the replayed event fires.
+   * The backends may fire events with equal timestamps in a different order,
+   * so each event replays its own sequence of callbacks.
+   */
+  class TraceReplayer {
+    public:
+      TraceReplayer(Scheduler& scheduler, const SchedulerTrace& trace)
+          : m_scheduler{scheduler}
+          , m_entries{trace.GetEntries()}
+          , m_events(trace.GetEventCount()) {
+        const size_t size = m_entries.size();
+
+        for(size_t i = 0; i < size; i++) {
+          const auto& entry = m_entries[i];
+
+          if(entry.op == SchedulerTrace::Op::FireBegin) {
+            const size_t begin = i + 1u;
+
+            while(i < size && m_entries[i].op != SchedulerTrace::Op::FireEnd) {
+              i++;
+            }
+            m_events[entry.event_id].callbacks.emplace_back(begin, i);
+          } else if(entry.op != SchedulerTrace::Op::FireEnd) {
+            m_top_level.push_back(i);
+          }
+        }
+
+        for(auto& event : m_events) {
+          event.replayer = this;
+          m_scheduler.Register<&ReplayEvent::Fire>(&event.event, &event);
+        }
+      }
+
+      u64 Run() {
+        m_scheduler.Reset();
+        m_event_count = 0u;
+
+        for(auto& event : m_events) {
+          event.next_callback = 0u;
+        }
+
+        for(size_t i : m_top_level) {
+          Apply(m_entries[i]);
+        }
+
+        return m_event_count;
+      }
+
+    private:
+      struct ReplayEvent {
+        TraceReplayer* replayer{};
+        Scheduler::Event event{};
+        std::vector<std::pair<size_t, size_t>> callbacks{};
+        size_t next_callback{};
+
+        void Fire(int cycles_late) {
+          replayer->m_event_count++;
+
+          if(next_callback < callbacks.size()) {
+            const auto [begin, end] = callbacks[next_callback++];
+
+            for(size_t i = begin; i < end; i++) {
+              replayer->Apply(replayer->m_entries[i]);
+            }
+          }
+        }
+      };
+
+      void Apply(const SchedulerTrace::Entry& entry) {
+        switch(entry.op) {
+          case SchedulerTrace::Op::Arm:       m_scheduler.Reschedule(&m_events[entry.event_id].event, entry.value); break;
+          case SchedulerTrace::Op::Cancel:    m_scheduler.Cancel(&m_events[entry.event_id].event); break;
+          case SchedulerTrace::Op::AddCycles: m_scheduler.AddCycles((int)entry.value); break;
+          default: break;
+        }
+      }
+
+      Scheduler& m_scheduler;
+      const std::vector<SchedulerTrace::Entry>& m_entries;
+      std::vector<ReplayEvent> m_events;
+      std::vector<size_t> m_top_level{};
+      u64 m_event_count{};
+  };
+
+  void RegisterSchedulerBenchmarks(Suite& suite, const std::string& trace_path) {
+    using Backend = Scheduler::Backend;
+
+    suite.Add("scheduler/periodic_sources (heap, persistent)", "events", [](u64 iterations) {
+      static Scheduler scheduler{Backend::BinaryHeap};
+      return RunPeriodicSources<PersistentSource>(scheduler, iterations);
+    });
+
+    suite.Add("scheduler/periodic_sources (wheel, persistent)", "events", [](u64 iterations) {
+      static Scheduler scheduler{Backend::TimingWheel};
+      return RunPeriodicSources<PersistentSource>(scheduler, iterations);
+    });
+
+    suite.Add("scheduler/periodic_sources (heap, one-shot)", "events", [](u64 iterations) {
+      static Scheduler scheduler{Backend::BinaryHeap};
+      return RunPeriodicSources<PeriodicSource<Scheduler>>(scheduler, iterations);
+    });
+
+    suite.Add("scheduler/periodic_sources (std::function reference)", "events", [](u64 iterations) {
+      static FunctionScheduler scheduler{};
+      return RunPeriodicSources<PeriodicSource<FunctionScheduler>>(scheduler, iterations);
+    });
+
+    suite.Add("scheduler/add_cancel (heap)", "add+cancel", [](u64 iterations) {
+      static Scheduler scheduler{Backend::BinaryHeap};
+      return RunAddCancel(scheduler, iterations);
+    });
+
+    suite.Add("scheduler/add_cancel (wheel)", "add+cancel", [](u64 iterations) {
+      static Scheduler scheduler{Backend::TimingWheel};
+      return RunAddCancel(scheduler, iterations);
+    });
+
+    static SchedulerTrace trace{};
+
+    if(trace_path.empty()) {
+      trace = RecordSyntheticTrace();
+    } else if(!trace.Load(trace_path)) {
+      fmt::print("failed to load scheduler trace: '{}'\n", trace_path);
+      return;
+    }
+
+    for(auto backend : {Backend::BinaryHeap, Backend::TimingWheel}) {
+      const auto name = fmt::format("scheduler/trace_replay ({})", backend == Backend::BinaryHeap ? "heap" : "wheel");
+
+      suite.Add(name, "events", [backend](u64 iterations) {
+        Scheduler scheduler{backend};
+        TraceReplayer replayer{scheduler, trace};
+
+        u64 event_count = 0u;
+
+        for(u64 i = 0; i < iterations; i++) {
+          event_count += replayer.Run();
+        }
+        return event_count;
+      });
+    }
+  }
+
+} // namespace dual::microbench
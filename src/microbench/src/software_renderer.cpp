@@ -0,0 +1,127 @@
+#include <array>
+#include <dual/nds/video_unit/gpu/geometry_engine.hpp>
+#include <dual/nds/video_unit/gpu/renderer/software_renderer.hpp>
+#include <memory>
+
+#include "microbench.hpp"
+
+namespace dual::microbench {
+
+  using namespace dual::nds;
+  using namespace dual::nds::gpu;
+
+  /**
+   * Renders a canned polygon list: layers of quads that cover the whole screen, so that every pixel is drawn once per layer.
+   * The polygons go through the geometry engine once, which fills in all the data that the rasterizer expects.
+   */
+  struct SoftwareRendererFixture {
+    struct Scene {
+      int layers;
+      u32 polygon_attributes;
+      u32 texture_parameters;
+      u16 disp3dcnt;
+    };
+
+    explicit SoftwareRendererFixture(const Scene& scene) {
+      // 64x64 direct color texture at offset 0
+      for(size_t i = 0; i < texture_bank.size(); i += 2u) {
+        atom::write<u16>(texture_bank.data(), i, (u16)(0x8000u | (i * 2654435761u >> 8)));
+      }
+
+      vram_texture.Map(0u, texture_bank);
+      vram_palette.Map(0u, palette_bank);
+
+      io.disp3dcnt.half = scene.disp3dcnt;
+      io.clear_color.word = 0x001F7C00u;
+      io.clear_depth = 0x7FFFu;
+
+      const auto identity = Matrix4<Fixed20x12>::Identity();
+
+      geometry_engine->Reset();
+      geometry_engine->SetPolygonAttributes(scene.polygon_attributes);
+      geometry_engine->SetTextureParameters(scene.texture_parameters);
+
+      static constexpr int k_columns = 16;
+      static constexpr int k_rows = 12;
+
+      for(int layer = 0; layer < scene.layers; layer++) {
+        const i32 z = 0x800 - layer * 0x200;
+
+        // A quad list, each quad covers 16x16 pixels.
+        geometry_engine->Begin(1u);
+
+        for(int row = 0; row < k_rows; row++) {
+          for(int column = 0; column < k_columns; column++) {
+            const i32 x0 = -0x1000 + column * 0x2000 / k_columns;
+            const i32 x1 = x0 + 0x2000 / k_columns;
+            const i32 y0 = -0x1000 + row * 0x2000 / k_rows;
+            const i32 y1 = y0 + 0x2000 / k_rows;
+
+            const std::array<Vector3<Fixed20x12>, 4> positions{{
+              {x0, y0, z}, {x1, y0, z}, {x1, y1, z}, {x0, y1, z}
+            }};
+
+            static constexpr std::array<std::array<i16, 2>, 4> k_uvs{{
+              {0, 0}, {64 << 4, 0}, {64 << 4, 64 << 4}, {0, 64 << 4}
+            }};
+
+            for(int i = 0; i < 4; i++) {
+              geometry_engine->SetVertexColor(Color4::FromRGB555((u16)((row * 2 + layer) << 10 | column << 5 | (i * 8))));
+              geometry_engine->SetVertexUV({k_uvs[i][0], k_uvs[i][1]}, identity);
+              geometry_engine->SubmitVertex(positions[i], identity, identity);
+            }
+          }
+        }
+
+        geometry_engine->End();
+      }
+
+      geometry_engine->SwapBuffers();
+      polygons = geometry_engine->GetPolygonsToRender();
+    }
+
+    u64 Render(u64 frames) {
+      for(u64 i = 0; i < frames; i++) {
+        // @note: Render() only snapshots the frame, it is rasterized by RenderPendingFrame().
+        renderer->Render({0, 0, 256, 192}, polygons);
+        renderer->RenderPendingFrame();
+      }
+      return frames;
+    }
+
+    IO io{};
+    std::array<u8, 0x20000> texture_bank{};
+    std::array<u8, 0x4000> palette_bank{};
+    Region<4, 131072> vram_texture{3};
+    Region<8> vram_palette{7};
+    Profiler profiler{};
+    std::unique_ptr<GeometryEngine> geometry_engine = std::make_unique<GeometryEngine>(io);
+    std::unique_ptr<SoftwareRenderer> renderer = std::make_unique<SoftwareRenderer>(io, vram_texture, vram_palette, profiler);
+    std::span<const Polygon* const> polygons{};
+  };
+
+  void RegisterSoftwareRendererBenchmarks(Suite& suite) {
+    struct Variant {
+      const char* name;
+      SoftwareRendererFixture::Scene scene;
+    };
+
+    // Polygon attributes: render front and back faces, polygon ID 1, alpha 31 (opaque) or 15 (translucent).
+    // Texture parameters: 64x64 direct color texture, repeated in both directions.
+    static constexpr Variant k_variants[] {
+      {"gpu_sw/render (4 layers, shaded)",                       {4, 0x011F00C0u, 0x00000000u, 0x0000u}},
+      {"gpu_sw/render (4 layers, textured)",                     {4, 0x011F00C0u, 0x1DB30000u, 0x0001u}},
+      {"gpu_sw/render (4 layers, translucent)",                  {4, 0x010F08C0u, 0x00000000u, 0x0008u}},
+      {"gpu_sw/render (4 layers, shaded, edge marking, fog, AA)", {4, 0x011F80C0u, 0x00000000u, 0x00B0u}}
+    };
+
+    for(const Variant& variant : k_variants) {
+      const auto fixture = std::make_shared<SoftwareRendererFixture>(variant.scene);
+
+      suite.Add(variant.name, "frames", [fixture](u64 iterations) {
+        return fixture->Render(iterations);
+      });
+    }
+  }
+
+} // namespace dual::microbench
@@ -0,0 +1,762 @@
+
+#include <algorithm>
+#include <array>
+#include <atom/arguments.hpp>
+#include <atom/logger/logger.hpp>
+#include <atom/panic.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <dual/common/rewind_buffer.hpp>
+#include <dual/common/scheduler_trace.hpp>
+#include <dual/nds/batch_runner.hpp>
+#include <dual/nds/movie.hpp>
+#include <dual/nds/nds.hpp>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Runs a ROM without a window or audio device and reports how fast the emulator ran it.
+ * The emulator runs one frame at a time, so every frame is timed from the end of one frame to the end of the next.
+ * With --movie the recorded input is replayed and every frame is checked against the hash which was recorded for it.
+ * With --instances many systems run at once on a shared thread pool, which measures how the core scales with the number of host cores.
+ * The reported memory usage is what an instance owns at the end of the run, which includes the render buffers allocated so far.
+ * With --scheduler-trace every operation on the event queue is recorded, for dual-microbench to replay against both scheduler backends.
+ * With --rewind-verify the newest snapshots are popped off the rewind buffer after the run, compared against the states
+ * which were pushed and loaded back into the emulator, newest first, like a frontend steps back through them.
+ */
+
+// Frames which take longer than this could not be emulated in real time.
+static constexpr double k_frame_budget_ms = 1000.0 / 59.8261;
+
+struct Options {
+  std::string rom_path;
+  std::string boot7_path = "boot7.bin";
+  std::string boot9_path = "boot9.bin";
+  std::string json_path;
+  std::string movie_path;
+  std::string scheduler_trace_path;
+  int frames = 600;
+  int warmup_frames = 60;
+  bool enable_jit = false;
+  bool threaded_arm7 = false;
+  bool catch_up_sync = false;
+  bool no_idle_loop_skip = false;
+  bool no_present = false;
+  int frame_skip = 0;
+  int rewind_interval = 0;
+  int rewind_seconds = 60;
+  int rewind_budget_mib = 256;
+  int rewind_verify = 0;
+  int instances = 1;
+  int threads = 0;
+  bool scaling = false;
+};
+
+struct Result {
+  int frames;
+  double wall_time_s;
+  double fps;
+  double frame_time_avg_ms;
+  double frame_time_p50_ms;
+  double frame_time_p90_ms;
+  double frame_time_p99_ms;
+  double frame_time_max_ms;
+  int slow_frames;
+  int slowest_frame;
+  u64 cycles;
+  u64 instructions;
+  size_t memory_usage;
+  int rewind_snapshots_pushed;
+  double rewind_push_avg_ms;
+  double rewind_push_max_ms;
+  dual::RewindBuffer::Stats rewind_stats;
+  int rewind_verified;          //< snapshots popped and loaded by --rewind-verify
+  int rewind_verify_mismatches; //< popped snapshots which differ from the pushed state or failed to load
+  int movie_frames_checked;
+  int movie_divergent_frames;
+  int movie_first_divergent_frame;
+};
+
+struct BatchResult {
+  int threads;
+  double wall_time_s;
+  double fps;
+  double speed_up;
+  size_t memory_usage; //< average per instance
+};
+
+struct BootROMs {
+  std::array<u8, 0x8000> boot9{};
+  std::array<u8, 0x4000> boot7{};
+  bool has_boot9 = false;
+  bool has_boot7 = false;
+};
+
+struct MovieCheck {
+  dual::nds::Movie movie{};
+  int frames_presented = 0;
+  int frames_checked = 0;
+  int divergent_frames = 0;
+  int first_divergent_frame = -1;
+};
+
+static std::vector<u8> ReadFile(const std::string& path) {
+  std::ifstream file{path, std::ios::binary};
+
+  if(!file.good()) {
+    return {};
+  }
+
+  file.seekg(0, std::ios::end);
+  const size_t size = file.tellg();
+  file.seekg(0);
+
+  std::vector<u8> data(size);
+  file.read((char*)data.data(), static_cast<std::streamsize>(size));
+
+  if(!file.good()) {
+    return {};
+  }
+  return data;
+}
+
+static bool ReadBootROM(const std::string& path, std::span<u8> boot_rom) {
+  // @note: titles can be direct booted without the boot ROMs, but software interrupts then won't work.
+  if(!std::filesystem::exists(path)) {
+    fmt::print(stderr, "Boot ROM '{}' not found, running without it\n", path);
+    return false;
+  }
+
+  const std::vector<u8> data = ReadFile(path);
+
+  if(data.empty() || data.size() > boot_rom.size()) {
+    ATOM_PANIC("Failed to read boot ROM: '{}'", path);
+  }
+
+  std::copy(data.begin(), data.end(), boot_rom.begin());
+  return true;
+}
+
+static std::shared_ptr<dual::nds::ROM> ReadROM(const std::string& path) {
+  const std::vector<u8> data = ReadFile(path);
+
+  if(data.empty()) {
+    ATOM_PANIC("Failed to read NDS file: '{}'", path);
+  }
+
+  // MemoryROM takes ownership of the data.
+  u8* rom_data = new u8[data.size()];
+  std::copy(data.begin(), data.end(), rom_data);
+
+  return std::make_shared<dual::nds::MemoryROM>(rom_data, data.size());
+}
+
+static std::unique_ptr<dual::nds::NDS> CreateSystem(const Options& options, BootROMs& boot_roms, std::shared_ptr<dual::nds::ROM> rom, dual::SchedulerTrace* scheduler_trace = nullptr) {
+  auto nds = std::make_unique<dual::nds::NDS>();
+
+  // CPU engine must be configured before resetting the emulator
+  if(options.enable_jit) {
+    nds->SetCPUExecutionEngine(dual::nds::CPUExecutionEngine::JIT);
+  }
+
+  auto quantum_policy = nds->GetQuantumPolicy();
+  quantum_policy.catch_up = options.catch_up_sync;
+  quantum_policy.threaded_arm7 = options.threaded_arm7;
+  quantum_policy.skip_idle_loops = !options.no_idle_loop_skip;
+  nds->SetQuantumPolicy(quantum_policy);
+
+  // @note: the trace must start before the reset, which arms the events that all later operations build upon.
+  nds->GetScheduler().SetTrace(scheduler_trace);
+
+  // ARM7 boot ROM must be loaded before the ROM when firmware booting.
+  if(boot_roms.has_boot7) {
+    nds->LoadBootROM7(boot_roms.boot7);
+  }
+
+  if(boot_roms.has_boot9) {
+    nds->LoadBootROM9(boot_roms.boot9);
+  }
+
+  // @note: no backup device, so that benchmark runs never write any save files.
+  nds->LoadROM(std::move(rom), nullptr);
+  nds->DirectBoot();
+  nds->GetVideoUnit().SetFrameSkip(options.frame_skip);
+  return nds;
+}
+
+static double Percentile(const std::vector<double>& sorted_values, double percentile) {
+  const size_t index = (size_t)(percentile * (double)(sorted_values.size() - 1u) + 0.5);
+
+  return sorted_values[std::min(index, sorted_values.size() - 1u)];
+}
+
+static Result RunBenchmark(dual::nds::NDS& nds, const Options& options) {
+  using Clock = std::chrono::steady_clock;
+
+  // Snapshots for the rewind buffer are taken every few frames, like a frontend would. Their cost counts towards the frame time.
+  const size_t rewind_max_snapshots = options.rewind_interval > 0 ? (size_t)(options.rewind_seconds * 60 / options.rewind_interval) : 1u;
+
+  dual::RewindBuffer rewind_buffer{rewind_max_snapshots, (size_t)options.rewind_budget_mib << 20};
+  std::vector<u8> rewind_state{};
+  std::deque<std::vector<u8>> rewind_pushed_states{}; //< the newest states as they were pushed, for --rewind-verify
+  int rewind_snapshots_pushed = 0;
+  double rewind_push_total_ms = 0.0;
+  double rewind_push_max_ms = 0.0;
+
+  for(int i = 0; i < options.warmup_frames; i++) {
+    nds.RunFrame();
+  }
+
+  std::vector<double> frame_times_ms{};
+  frame_times_ms.reserve(options.frames);
+
+  u64 cycles = 0u;
+
+  const auto GetRetiredInstructions = [&]() {
+    return nds.GetRetiredInstructions(dual::nds::CPU::ARM9) + nds.GetRetiredInstructions(dual::nds::CPU::ARM7);
+  };
+
+  const u64 instructions_begin = GetRetiredInstructions();
+
+  auto time_begin = Clock::now();
+  auto time_frame_begin = time_begin;
+
+  for(int i = 0; i < options.frames; i++) {
+    cycles += nds.RunFrame();
+
+    if(options.rewind_interval > 0 && i % options.rewind_interval == 0) {
+      auto time_push_begin = Clock::now();
+
+      nds.SaveState(rewind_state);
+
+      // @note: keeping a copy of the state is not part of the cost of a snapshot, so it is excluded from the frame and wall time.
+      if(options.rewind_verify > 0) {
+        const auto time_copy_begin = Clock::now();
+
+        rewind_pushed_states.push_back(rewind_state);
+
+        if((int)rewind_pushed_states.size() > options.rewind_verify) {
+          rewind_pushed_states.pop_front();
+        }
+
+        const auto copy_time = Clock::now() - time_copy_begin;
+
+        time_begin += copy_time;
+        time_frame_begin += copy_time;
+        time_push_begin += copy_time;
+      }
+
+      rewind_buffer.Push(rewind_state);
+
+      const double push_time_ms = std::chrono::duration<double, std::milli>(Clock::now() - time_push_begin).count();
+
+      rewind_snapshots_pushed++;
+      rewind_push_total_ms += push_time_ms;
+      rewind_push_max_ms = std::max(rewind_push_max_ms, push_time_ms);
+    }
+
+    const auto time_frame_end = Clock::now();
+    frame_times_ms.push_back(std::chrono::duration<double, std::milli>(time_frame_end - time_frame_begin).count());
+    time_frame_begin = time_frame_end;
+  }
+
+  const double wall_time_s = std::chrono::duration<double>(time_frame_begin - time_begin).count();
+
+  std::vector<double> sorted_frame_times_ms = frame_times_ms;
+  std::sort(sorted_frame_times_ms.begin(), sorted_frame_times_ms.end());
+
+  const int slow_frames = (int)std::count_if(frame_times_ms.begin(), frame_times_ms.end(), [](double frame_time_ms) {
+    return frame_time_ms > k_frame_budget_ms;
+  });
+
+  const int slowest_frame = (int)(std::max_element(frame_times_ms.begin(), frame_times_ms.end()) - frame_times_ms.begin()) + options.warmup_frames;
+
+  const dual::RewindBuffer::Stats rewind_stats = rewind_buffer.GetStats();
+
+  int rewind_verified = 0;
+  int rewind_verify_mismatches = 0;
+
+  // Step back through the newest snapshots. Each must equal the state that was pushed and load without errors.
+  while(!rewind_pushed_states.empty() && rewind_buffer.Pop(rewind_state)) {
+    if(rewind_state != rewind_pushed_states.back() || !nds.LoadState(rewind_state)) {
+      rewind_verify_mismatches++;
+    }
+
+    rewind_pushed_states.pop_back();
+    rewind_verified++;
+  }
+
+  // The emulator must be able to continue from the oldest state that it stepped back to.
+  if(rewind_verified > 0) {
+    nds.RunFrame();
+  }
+
+  return {
+    .frames = options.frames,
+    .wall_time_s = wall_time_s,
+    .fps = (double)options.frames / wall_time_s,
+    .frame_time_avg_ms = wall_time_s * 1000.0 / (double)options.frames,
+    .frame_time_p50_ms = Percentile(sorted_frame_times_ms, 0.50),
+    .frame_time_p90_ms = Percentile(sorted_frame_times_ms, 0.90),
+    .frame_time_p99_ms = Percentile(sorted_frame_times_ms, 0.99),
+    .frame_time_max_ms = sorted_frame_times_ms.back(),
+    .slow_frames = slow_frames,
+    .slowest_frame = slowest_frame,
+    .cycles = cycles,
+    .instructions = GetRetiredInstructions() - instructions_begin,
+    .memory_usage = nds.GetMemoryUsage(),
+    .rewind_snapshots_pushed = rewind_snapshots_pushed,
+    .rewind_push_avg_ms = rewind_snapshots_pushed > 0 ? rewind_push_total_ms / rewind_snapshots_pushed : 0.0,
+    .rewind_push_max_ms = rewind_push_max_ms,
+    .rewind_stats = rewind_stats,
+    .rewind_verified = rewind_verified,
+    .rewind_verify_mismatches = rewind_verify_mismatches,
+    .movie_frames_checked = 0,
+    .movie_divergent_frames = 0,
+    .movie_first_divergent_frame = -1
+  };
+}
+
+static std::vector<BatchResult> RunBatchBenchmark(const Options& options, BootROMs& boot_roms, const std::shared_ptr<dual::nds::ROM>& rom) {
+  using Clock = std::chrono::steady_clock;
+
+  std::vector<int> thread_counts{};
+
+  if(options.scaling) {
+    for(int threads = 1; threads < options.threads; threads *= 2) {
+      thread_counts.push_back(threads);
+    }
+  }
+  thread_counts.push_back(options.threads);
+
+  std::vector<BatchResult> results{};
+
+  for(const int threads : thread_counts) {
+    dual::nds::BatchRunner batch_runner{threads};
+
+    // All systems share the ROM image, only their state is their own.
+    std::vector<std::unique_ptr<dual::nds::NDS>> instances{};
+    std::vector<std::unique_ptr<u32[]>> frame_copies{};
+
+    for(int i = 0; i < options.instances; i++) {
+      auto& nds = instances.emplace_back(CreateSystem(options, boot_roms, rom));
+
+      if(!options.no_present) {
+        u32* frame_copy = frame_copies.emplace_back(std::make_unique<u32[]>(256 * 192 * 2)).get();
+
+        nds->GetVideoUnit().SetPresentationCallback([frame_copy](const u32* fb_top, const u32* fb_bottom) {
+          std::copy_n(fb_top, 256 * 192, &frame_copy[0]);
+          std::copy_n(fb_bottom, 256 * 192, &frame_copy[256 * 192]);
+        });
+      }
+
+      batch_runner.Add(nds.get());
+    }
+
+    batch_runner.RunFrames(options.warmup_frames);
+
+    const auto time_begin = Clock::now();
+    batch_runner.RunFrames(options.frames);
+    const double wall_time_s = std::chrono::duration<double>(Clock::now() - time_begin).count();
+
+    const double fps = (double)options.frames * options.instances / wall_time_s;
+
+    size_t memory_usage = 0u;
+    for(auto& nds : instances) memory_usage += nds->GetMemoryUsage();
+
+    results.push_back({
+      .threads = threads,
+      .wall_time_s = wall_time_s,
+      .fps = fps,
+      .speed_up = fps / (results.empty() ? fps : results[0].fps),
+      .memory_usage = memory_usage / options.instances
+    });
+
+    for(auto& nds : instances) batch_runner.Remove(nds.get());
+  }
+
+  return results;
+}
+
+static void PrintResult(const Options& options, const Result& result) {
+  fmt::print("rom:          {}\n", options.rom_path);
+  fmt::print("engine:       {}{}\n", options.enable_jit ? "jit" : "interpreter", options.threaded_arm7 ? " (threaded ARM7)" : "");
+  fmt::print("frames:       {} (+{} warm-up)\n", result.frames, options.warmup_frames);
+
+  if(options.frame_skip > 0) {
+    fmt::print("frame skip:   {} (1 of {} frames presented)\n", options.frame_skip, options.frame_skip + 1);
+  }
+
+  fmt::print("wall time:    {:.3f} s\n", result.wall_time_s);
+  fmt::print("emulated fps: {:.2f} ({:.1f}% of real time)\n", result.fps, result.fps / 59.8261 * 100.0);
+  fmt::print("frame time:   avg {:.3f} ms, p50 {:.3f} ms, p90 {:.3f} ms, p99 {:.3f} ms, max {:.3f} ms\n",
+    result.frame_time_avg_ms, result.frame_time_p50_ms, result.frame_time_p90_ms, result.frame_time_p99_ms, result.frame_time_max_ms);
+  fmt::print("slow frames:  {} over {:.3f} ms (slowest is frame {})\n", result.slow_frames, k_frame_budget_ms, result.slowest_frame);
+
+  // Only the interpreter counts the instructions it executes.
+  if(result.instructions > 0u) {
+    fmt::print("instructions: {} ({:.2f} MIPS)\n", result.instructions, (double)result.instructions / result.wall_time_s / 1e6);
+  }
+
+  fmt::print("memory:       {:.2f} MiB\n", result.memory_usage / 1048576.0);
+
+  if(!options.movie_path.empty()) {
+    if(result.movie_divergent_frames == 0) {
+      fmt::print("movie:        {} frames checked, no divergence\n", result.movie_frames_checked);
+    } else {
+      fmt::print("movie:        {} frames checked, {} diverged (first at frame {})\n",
+        result.movie_frames_checked, result.movie_divergent_frames, result.movie_first_divergent_frame);
+    }
+  }
+
+  if(options.rewind_interval > 0) {
+    const auto& stats = result.rewind_stats;
+
+    // @note: the whole cost of a snapshot falls onto the frame which takes it, the per-frame figure is an average over the interval.
+    fmt::print("rewind:       {} snapshots taken, save + push avg {:.3f} ms, max {:.3f} ms (amortized over {} frames: {:.3f} ms per frame)\n",
+      result.rewind_snapshots_pushed, result.rewind_push_avg_ms, result.rewind_push_max_ms,
+      options.rewind_interval, result.rewind_push_avg_ms / options.rewind_interval);
+    fmt::print("rewind:       {} snapshots kept in {:.2f} MiB of {:.2f} MiB (state size {:.2f} MiB)\n",
+      stats.snapshots, stats.memory_usage / 1048576.0, stats.memory_budget / 1048576.0, stats.keyframe_size / 1048576.0);
+
+    if(options.rewind_verify > 0) {
+      fmt::print("rewind:       {} snapshots restored, {} did not match the pushed state\n", result.rewind_verified, result.rewind_verify_mismatches);
+    }
+  }
+}
+
+static void PrintBatchResults(const Options& options, const std::vector<BatchResult>& results) {
+  fmt::print("rom:          {}\n", options.rom_path);
+  fmt::print("engine:       {}\n", options.enable_jit ? "jit" : "interpreter");
+  fmt::print("instances:    {} on a shared thread pool, {} frames each (+{} warm-up)\n", options.instances, options.frames, options.warmup_frames);
+  fmt::print("{:>8} {:>12} {:>12} {:>12} {:>10} {:>14}\n", "threads", "wall time s", "frames/s", "real-time", "speed-up", "MiB/instance");
+
+  for(const auto& result : results) {
+    fmt::print("{:>8} {:>12.3f} {:>12.2f} {:>12.2f} {:>9.2f}x {:>14.2f}\n",
+      result.threads, result.wall_time_s, result.fps, result.fps / 59.8261, result.speed_up, result.memory_usage / 1048576.0);
+  }
+}
+
+static bool WriteBatchResultJSON(const std::string& path, const Options& options, const std::vector<BatchResult>& results) {
+  std::ofstream file{path, std::ios::out | std::ios::trunc};
+
+  if(!file.good()) {
+    return false;
+  }
+
+  std::string scaling{};
+
+  for(const auto& result : results) {
+    scaling += fmt::format(R"({}
+    {{ "threads": {}, "wall_time_s": {:.6f}, "fps": {:.4f}, "speed_up": {:.4f}, "memory_usage": {} }})",
+      scaling.empty() ? "" : ",", result.threads, result.wall_time_s, result.fps, result.speed_up, result.memory_usage);
+  }
+
+  file << fmt::format(R"({{
+  "rom": "{}",
+  "engine": "{}",
+  "instances": {},
+  "frames": {},
+  "warmup_frames": {},
+  "scaling": [{}
+  ]
+}}
+)",
+    std::filesystem::path{options.rom_path}.filename().string(),
+    options.enable_jit ? "jit" : "interpreter",
+    options.instances,
+    options.frames,
+    options.warmup_frames,
+    scaling
+  );
+
+  return file.good();
+}
+
+static bool WriteResultJSON(const std::string& path, const Options& options, const Result& result) {
+  std::ofstream file{path, std::ios::out | std::ios::trunc};
+
+  if(!file.good()) {
+    return false;
+  }
+
+  const std::string rom_name = std::filesystem::path{options.rom_path}.filename().string();
+
+  file << fmt::format(R"({{
+  "rom": "{}",
+  "engine": "{}",
+  "threaded_arm7": {},
+  "catch_up_sync": {},
+  "idle_loop_skip": {},
+  "present": {},
+  "frame_skip": {},
+  "frames": {},
+  "warmup_frames": {},
+  "cycles": {},
+  "instructions": {},
+  "wall_time_s": {:.6f},
+  "fps": {:.4f},
+  "frame_time_ms": {{
+    "avg": {:.6f},
+    "p50": {:.6f},
+    "p90": {:.6f},
+    "p99": {:.6f},
+    "max": {:.6f}
+  }},
+  "slow_frames": {},
+  "slowest_frame": {},
+  "memory_usage": {},
+  "rewind": {{
+    "interval": {},
+    "snapshots_pushed": {},
+    "push_avg_ms": {:.6f},
+    "push_max_ms": {:.6f},
+    "push_amortized_ms": {:.6f},
+    "snapshots_kept": {},
+    "memory_usage": {},
+    "memory_budget": {},
+    "state_size": {},
+    "snapshots_verified": {},
+    "verify_mismatches": {}
+  }},
+  "movie": {{
+    "path": "{}",
+    "frames_checked": {},
+    "divergent_frames": {},
+    "first_divergent_frame": {}
+  }}
+}}
+)",
+    rom_name,
+    options.enable_jit ? "jit" : "interpreter",
+    options.threaded_arm7,
+    options.catch_up_sync,
+    !options.no_idle_loop_skip,
+    !options.no_present,
+    options.frame_skip,
+    result.frames,
+    options.warmup_frames,
+    result.cycles,
+    result.instructions,
+    result.wall_time_s,
+    result.fps,
+    result.frame_time_avg_ms,
+    result.frame_time_p50_ms,
+    result.frame_time_p90_ms,
+    result.frame_time_p99_ms,
+    result.frame_time_max_ms,
+    result.slow_frames,
+    result.slowest_frame,
+    result.memory_usage,
+    options.rewind_interval,
+    result.rewind_snapshots_pushed,
+    result.rewind_push_avg_ms,
+    result.rewind_push_max_ms,
+    options.rewind_interval > 0 ? result.rewind_push_avg_ms / options.rewind_interval : 0.0,
+    result.rewind_stats.snapshots,
+    result.rewind_stats.memory_usage,
+    result.rewind_stats.memory_budget,
+    result.rewind_stats.keyframe_size,
+    result.rewind_verified,
+    result.rewind_verify_mismatches,
+    std::filesystem::path{options.movie_path}.filename().string(),
+    result.movie_frames_checked,
+    result.movie_divergent_frames,
+    result.movie_first_divergent_frame
+  );
+
+  return file.good();
+}
+
+int main(int argc, char** argv) {
+  std::vector<const char*> files{};
+  Options options{};
+
+  atom::Arguments args{"dual-bench", "Headless benchmark for the irisdual emulator core.", {0, 1, 0}};
+  args.RegisterArgument(options.boot7_path, true, "boot7", "Path to the ARM7 Boot ROM", "path");
+  args.RegisterArgument(options.boot9_path, true, "boot9", "Path to the ARM9 Boot ROM", "path");
+  args.RegisterArgument(options.frames, true, "frames", "Number of frames to measure");
+  args.RegisterArgument(options.warmup_frames, true, "warmup", "Number of frames to run before measuring");
+#ifdef DUAL_ENABLE_JIT
+  args.RegisterArgument(options.enable_jit, true, "jit", "Use dynamic recompilation");
+  args.RegisterArgument(options.threaded_arm7, true, "threaded-arm7", "Run the ARM7 on its own thread (requires --jit)");
+#endif
+  args.RegisterArgument(options.catch_up_sync, true, "catch-up-sync", "Only synchronize the CPUs when they access shared state (interpreter only)");
+  args.RegisterArgument(options.no_idle_loop_skip, true, "no-idle-loop-skip", "Do not fast-forward the CPUs through idle loops");
+  args.RegisterArgument(options.no_present, true, "no-present", "Do not copy out the frames, like a frontend would to display them");
+  args.RegisterArgument(options.frame_skip, true, "frame-skip", "Present only every (N+1)th frame and leave the others unrendered");
+  args.RegisterArgument(options.rewind_interval, true, "rewind-interval", "Push a snapshot to a rewind buffer every N frames (0 = off)");
+  args.RegisterArgument(options.rewind_seconds, true, "rewind-seconds", "Number of seconds the rewind buffer keeps");
+  args.RegisterArgument(options.rewind_budget_mib, true, "rewind-budget", "Memory budget of the rewind buffer in MiB");
+  args.RegisterArgument(options.rewind_verify, true, "rewind-verify", "After the run, restore the N newest snapshots and check them against the pushed states");
+  args.RegisterArgument(options.movie_path, true, "movie", "Replay the input of a movie and check the frames against its hashes", "path");
+  args.RegisterArgument(options.instances, true, "instances", "Number of systems to run at once on a shared thread pool");
+  args.RegisterArgument(options.threads, true, "threads", "Number of worker threads for --instances (0 = one per host core)");
+  args.RegisterArgument(options.scaling, true, "scaling", "With --instances, also measure with 1, 2, 4, ... worker threads");
+  args.RegisterArgument(options.scheduler_trace_path, true, "scheduler-trace", "Record a scheduler event trace to this file, which slows down the run", "path");
+  args.RegisterArgument(options.json_path, true, "json", "Also write the results as JSON to this file", "path");
+  args.RegisterFile("nds_file", false);
+
+  if(!args.Parse(argc, argv, &files)) {
+    std::exit(-1);
+  }
+
+  if(files.empty()) {
+    fmt::print(stderr, "No NDS file given\n");
+    std::exit(-1);
+  }
+
+  if(options.frames < 1 || options.warmup_frames < 0) {
+    fmt::print(stderr, "Bad frame count\n");
+    std::exit(-1);
+  }
+
+  if(options.rewind_interval < 0 || options.rewind_seconds < 1 || options.rewind_budget_mib < 1 || options.rewind_verify < 0) {
+    fmt::print(stderr, "Bad rewind settings\n");
+    std::exit(-1);
+  }
+
+  if(options.rewind_verify > 0 && options.rewind_interval == 0) {
+    fmt::print(stderr, "--rewind-verify requires --rewind-interval\n");
+    std::exit(-1);
+  }
+
+  if(options.frame_skip < 0) {
+    fmt::print(stderr, "Bad frame skip\n");
+    std::exit(-1);
+  }
+
+  if(options.frame_skip > 0 && !options.movie_path.empty()) {
+    fmt::print(stderr, "--frame-skip cannot be combined with --movie\n");
+    std::exit(-1);
+  }
+
+  if(options.instances < 1 || options.threads < 0) {
+    fmt::print(stderr, "Bad batch settings\n");
+    std::exit(-1);
+  }
+
+  if(options.instances > 1 && (!options.movie_path.empty() || options.rewind_interval > 0 || options.threaded_arm7)) {
+    fmt::print(stderr, "--instances cannot be combined with --movie, --rewind-interval or --threaded-arm7\n");
+    std::exit(-1);
+  }
+
+  if(!options.scheduler_trace_path.empty() && (options.instances > 1 || options.rewind_interval > 0)) {
+    fmt::print(stderr, "--scheduler-trace cannot be combined with --instances or --rewind-interval\n");
+    std::exit(-1);
+  }
+
+  if(options.threads == 0) {
+    options.threads = (int)std::max(std::thread::hardware_concurrency(), 1u);
+  }
+
+  options.rom_path = files[0];
+
+  atom::get_logger().SetLogMask(0);
+
+  BootROMs boot_roms{};
+  boot_roms.has_boot7 = ReadBootROM(options.boot7_path, boot_roms.boot7);
+  boot_roms.has_boot9 = ReadBootROM(options.boot9_path, boot_roms.boot9);
+
+  const std::shared_ptr<dual::nds::ROM> rom = ReadROM(options.rom_path);
+
+  if(options.instances > 1) {
+    const std::vector<BatchResult> results = RunBatchBenchmark(options, boot_roms, rom);
+
+    PrintBatchResults(options, results);
+
+    if(!options.json_path.empty() && !WriteBatchResultJSON(options.json_path, options, results)) {
+      fmt::print(stderr, "Failed to write JSON results: '{}'\n", options.json_path);
+      return -1;
+    }
+    return 0;
+  }
+
+  dual::SchedulerTrace scheduler_trace{};
+
+  auto nds = CreateSystem(options, boot_roms, rom, options.scheduler_trace_path.empty() ? nullptr : &scheduler_trace);
+
+  // Copy the frames out, which is what a frontend has to do at the very least.
+  std::unique_ptr<u32[]> frame_copy{};
+  std::unique_ptr<MovieCheck> movie_check{};
+
+  if(!options.movie_path.empty()) {
+    movie_check = std::make_unique<MovieCheck>();
+
+    if(!movie_check->movie.Load(options.movie_path)) {
+      ATOM_PANIC("Failed to read movie: '{}'", options.movie_path);
+    }
+  }
+
+  if(!options.no_present) {
+    frame_copy = std::make_unique<u32[]>(256 * 192 * 2);
+  }
+
+  if(frame_copy || movie_check) {
+    nds->GetVideoUnit().SetPresentationCallback([&](const u32* fb_top, const u32* fb_bottom) {
+      if(frame_copy) {
+        std::copy_n(fb_top, 256 * 192, &frame_copy[0]);
+        std::copy_n(fb_bottom, 256 * 192, &frame_copy[256 * 192]);
+      }
+
+      // @note: hashing the frame is part of the frame time, like it is while recording.
+      if(movie_check) {
+        const int frame = movie_check->frames_presented++;
+
+        if(frame < (int)movie_check->movie.frame_hashes.size()) {
+          if(nds->HashFrame(fb_top, fb_bottom) != movie_check->movie.frame_hashes[frame]) {
+            if(movie_check->divergent_frames++ == 0) {
+              movie_check->first_divergent_frame = frame;
+            }
+          }
+
+          movie_check->frames_checked++;
+        }
+      }
+    });
+  }
+
+  if(movie_check && !nds->PlayMovie(&movie_check->movie)) {
+    fmt::print(stderr, "The movie '{}' does not match this ROM\n", options.movie_path);
+    std::exit(-1);
+  }
+
+  Result result = RunBenchmark(*nds, options);
+
+  if(!options.scheduler_trace_path.empty()) {
+    nds->GetScheduler().SetTrace(nullptr);
+
+    if(!scheduler_trace.Save(options.scheduler_trace_path)) {
+      fmt::print(stderr, "Failed to write scheduler trace: '{}'\n", options.scheduler_trace_path);
+      return -1;
+    }
+
+    if(scheduler_trace.GetDroppedCount() != 0u) {
+      fmt::print(stderr, "The scheduler trace is full, only its first {} operations were recorded\n", scheduler_trace.GetEntries().size());
+    }
+  }
+
+  if(movie_check) {
+    result.movie_frames_checked = movie_check->frames_checked;
+    result.movie_divergent_frames = movie_check->divergent_frames;
+    result.movie_first_divergent_frame = movie_check->first_divergent_frame;
+  }
+
+  PrintResult(options, result);
+
+  if(!options.json_path.empty() && !WriteResultJSON(options.json_path, options, result)) {
+    fmt::print(stderr, "Failed to write JSON results: '{}'\n", options.json_path);
+    return -1;
+  }
+
+  if(result.rewind_verify_mismatches > 0) {
+    return -1;
+  }
+  return 0;
+}
@@ -3,6 +3,7 @@
 #include <atom/logger/logger.hpp>
 #include <atom/arguments.hpp>
 #include <dual/nds/backup/eeprom512b.hpp>
+#include <dual/common/tracer.hpp>
 #include <dual/nds/backup/flash.hpp>
 #include <fstream>
 
@@ -31,6 +32,20 @@ int Application::Run(int argc, char** argv) {
   int scale = 0;
   bool fullscreen = false;
   bool enable_jit = false;
+  bool timing_wheel = false;
+  bool catch_up_sync = false;
+  bool threaded_arm7 = false;
+  bool no_idle_loop_skip = false;
+  bool trace = false;
+  int run_ahead_frames = 0;
+  bool run_ahead_instance = false;
+  int frame_skip = 0;
+  int rewind_interval = 0;
+  int rewind_seconds = 60;
+  int rewind_budget_mib = 256;
+  std::string scheduler_trace_path;
+  int scheduler_trace_budget_mib = 64;
+  std::string movie_path;
 
   atom::Arguments args{"irisdual", "A Nintendo DS emulator developed for fun, with performance and multicore CPUs in mind.", {0, 1, 0}};
   args.RegisterArgument(boot7_path, true, "boot7", "Path to the ARM7 Boot ROM", "path");
@@ -39,28 +54,157 @@ int Application::Run(int argc, char** argv) {
   args.RegisterArgument(fullscreen, true, "fullscreen", "Whether to run in fullscreen or windowed mode");
 #ifdef DUAL_ENABLE_JIT
   args.RegisterArgument(enable_jit, true, "jit", "Use dynamic recompilation");
+  args.RegisterArgument(threaded_arm7, true, "threaded-arm7", "Run the ARM7 on its own thread (requires --jit)");
 #endif
+  args.RegisterArgument(timing_wheel, true, "timing-wheel", "Use the timing wheel scheduler backend");
+  args.RegisterArgument(catch_up_sync, true, "catch-up-sync", "Only synchronize the CPUs when they access shared state (interpreter only)");
+  args.RegisterArgument(no_idle_loop_skip, true, "no-idle-loop-skip", "Do not fast-forward the CPUs through idle loops");
+  args.RegisterArgument(trace, true, "trace", "Record a timeline trace from the start (toggle with F9)");
+  args.RegisterArgument(m_trace_path, true, "trace-file", "Path of the Chrome Trace Event JSON file written by the timeline trace", "path");
+  args.RegisterArgument(scheduler_trace_path, true, "scheduler-trace", "Record a scheduler event trace to this file", "path");
+  args.RegisterArgument(scheduler_trace_budget_mib, true, "scheduler-trace-budget", "Memory budget of the scheduler event trace in MiB, recording stops once it is used up");
+  args.RegisterArgument(run_ahead_frames, true, "run-ahead", "Number of frames to run ahead, to reduce input lag");
+  args.RegisterArgument(run_ahead_instance, true, "run-ahead-instance", "Run ahead on a second emulator instance, so that the main instance is never rolled back");
+  args.RegisterArgument(frame_skip, true, "frame-skip", "Number of frames to skip after each presented frame");
+  args.RegisterArgument(rewind_interval, true, "rewind-interval", "Take a rewind snapshot every N frames, hold R to rewind (0 = off). Each snapshot makes its frame take about 2-2.5 ms longer");
+  args.RegisterArgument(rewind_seconds, true, "rewind-seconds", "Number of seconds that can be rewound");
+  args.RegisterArgument(rewind_budget_mib, true, "rewind-budget", "Memory budget of the rewind buffer in MiB");
+  args.RegisterArgument(movie_path, true, "record-movie", "Record the input and frame hashes to this movie file, which dual-bench can replay", "path");
   args.RegisterFile("nds_file", false);
 
   if(!args.Parse(argc, argv, &files)) {
     std::exit(-1);
   }
 
+  if(run_ahead_frames < 0) {
+    fmt::print("Bad number of run-ahead frames: {}\n", run_ahead_frames);
+    std::exit(-1);
+  }
+
+  if(run_ahead_frames > 0 && !movie_path.empty()) {
+    fmt::print("Movies cannot be recorded while running ahead\n");
+    std::exit(-1);
+  }
+
+  if(frame_skip < 0 || (frame_skip > 0 && !movie_path.empty())) {
+    fmt::print("Bad frame-skip: {} (movies cannot be recorded while skipping frames)\n", frame_skip);
+    std::exit(-1);
+  }
+
+  if(rewind_interval < 0 || rewind_seconds < 1 || rewind_budget_mib < 1 || (rewind_interval > 0 && !movie_path.empty())) {
+    fmt::print("Bad rewind settings (movies cannot be recorded while rewinding is enabled)\n");
+    std::exit(-1);
+  }
+
+  if(scheduler_trace_budget_mib < 1) {
+    fmt::print("Bad scheduler-trace-budget: {}\n", scheduler_trace_budget_mib);
+    std::exit(-1);
+  }
+
+  if(run_ahead_frames > 0 && run_ahead_instance) {
+    m_run_ahead_nds = std::make_unique<dual::nds::NDS>();
+  }
+
+  dual::Tracer::SetThreadName("Main");
+  dual::Tracer::SetEnabled(trace);
+
   CreateWindow(scale, fullscreen);
+
+  // The second instance for run-ahead must be set up exactly like the main instance, so that it can load its save states.
+  for(dual::nds::NDS* nds : {m_nds.get(), m_run_ahead_nds.get()}) {
+    if(!nds) {
+      continue;
+    }
 #ifdef DUAL_ENABLE_JIT
-  // CPU engine must be configured before resetting the emulator
-  if(enable_jit) {
-    m_nds->SetCPUExecutionEngine(dual::nds::CPUExecutionEngine::JIT);
-  }
+    // CPU engine must be configured before resetting the emulator
+    if(enable_jit) {
+      nds->SetCPUExecutionEngine(dual::nds::CPUExecutionEngine::JIT);
+    }
 #endif
+    if(timing_wheel) {
+      nds->GetScheduler().SetBackend(dual::Scheduler::Backend::TimingWheel);
+    }
+
+    if(catch_up_sync || threaded_arm7 || no_idle_loop_skip) {
+      auto quantum_policy = nds->GetQuantumPolicy();
+      quantum_policy.catch_up = catch_up_sync;
+      quantum_policy.threaded_arm7 = threaded_arm7;
+      quantum_policy.skip_idle_loops = !no_idle_loop_skip;
+      nds->SetQuantumPolicy(quantum_policy);
+    }
+  }
+
+  if(!scheduler_trace_path.empty()) {
+    m_scheduler_trace.SetCapacity(((size_t)scheduler_trace_budget_mib << 20) / sizeof(dual::SchedulerTrace::Entry));
+    m_nds->GetScheduler().SetTrace(&m_scheduler_trace);
+  }
+
   // ARM7 boot ROM must be loaded before the ROM when firmware booting.
   LoadBootROM(boot7_path.c_str(), false);
   LoadBootROM(boot9_path.c_str(), true);
   LoadROM(files[0]);
+
+  m_emu_thread.SetRunAhead(run_ahead_frames, std::move(m_run_ahead_nds));
+  m_emu_thread.SetFrameSkip(frame_skip);
+  m_emu_thread.SetRewind(rewind_interval, rewind_seconds, (size_t)rewind_budget_mib << 20);
+
+  if(!movie_path.empty()) {
+    m_emu_thread.SetMovieRecording(&m_movie);
+  }
+
   MainLoop();
+
+  // Make sure that the emulator thread is done writing to the trace and the profile.
+  m_nds = m_emu_thread.Stop();
+
+  if(dual::Tracer::IsEnabled()) {
+    SaveTrace();
+  }
+
+  if(!movie_path.empty()) {
+    if(!m_movie.Save(movie_path)) {
+      fmt::print("Failed to write movie: '{}'\n", movie_path);
+    }
+  }
+
+  if(!scheduler_trace_path.empty()) {
+    if(!m_scheduler_trace.Save(scheduler_trace_path)) {
+      fmt::print("Failed to write scheduler trace: '{}'\n", scheduler_trace_path);
+    }
+
+    if(const u64 dropped_count = m_scheduler_trace.GetDroppedCount(); dropped_count != 0u) {
+      fmt::print("The scheduler trace ran out of memory, {} later operations were not recorded (see --scheduler-trace-budget)\n", dropped_count);
+    }
+  }
+
+#ifdef DUAL_ENABLE_PROFILER
+  if(m_nds) {
+    PrintProfile(m_nds->GetProfile());
+  }
+#endif
   return 0;
 }
 
+void Application::PrintProfile(const dual::Profile& profile) {
+  const auto print_samples = [](const char* title, std::vector<dual::ProfileSample> samples) {
+    std::sort(samples.begin(), samples.end(), [](const dual::ProfileSample& a, const dual::ProfileSample& b) {
+      return a.nanoseconds > b.nanoseconds;
+    });
+
+    fmt::print("{:<40} {:>12} {:>12} {:>10}\n", title, "calls", "total (ms)", "avg (ns)");
+
+    for(const auto& sample : samples) {
+      if(sample.calls == 0u) {
+        continue;
+      }
+      fmt::print("{:<40} {:>12} {:>12.2f} {:>10}\n", sample.name, sample.calls, (double)sample.nanoseconds * 1e-6, sample.nanoseconds / sample.calls);
+    }
+  };
+
+  print_samples("zone", profile.zones);
+  print_samples("event", profile.events);
+}
+
 void Application::CreateWindow(int scale, bool fullscreen) {
   if(fullscreen) {
     m_window = SDL_CreateWindow(
@@ -142,8 +286,16 @@ void Application::LoadROM(const char* path) {
   // TODO: decide the correct save type
   std::shared_ptr<dual::nds::arm7::SPI::Device> backup = std::make_shared<dual::nds::FLASH>(save_path, dual::nds::FLASH::Size::_512K);
 
-  m_nds->LoadROM(std::make_shared<dual::nds::MemoryROM>(data, size), backup);
+  const auto rom = std::make_shared<dual::nds::MemoryROM>(data, size);
+
+  m_nds->LoadROM(rom, backup);
   m_nds->DirectBoot();
+
+  if(m_run_ahead_nds) {
+    // @note: the second instance must never write to the save file, its writes are overwritten by the state of the main instance.
+    m_run_ahead_nds->LoadROM(rom, std::make_shared<dual::nds::FLASH>(save_path, dual::nds::FLASH::Size::_512K, false));
+    m_run_ahead_nds->DirectBoot();
+  }
 }
 
 void Application::LoadBootROM(const char* path, bool arm9) {
@@ -173,10 +325,16 @@ void Application::LoadBootROM(const char* path, bool arm9) {
     ATOM_PANIC("Failed to read Boot ROM: '{}'", path);
   }
 
-  if(arm9) {
-    m_nds->LoadBootROM9(boot_rom);
-  } else {
-    m_nds->LoadBootROM7(std::span<u8, 0x4000>{boot_rom.data(), 0x4000});
+  for(dual::nds::NDS* nds : {m_nds.get(), m_run_ahead_nds.get()}) {
+    if(!nds) {
+      continue;
+    }
+
+    if(arm9) {
+      nds->LoadBootROM9(boot_rom);
+    } else {
+      nds->LoadBootROM7(std::span<u8, 0x4000>{boot_rom.data(), 0x4000});
+    }
   }
 }
 
@@ -196,6 +354,8 @@ void Application::MainLoop() {
     const auto frame = m_emu_thread.AcquireFrame();
 
     if(frame.has_value()) {
+      DUAL_TRACE_SCOPE("Present");
+
       SDL_UpdateTexture(m_textures[0], nullptr, frame.value().first, 256 * sizeof(u32));
       SDL_UpdateTexture(m_textures[1], nullptr, frame.value().second, 256 * sizeof(u32));
 
@@ -282,13 +442,37 @@ void Application::HandleEvent(const SDL_Event& event) {
       case SDLK_DOWN:  update_key(dual::nds::Key::Down);  break;
       case SDLK_LEFT:  update_key(dual::nds::Key::Left);  break;
       case SDLK_RIGHT: update_key(dual::nds::Key::Right); break;
+      case SDLK_F9: if(!pressed) ToggleTrace(); break;
       case SDLK_F11: if(!pressed) m_emu_thread.Reset(); break;
       case SDLK_F12: if(!pressed) m_emu_thread.DirectBoot(); break;
       case SDLK_SPACE: m_emu_thread.SetFastForward(pressed); break;
+      case SDLK_r: m_emu_thread.SetRewinding(pressed); break;
     }
   }
 }
 
+void Application::ToggleTrace() {
+  if(dual::Tracer::IsEnabled()) {
+    dual::Tracer::SetEnabled(false);
+    SaveTrace();
+  } else {
+    dual::Tracer::SetEnabled(true);
+    fmt::print("Started recording timeline trace\n");
+  }
+}
+
+void Application::SaveTrace() {
+  dual::Tracer::SetEnabled(false);
+
+  if(dual::Tracer::Save(m_trace_path)) {
+    fmt::print("Wrote timeline trace to '{}'\n", m_trace_path);
+  } else {
+    fmt::print("Failed to write timeline trace: '{}'\n", m_trace_path);
+  }
+
+  dual::Tracer::Clear();
+}
+
 void Application::UpdateFPS() {
   const auto now = std::chrono::system_clock::now();
   const auto elapsed_time = std::chrono::duration_cast<std::chrono::milliseconds>(
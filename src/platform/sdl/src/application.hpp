@@ -2,6 +2,7 @@
 #pragma once
 
 #include <chrono>
+#include <dual/common/scheduler_trace.hpp>
 #include <dual/nds/nds.hpp>
 #include <memory>
 
@@ -23,6 +24,9 @@ class Application {
     void MainLoop();
     void HandleEvent(const SDL_Event& event);
     void UpdateFPS();
+    void PrintProfile(const dual::Profile& profile);
+    void ToggleTrace();
+    void SaveTrace();
 
     SDL_Window* m_window;
     SDL_Renderer* m_renderer;
@@ -30,9 +34,14 @@ class Application {
     SDL_Rect m_screen_geometry[2];
 
     std::unique_ptr<dual::nds::NDS> m_nds{};
+    std::unique_ptr<dual::nds::NDS> m_run_ahead_nds{};
+    dual::SchedulerTrace m_scheduler_trace{};
+    dual::nds::Movie m_movie{};
     EmulatorThread m_emu_thread{};
     int m_fps_counter{};
     std::chrono::time_point<std::chrono::system_clock> m_last_fps_update{};
 
     bool m_touch_pen_down{false};
+
+    std::string m_trace_path{"irisdual_trace.json"};
 };
\ No newline at end of file
@@ -1,6 +1,8 @@
 
+#include <algorithm>
 #include <atom/panic.hpp>
 #include <chrono>
+#include <dual/common/tracer.hpp>
 
 #include "emulator_thread.hpp"
 
@@ -20,6 +22,16 @@ void EmulatorThread::Start(std::unique_ptr<dual::nds::NDS> nds) {
   m_nds->GetVideoUnit().SetPresentationCallback([this](const u32* fb_top, const u32* fb_bottom) {
     PresentCallback(fb_top, fb_bottom);
   });
+  if(m_movie) {
+    m_nds->RecordMovie(m_movie);
+  }
+  if(m_run_ahead_nds) {
+    // Only the second instance presents frames, the main instance does not have to render them at all.
+    m_nds->GetVideoUnit().SetEnableOutput(false);
+    m_run_ahead_nds->GetVideoUnit().SetPresentationCallback([this](const u32* fb_top, const u32* fb_bottom) {
+      PresentCallback(fb_top, fb_bottom);
+    });
+  }
   m_running = true;
   m_thread = std::thread{&EmulatorThread::ThreadMain, this};
 }
@@ -30,9 +42,71 @@ std::unique_ptr<dual::nds::NDS> EmulatorThread::Stop() {
   }
   m_running = false;
   m_thread.join();
+  m_nds->StopMovie();
+  m_nds->GetVideoUnit().SetEnableOutput(true);
+  m_nds->GetVideoUnit().SetFrameSkip(0);
   return std::move(m_nds);
 }
 
+void EmulatorThread::SetRunAhead(int frames, std::unique_ptr<dual::nds::NDS> second_instance) {
+  if(m_running) {
+    ATOM_PANIC("Changing the run-ahead settings of a running emulator thread is illegal.");
+  }
+  m_run_ahead_frames = frames;
+  m_run_ahead_nds = std::move(second_instance);
+
+  if(m_run_ahead_nds) {
+    m_run_ahead_nds->GetAPU().SetEnableOutput(false);
+  }
+}
+
+void EmulatorThread::SetMovieRecording(dual::nds::Movie* movie) {
+  if(m_running) {
+    ATOM_PANIC("Changing the movie of a running emulator thread is illegal.");
+  }
+  if(movie && m_run_ahead_frames > 0) {
+    ATOM_PANIC("Recording a movie while running ahead is not supported.");
+  }
+  if(movie && m_frame_skip > 0) {
+    ATOM_PANIC("Recording a movie while skipping frames is not supported.");
+  }
+  if(movie && m_rewind_interval > 0) {
+    ATOM_PANIC("Recording a movie while rewinding is enabled is not supported.");
+  }
+  m_movie = movie;
+}
+
+void EmulatorThread::SetFrameSkip(int frames) {
+  if(m_running) {
+    ATOM_PANIC("Changing the frame-skip of a running emulator thread is illegal.");
+  }
+  if(frames > 0 && m_movie) {
+    ATOM_PANIC("Recording a movie while skipping frames is not supported.");
+  }
+  m_frame_skip = frames;
+}
+
+void EmulatorThread::SetRewind(int interval, int seconds, size_t memory_budget) {
+  if(m_running) {
+    ATOM_PANIC("Changing the rewind settings of a running emulator thread is illegal.");
+  }
+  if(interval > 0 && m_movie) {
+    ATOM_PANIC("Recording a movie while rewinding is enabled is not supported.");
+  }
+  m_rewind_interval = interval;
+  m_rewind_cycles = 0u;
+
+  if(interval > 0) {
+    m_rewind_buffer = std::make_unique<dual::RewindBuffer>((size_t)(seconds * 60 / interval), memory_budget);
+  } else {
+    m_rewind_buffer.reset();
+  }
+}
+
+void EmulatorThread::SetRewinding(bool rewinding) {
+  m_rewinding = rewinding;
+}
+
 void EmulatorThread::Reset() {
   PushMessage({.type = MessageType::Reset});
 }
@@ -107,7 +181,7 @@ void EmulatorThread::ProcessMessages() {
 void EmulatorThread::ThreadMain() {
   using namespace std::chrono_literals;
 
-  constexpr int k_cycles_per_frame = 560190;
+  constexpr int k_fast_forward_frame_skip = 3;
 
   dual::AudioDriverBase* audio_driver = m_nds->GetAPU().GetAudioDriver();
 
@@ -119,10 +193,25 @@ void EmulatorThread::ThreadMain() {
   const uint full_buffer_size = audio_driver->GetBufferSize() * 8;
   const uint half_buffer_size = full_buffer_size >> 1;
 
+  // Only the instance which presents frames skips them, the main instance does not present any while running ahead on a second instance.
+  dual::nds::VideoUnit& video_unit = (m_run_ahead_nds ? m_run_ahead_nds : m_nds)->GetVideoUnit();
+
+  dual::Tracer::SetThreadName("Emulator");
+
   while(m_running) {
     // @todo: figure out how frequently we want to run this, especially when unthrottled.
     ProcessMessages();
 
+    if(m_rewinding && m_rewind_buffer) {
+      RewindFrame();
+      continue;
+    }
+
+    // The display cannot keep up with every frame under fast-forward anyway. A movie needs the hash of every frame though.
+    if(!m_movie) {
+      video_unit.SetFrameSkip(m_fast_forward ? std::max(m_frame_skip, k_fast_forward_frame_skip) : m_frame_skip);
+    }
+
     if(!m_fast_forward) {
       uint current_buffer_size = audio_driver->GetNumberOfQueuedSamples();
 
@@ -130,22 +219,133 @@ void EmulatorThread::ThreadMain() {
         fmt::print("Uh oh! Bad! Audio not synced anymore! Fix me!!\n");
       }
 
+      DUAL_TRACE_COUNTER("Queued audio samples", current_buffer_size);
+
       // Sleep until the queue is less than half full
-      while(current_buffer_size > half_buffer_size) {
-        std::this_thread::sleep_for(1ms);
+      if(current_buffer_size > half_buffer_size) {
+        DUAL_TRACE_SCOPE("Audio sync sleep");
 
-        current_buffer_size = audio_driver->GetNumberOfQueuedSamples();
+        while(current_buffer_size > half_buffer_size) {
+          std::this_thread::sleep_for(1ms);
+
+          current_buffer_size = audio_driver->GetNumberOfQueuedSamples();
+        }
       }
 
       // Run the emulator for as many cycles as is needed to fully fill the queue.
       const int cycles = (int)(full_buffer_size - current_buffer_size) * 1024;
-      m_nds->Step(cycles);
+      Run(cycles);
+      PushRewindSnapshot(cycles);
     } else {
-      m_nds->Step(k_cycles_per_frame);
+      Run(k_cycles_per_frame);
+      PushRewindSnapshot(k_cycles_per_frame);
     }
   }
 }
 
+void EmulatorThread::Run(int cycles) {
+  if(m_run_ahead_frames == 0) {
+    m_nds->Step(cycles);
+    return;
+  }
+
+  // Running ahead works on whole frames, so this may run up to a frame longer than requested.
+  while(cycles > 0) {
+    cycles -= (int)RunFrameAhead();
+  }
+}
+
+u64 EmulatorThread::RunFrameAhead() {
+  DUAL_TRACE_SCOPE("Run-ahead frame");
+
+  if(m_run_ahead_nds) {
+    const u64 cycles = m_nds->RunFrame();
+
+    m_nds->SaveState(m_run_ahead_state);
+    m_run_ahead_nds->LoadState(m_run_ahead_state);
+
+    auto& video_unit = m_run_ahead_nds->GetVideoUnit();
+
+    for(int i = 0; i < m_run_ahead_frames; i++) {
+      video_unit.SetEnableOutput(i == m_run_ahead_frames - 1);
+      m_run_ahead_nds->RunFrame();
+    }
+    return cycles;
+  }
+
+  auto& video_unit = m_nds->GetVideoUnit();
+  auto& apu = m_nds->GetAPU();
+
+  // The frame on the real timeline is heard but not seen, the frames ahead of it are seen but not heard.
+  video_unit.SetEnableOutput(false);
+
+  const u64 cycles = m_nds->RunFrame();
+
+  m_nds->SaveState(m_run_ahead_state);
+  apu.SetEnableOutput(false);
+
+  for(int i = 0; i < m_run_ahead_frames; i++) {
+    // Only the last frame ahead is presented.
+    video_unit.SetEnableOutput(i == m_run_ahead_frames - 1);
+    m_nds->RunFrame();
+  }
+
+  m_nds->LoadState(m_run_ahead_state);
+  apu.SetEnableOutput(!m_fast_forward);
+  return cycles;
+}
+
+void EmulatorThread::PushRewindSnapshot(int cycles) {
+  if(!m_rewind_buffer) {
+    return;
+  }
+
+  // @note: the emulator does not run in whole frames here, so snapshots are taken by the amount of cycles run instead.
+  m_rewind_cycles += (u64)cycles;
+
+  if(m_rewind_cycles >= (u64)m_rewind_interval * k_cycles_per_frame) {
+    DUAL_TRACE_SCOPE("Rewind snapshot");
+
+    m_rewind_cycles = 0u;
+    m_nds->SaveState(m_rewind_state);
+    m_rewind_buffer->Push(m_rewind_state);
+  }
+}
+
+void EmulatorThread::RewindFrame() {
+  using namespace std::chrono_literals;
+
+  DUAL_TRACE_SCOPE("Rewind frame");
+
+  if(!m_rewind_buffer->Pop(m_rewind_state)) {
+    // Nothing left to step back to.
+    std::this_thread::sleep_for(16ms);
+    return;
+  }
+
+  if(!m_nds->LoadState(m_rewind_state)) {
+    ATOM_PANIC("Failed to load a rewind snapshot.");
+  }
+
+  m_rewind_cycles = 0u;
+
+  // Run a single frame from the snapshot to present it, without playing its audio.
+  auto& apu = m_nds->GetAPU();
+
+  apu.SetEnableOutput(false);
+
+  if(m_run_ahead_frames > 0) {
+    RunFrameAhead();
+  } else {
+    m_nds->RunFrame();
+  }
+
+  apu.SetEnableOutput(!m_fast_forward);
+
+  // Step back at roughly the frame rate, which is m_rewind_interval times faster than the game ran.
+  std::this_thread::sleep_for(16ms);
+}
+
 std::optional<std::pair<const u32*, const u32*>> EmulatorThread::AcquireFrame() {
   int read_id = m_frame_mailbox.read_id;
 
@@ -171,6 +371,10 @@ void EmulatorThread::ReleaseFrame() {
 void EmulatorThread::PresentCallback(const u32* fb_top, const u32* fb_bottom) {
   using namespace std::chrono_literals;
 
+  if(m_movie) {
+    m_movie->frame_hashes.push_back(m_nds->HashFrame(fb_top, fb_bottom));
+  }
+
   int write_id = m_frame_mailbox.write_id;
 
   if(m_frame_mailbox.available[write_id]/* && !m_frame_mailbox.available[write_id ^ 1]*/) {
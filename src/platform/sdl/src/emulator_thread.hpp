@@ -2,11 +2,13 @@
 #pragma once
 
 #include <atomic>
+#include <dual/common/rewind_buffer.hpp>
 #include <dual/nds/nds.hpp>
 #include <optional>
 #include <thread>
 #include <mutex>
 #include <queue>
+#include <vector>
 
 class EmulatorThread {
   public:
@@ -20,6 +22,39 @@ class EmulatorThread {
     void Start(std::unique_ptr<dual::nds::NDS> nds);
     std::unique_ptr<dual::nds::NDS> Stop();
 
+    /**
+     * Run-ahead hides the input lag of a game: after every frame the emulator saves its state, runs `frames` frames ahead
+     * with the current input, presents the last of them and then goes back to the saved state.
+     * With a second instance (set up with the same ROM and settings) the frames are run ahead on that instance instead,
+     * so that the audio of the main instance is never rolled back.
+     * @note: this must be called while the thread is stopped.
+     */
+    void SetRunAhead(int frames, std::unique_ptr<dual::nds::NDS> second_instance = {});
+
+    /**
+     * Record the input and the hash of every presented frame into the movie, from the moment the thread is started
+     * until it is stopped or the emulator is reset.
+     * @note: this must be called while the thread is stopped and does not work together with run-ahead.
+     */
+    void SetMovieRecording(dual::nds::Movie* movie);
+
+    /**
+     * Present only one in every (frames + 1) frames. Under fast-forward a few frames are skipped either way.
+     * @note: this must be called while the thread is stopped and does not work together with movie recording,
+     * which hashes every frame.
+     */
+    void SetFrameSkip(int frames);
+
+    /**
+     * Push a save state to a rewind buffer every `interval` frames, which keeps up to `seconds` seconds within `memory_budget` bytes.
+     * An interval of zero disables rewinding. The snapshot is taken in one go, so a frame which takes one runs about 2-2.5 ms longer.
+     * @note: this must be called while the thread is stopped and does not work together with movie recording.
+     */
+    void SetRewind(int interval, int seconds, size_t memory_budget);
+
+    // While rewinding, the emulator steps back one snapshot per frame instead of running.
+    void SetRewinding(bool rewinding);
+
     void Reset();
     void DirectBoot();
     void SetKeyState(dual::nds::Key key, bool pressed);
@@ -32,6 +67,8 @@ class EmulatorThread {
     void ReleaseFrame();
 
   private:
+    static constexpr int k_cycles_per_frame = 560190;
+
     enum class MessageType : u8 {
       Reset,
       DirectBoot,
@@ -58,6 +95,10 @@ class EmulatorThread {
     void ProcessMessages();
 
     void ThreadMain();
+    void Run(int cycles);
+    u64 RunFrameAhead();
+    void PushRewindSnapshot(int cycles);
+    void RewindFrame();
     void PresentCallback(const u32* fb_top, const u32* fb_bottom);
 
     std::unique_ptr<dual::nds::NDS> m_nds{};
@@ -65,6 +106,20 @@ class EmulatorThread {
     std::atomic_bool m_running{};
     std::atomic_bool m_fast_forward{};
 
+    int m_run_ahead_frames{};
+    std::unique_ptr<dual::nds::NDS> m_run_ahead_nds{};
+    std::vector<u8> m_run_ahead_state{};
+
+    dual::nds::Movie* m_movie{};
+
+    int m_frame_skip{};
+
+    int m_rewind_interval{};
+    std::unique_ptr<dual::RewindBuffer> m_rewind_buffer{};
+    std::vector<u8> m_rewind_state{};
+    u64 m_rewind_cycles{}; //< cycles run since the last snapshot
+    std::atomic_bool m_rewinding{};
+
     // Thread-safe UI thread to emulator thread message queue
     std::queue<Message> m_msg_queue{};
     std::mutex m_msg_queue_mutex{};